@@ -0,0 +1,38 @@
+#ifndef CX_ARENA_H_
+#define CX_ARENA_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+typedef struct cx_arena_chunk_t
+{
+    struct cx_arena_chunk_t* next;          // next (previously filled) chunk in the list.
+    uint32_t            size;               // capacity in bytes of the data array.
+    uint32_t            used;               // number of bytes of the data array already handed out.
+    char                data[];             // memory handed out by the arena.
+} cx_arena_chunk_t;
+
+typedef struct cx_arena_t
+{
+    uint32_t            chunkSize;          // default capacity in bytes of each chunk.
+    cx_arena_chunk_t*   chunks;             // list of chunks. the head is the chunk currently being used for allocations.
+    uint64_t            bytesUsed;          // total amount of bytes handed out since the last reset.
+} cx_arena_t;
+
+/****************************************************************************************
+ ***  PUBLIC FUNCTIONS
+ ***************************************************************************************/
+
+cx_arena_t*             cx_arena_init(uint32_t _chunkSize);
+
+void                    cx_arena_destroy(cx_arena_t* _arena);
+
+void                    cx_arena_reset(cx_arena_t* _arena);
+
+void*                   cx_arena_alloc(cx_arena_t* _arena, uint32_t _size);
+
+char*                   cx_arena_str_copy(cx_arena_t* _arena, const char* _str, uint32_t _len);
+
+uint64_t                cx_arena_size(cx_arena_t* _arena);
+
+#endif // CX_ARENA_H_
@@ -0,0 +1,33 @@
+#ifndef CX_BLOOM_H_
+#define CX_BLOOM_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+typedef struct cx_bloom_t
+{
+    uint32_t            bitsCount;          // number of bits (m) in our bit array.
+    uint32_t            hashCount;          // number of hash functions (k) applied to each element.
+    uint32_t            itemsCount;         // number of elements added to the filter so far.
+    uint8_t*            bits;               // bit array of bitsCount bits. a set bit means at least one element was hashed to it.
+} cx_bloom_t;
+
+/****************************************************************************************
+ ***  PUBLIC FUNCTIONS
+ ***************************************************************************************/
+
+cx_bloom_t*             cx_bloom_init(uint32_t _expectedItems, uint32_t _bitsPerItem);
+
+cx_bloom_t*             cx_bloom_import(uint32_t _bitsCount, uint32_t _hashCount, uint32_t _itemsCount, const uint8_t* _bits);
+
+void                    cx_bloom_destroy(cx_bloom_t* _bloom);
+
+void                    cx_bloom_clear(cx_bloom_t* _bloom);
+
+void                    cx_bloom_add(cx_bloom_t* _bloom, const void* _data, uint32_t _size);
+
+bool                    cx_bloom_contains(cx_bloom_t* _bloom, const void* _data, uint32_t _size);
+
+uint32_t                cx_bloom_count(cx_bloom_t* _bloom);
+
+#endif // CX_BLOOM_H_
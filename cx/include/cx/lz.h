@@ -0,0 +1,17 @@
+#ifndef CX_LZ_H_
+#define CX_LZ_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/****************************************************************************************
+ ***  PUBLIC FUNCTIONS
+ ***************************************************************************************/
+
+uint32_t                cx_lz_bound(uint32_t _srcSize);
+
+uint32_t                cx_lz_compress(const char* _src, uint32_t _srcSize, char* _dst, uint32_t _dstCapacity);
+
+int32_t                 cx_lz_decompress(const char* _src, uint32_t _srcSize, char* _dst, uint32_t _dstCapacity);
+
+#endif // CX_LZ_H_
@@ -180,7 +180,7 @@ bool                    cx_net_flush(void* _ctx, uint32_t _clientId);
 
 void                    cx_net_disconnect(void* _ctx, uint32_t _clientId, const char* _reason);
 
-void                    cx_net_wait_outboundbuff(void* _ctx, uint32_t _clientId, int32_t _timeout);
+bool                    cx_net_wait_outboundbuff(void* _ctx, uint32_t _clientId, int32_t _timeout);
 
 #endif // CX_NET_H_
 
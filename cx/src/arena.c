@@ -0,0 +1,126 @@
+#include "cx.h"
+#include "arena.h"
+#include "mem.h"
+#include "math.h"
+
+#include <string.h>
+
+#define CX_ARENA_ALIGNMENT  8
+
+/****************************************************************************************
+ ***  PRIVATE DECLARATIONS
+ ***************************************************************************************/
+
+static cx_arena_chunk_t* _cx_arena_chunk_alloc(uint32_t _size);
+
+/****************************************************************************************
+ ***  PUBLIC FUNCTIONS
+ ***************************************************************************************/
+
+cx_arena_t* cx_arena_init(uint32_t _chunkSize)
+{
+    CX_CHECK(_chunkSize > 0, "_chunkSize must be greater than zero!");
+
+    // a bump-pointer allocator. memory is handed out sequentially from big chunks and 
+    // it's only given back all at once (cx_arena_reset or cx_arena_destroy).
+    cx_arena_t* arena = CX_MEM_STRUCT_ALLOC(arena);
+    arena->chunkSize = _chunkSize;
+    arena->chunks = NULL;
+    arena->bytesUsed = 0;
+
+    return arena;
+}
+
+void cx_arena_destroy(cx_arena_t* _arena)
+{
+    if (NULL != _arena)
+    {
+        cx_arena_reset(_arena);
+        free(_arena->chunks);
+        _arena->chunks = NULL;
+        free(_arena);
+    }
+}
+
+void cx_arena_reset(cx_arena_t* _arena)
+{
+    CX_CHECK_NOT_NULL(_arena);
+
+    // frees every chunk except the current one, which is kept to be reused.
+    if (NULL != _arena->chunks)
+    {
+        cx_arena_chunk_t* chunk = _arena->chunks->next;
+        cx_arena_chunk_t* next = NULL;
+
+        while (NULL != chunk)
+        {
+            next = chunk->next;
+            free(chunk);
+            chunk = next;
+        }
+
+        _arena->chunks->next = NULL;
+        _arena->chunks->used = 0;
+    }
+    _arena->bytesUsed = 0;
+}
+
+void* cx_arena_alloc(cx_arena_t* _arena, uint32_t _size)
+{
+    CX_CHECK_NOT_NULL(_arena);
+
+    cx_arena_chunk_t* chunk = _arena->chunks;
+    uint32_t          size = (cx_math_max(_size, 1) + CX_ARENA_ALIGNMENT - 1) & ~(CX_ARENA_ALIGNMENT - 1);
+
+    if (NULL == chunk || chunk->size - chunk->used < size)
+    {
+        // the current chunk can't hold it, grab a new one (big enough for oversized requests).
+        chunk = _cx_arena_chunk_alloc(cx_math_max(size, _arena->chunkSize));
+        if (NULL == chunk) return NULL;
+
+        chunk->next = _arena->chunks;
+        _arena->chunks = chunk;
+    }
+
+    void* ptr = &chunk->data[chunk->used];
+    chunk->used += size;
+    _arena->bytesUsed += size;
+
+    return ptr;
+}
+
+char* cx_arena_str_copy(cx_arena_t* _arena, const char* _str, uint32_t _len)
+{
+    // copies _len characters of _str into the arena, adding the null terminator.
+    char* str = cx_arena_alloc(_arena, _len + 1);
+    if (NULL != str)
+    {
+        memcpy(str, _str, _len);
+        str[_len] = '\0';
+    }
+    return str;
+}
+
+uint64_t cx_arena_size(cx_arena_t* _arena)
+{
+    CX_CHECK_NOT_NULL(_arena);
+    return _arena->bytesUsed;
+}
+
+/****************************************************************************************
+ ***  PRIVATE FUNCTIONS
+ ***************************************************************************************/
+
+static cx_arena_chunk_t* _cx_arena_chunk_alloc(uint32_t _size)
+{
+    cx_arena_chunk_t* chunk = malloc(sizeof(*chunk) + _size);
+    CX_CHECK(NULL != chunk, "arena chunk allocation failed! (%d bytes needed)", sizeof(*chunk) + _size);
+
+    if (NULL != chunk)
+    {
+        chunk->next = NULL;
+        chunk->size = _size;
+        chunk->used = 0;
+    }
+    return chunk;
+}
@@ -0,0 +1,149 @@
+#include "cx.h"
+#include "bloom.h"
+#include "mem.h"
+#include "math.h"
+
+#include <string.h>
+
+#define CX_BLOOM_HASHES_MIN 1
+#define CX_BLOOM_HASHES_MAX 16
+#define CX_BLOOM_BITS_MIN   64
+
+/****************************************************************************************
+ ***  PRIVATE DECLARATIONS
+ ***************************************************************************************/
+
+static uint64_t     _cx_bloom_hash(const void* _data, uint32_t _size);
+
+/****************************************************************************************
+ ***  PUBLIC FUNCTIONS
+ ***************************************************************************************/
+
+cx_bloom_t* cx_bloom_init(uint32_t _expectedItems, uint32_t _bitsPerItem)
+{
+    CX_CHECK(_bitsPerItem > 0, "_bitsPerItem must be greater than zero!");
+
+    // the optimal number of hashes is k = (m / n) * ln(2) which yields a false positive 
+    // rate of roughly 0.6185^(m / n). (10 bits per item gives us ~1% of false positives)
+    uint32_t bitsCount = cx_math_max(_expectedItems, 1) * _bitsPerItem;
+    uint32_t hashCount = (_bitsPerItem * 693 + 500) / 1000;
+
+    cx_bloom_t* bloom = CX_MEM_STRUCT_ALLOC(bloom);
+    bloom->bitsCount = cx_math_max(bitsCount, CX_BLOOM_BITS_MIN);
+    bloom->bitsCount = (bloom->bitsCount + 7) & ~7u; // round up to a multiple of 8
+    bloom->hashCount = cx_math_min(cx_math_max(hashCount, CX_BLOOM_HASHES_MIN), CX_BLOOM_HASHES_MAX);
+    bloom->itemsCount = 0;
+    bloom->bits = CX_MEM_ARR_ALLOC(bloom->bits, bloom->bitsCount / 8);
+
+    return bloom;
+}
+
+cx_bloom_t* cx_bloom_import(uint32_t _bitsCount, uint32_t _hashCount, uint32_t _itemsCount, const uint8_t* _bits)
+{
+    // rebuilds a filter from the fields and bit array (bitsCount / 8 bytes) of another one,
+    // for instance after persisting them. returns NULL if they don't describe a valid filter.
+    if (_bitsCount < CX_BLOOM_BITS_MIN || 0 != _bitsCount % 8
+        || _hashCount < CX_BLOOM_HASHES_MIN || _hashCount > CX_BLOOM_HASHES_MAX)
+        return NULL;
+
+    CX_CHECK_NOT_NULL(_bits);
+
+    cx_bloom_t* bloom = CX_MEM_STRUCT_ALLOC(bloom);
+    bloom->bitsCount = _bitsCount;
+    bloom->hashCount = _hashCount;
+    bloom->itemsCount = _itemsCount;
+    bloom->bits = malloc(_bitsCount / 8);
+    memcpy(bloom->bits, _bits, _bitsCount / 8);
+
+    return bloom;
+}
+
+void cx_bloom_destroy(cx_bloom_t* _bloom)
+{
+    if (NULL != _bloom)
+    {
+        free(_bloom->bits);
+        _bloom->bits = NULL;
+        free(_bloom);
+    }
+}
+
+void cx_bloom_clear(cx_bloom_t* _bloom)
+{
+    CX_CHECK_NOT_NULL(_bloom);
+
+    memset(_bloom->bits, 0, _bloom->bitsCount / 8);
+    _bloom->itemsCount = 0;
+}
+
+void cx_bloom_add(cx_bloom_t* _bloom, const void* _data, uint32_t _size)
+{
+    CX_CHECK_NOT_NULL(_bloom);
+
+    // double hashing: the i-th hash function is h1 + i * h2 (Kirsch-Mitzenmacher).
+    uint64_t hash = _cx_bloom_hash(_data, _size);
+    uint32_t h1 = (uint32_t)hash;
+    uint32_t h2 = (uint32_t)(hash >> 32) | 1;
+    uint32_t bit = 0;
+
+    for (uint32_t i = 0; i < _bloom->hashCount; i++)
+    {
+        bit = (h1 + i * h2) % _bloom->bitsCount;
+        _bloom->bits[bit / 8] |= (1 << (bit % 8));
+    }
+
+    _bloom->itemsCount++;
+}
+
+bool cx_bloom_contains(cx_bloom_t* _bloom, const void* _data, uint32_t _size)
+{
+    CX_CHECK_NOT_NULL(_bloom);
+
+    // false means the element was definitely never added.
+    // true means the element was probably added (false positives are possible).
+    uint64_t hash = _cx_bloom_hash(_data, _size);
+    uint32_t h1 = (uint32_t)hash;
+    uint32_t h2 = (uint32_t)(hash >> 32) | 1;
+    uint32_t bit = 0;
+
+    for (uint32_t i = 0; i < _bloom->hashCount; i++)
+    {
+        bit = (h1 + i * h2) % _bloom->bitsCount;
+        if (0 == (_bloom->bits[bit / 8] & (1 << (bit % 8))))
+            return false;
+    }
+
+    return true;
+}
+
+uint32_t cx_bloom_count(cx_bloom_t* _bloom)
+{
+    CX_CHECK_NOT_NULL(_bloom);
+    return _bloom->itemsCount;
+}
+
+/****************************************************************************************
+ ***  PRIVATE FUNCTIONS
+ ***************************************************************************************/
+
+static uint64_t _cx_bloom_hash(const void* _data, uint32_t _size)
+{
+    // 64-bit FNV-1a followed by a final avalanche (murmur3 fmix64) so that
+    // both 32-bit halves are well distributed even for tiny inputs.
+    const uint8_t* data = (const uint8_t*)_data;
+    uint64_t hash = 0xcbf29ce484222325ULL;
+
+    for (uint32_t i = 0; i < _size; i++)
+    {
+        hash ^= data[i];
+        hash *= 0x100000001b3ULL;
+    }
+
+    hash ^= hash >> 33;
+    hash *= 0xff51afd7ed558ccdULL;
+    hash ^= hash >> 33;
+    hash *= 0xc4ceb9fe1a85ec53ULL;
+    hash ^= hash >> 33;
+
+    return hash;
+}
@@ -0,0 +1,224 @@
+#include "cx.h"
+#include "lz.h"
+#include "math.h"
+
+#include <string.h>
+
+#define CX_LZ_MIN_MATCH     4       // minimum length of a match worth encoding.
+#define CX_LZ_MAX_OFFSET    65535   // maximum distance of a match (it's encoded in 16 bits).
+#define CX_LZ_HASH_BITS     12      // log2 of the number of entries of the match finder hash table.
+#define CX_LZ_NIBBLE_MAX    15      // lengths greater than or equal to this one need extra bytes.
+
+/****************************************************************************************
+ ***  PRIVATE DECLARATIONS
+ ***************************************************************************************/
+
+static uint32_t     _cx_lz_read32(const uint8_t* _src);
+
+static uint32_t     _cx_lz_hash(uint32_t _sequence);
+
+static bool         _cx_lz_write_length(uint8_t* _dst, uint32_t* _inOutPos, uint32_t _dstCapacity, uint32_t _length);
+
+static bool         _cx_lz_read_length(const uint8_t* _src, uint32_t* _inOutPos, uint32_t _srcSize, uint32_t* _inOutLength);
+
+static bool         _cx_lz_emit(uint8_t* _dst, uint32_t* _inOutPos, uint32_t _dstCapacity, const uint8_t* _literals, uint32_t _literalsCount, uint32_t _offset, uint32_t _matchLength);
+
+/****************************************************************************************
+ ***  PUBLIC FUNCTIONS
+ ***************************************************************************************/
+
+uint32_t cx_lz_bound(uint32_t _srcSize)
+{
+    // worst case scenario (incompressible data): a single sequence of literals.
+    return _srcSize + (_srcSize / 255) + 16;
+}
+
+uint32_t cx_lz_compress(const char* _src, uint32_t _srcSize, char* _dst, uint32_t _dstCapacity)
+{
+    // LZ77 compressor with a greedy single-probe match finder (same block format as LZ4).
+    // the input is encoded as a sequence of [TOKEN][LITERALS_LEN+][LITERALS][OFFSET][MATCH_LEN+]
+    // where the token holds the number of literals (high nibble) and the length of the match 
+    // minus CX_LZ_MIN_MATCH (low nibble). the last sequence only contains literals.
+    // returns the size of the compressed data or zero if it doesn't fit in _dstCapacity bytes.
+    const uint8_t* src = (const uint8_t*)_src;
+    uint8_t*       dst = (uint8_t*)_dst;
+    uint32_t       table[1 << CX_LZ_HASH_BITS];     // last position (plus one) where each hash was seen.
+    uint32_t       pos = 0;
+    uint32_t       anchor = 0;
+    uint32_t       out = 0;
+    uint32_t       sequence = 0;
+    uint32_t       hash = 0;
+    uint32_t       candidate = 0;
+    uint32_t       length = 0;
+
+    memset(table, 0, sizeof(table));
+
+    while (pos + CX_LZ_MIN_MATCH <= _srcSize)
+    {
+        sequence = _cx_lz_read32(&src[pos]);
+        hash = _cx_lz_hash(sequence);
+        candidate = table[hash];
+        table[hash] = pos + 1;
+
+        if (0 == candidate || pos - (candidate - 1) > CX_LZ_MAX_OFFSET || sequence != _cx_lz_read32(&src[candidate - 1]))
+        {
+            pos++;
+            continue;
+        }
+        candidate--;
+
+        length = CX_LZ_MIN_MATCH;
+        while (pos + length < _srcSize && src[candidate + length] == src[pos + length])
+        {
+            length++;
+        }
+
+        if (!_cx_lz_emit(dst, &out, _dstCapacity, &src[anchor], pos - anchor, pos - candidate, length))
+            return 0;
+
+        pos += length;
+        anchor = pos;
+    }
+
+    if (!_cx_lz_emit(dst, &out, _dstCapacity, &src[anchor], _srcSize - anchor, 0, 0))
+        return 0;
+
+    return out;
+}
+
+int32_t cx_lz_decompress(const char* _src, uint32_t _srcSize, char* _dst, uint32_t _dstCapacity)
+{
+    // returns the size of the decompressed data or -1 if the input is malformed 
+    // or if it doesn't fit in _dstCapacity bytes.
+    const uint8_t* src = (const uint8_t*)_src;
+    uint8_t*       dst = (uint8_t*)_dst;
+    uint32_t       pos = 0;
+    uint32_t       out = 0;
+    uint8_t        token = 0;
+    uint32_t       literals = 0;
+    uint32_t       offset = 0;
+    uint32_t       length = 0;
+
+    while (pos < _srcSize)
+    {
+        token = src[pos++];
+
+        literals = token >> 4;
+        if (!_cx_lz_read_length(src, &pos, _srcSize, &literals)
+            || pos + literals > _srcSize 
+            || out + literals > _dstCapacity)
+            return -1;
+
+        memcpy(&dst[out], &src[pos], literals);
+        pos += literals;
+        out += literals;
+
+        // the last sequence has no match
+        if (pos == _srcSize) break;
+
+        if (pos + 2 > _srcSize) return -1;
+        offset = (uint32_t)src[pos] | ((uint32_t)src[pos + 1] << 8);
+        pos += 2;
+
+        length = token & 0x0F;
+        if (!_cx_lz_read_length(src, &pos, _srcSize, &length)) return -1;
+        length += CX_LZ_MIN_MATCH;
+
+        if (0 == offset || offset > out || out + length > _dstCapacity) return -1;
+
+        if (offset >= length)
+        {
+            memcpy(&dst[out], &dst[out - offset], length);
+            out += length;
+        }
+        else
+        {
+            // overlapping match (a repetition of the last offset bytes)
+            for (uint32_t i = 0; i < length; i++, out++)
+                dst[out] = dst[out - offset];
+        }
+    }
+
+    return (int32_t)out;
+}
+
+/****************************************************************************************
+ ***  PRIVATE FUNCTIONS
+ ***************************************************************************************/
+
+static uint32_t _cx_lz_read32(const uint8_t* _src)
+{
+    uint32_t value = 0;
+    memcpy(&value, _src, sizeof(value));
+    return value;
+}
+
+static uint32_t _cx_lz_hash(uint32_t _sequence)
+{
+    // fibonacci hashing
+    return (_sequence * 2654435761u) >> (32 - CX_LZ_HASH_BITS);
+}
+
+static bool _cx_lz_write_length(uint8_t* _dst, uint32_t* _inOutPos, uint32_t _dstCapacity, uint32_t _length)
+{
+    // lengths which don't fit in their nibble continue as a run of bytes (255 means keep reading).
+    if (_length < CX_LZ_NIBBLE_MAX) return true;
+
+    _length -= CX_LZ_NIBBLE_MAX;
+    while (true)
+    {
+        if ((*_inOutPos) >= _dstCapacity) return false;
+
+        if (_length >= 255)
+        {
+            _dst[(*_inOutPos)++] = 255;
+            _length -= 255;
+        }
+        else
+        {
+            _dst[(*_inOutPos)++] = (uint8_t)_length;
+            return true;
+        }
+    }
+}
+
+static bool _cx_lz_read_length(const uint8_t* _src, uint32_t* _inOutPos, uint32_t _srcSize, uint32_t* _inOutLength)
+{
+    uint8_t value = 255;
+
+    if ((*_inOutLength) < CX_LZ_NIBBLE_MAX) return true;
+
+    while (255 == value)
+    {
+        if ((*_inOutPos) >= _srcSize) return false;
+
+        value = _src[(*_inOutPos)++];
+        (*_inOutLength) += value;
+    }
+    return true;
+}
+
+static bool _cx_lz_emit(uint8_t* _dst, uint32_t* _inOutPos, uint32_t _dstCapacity, const uint8_t* _literals, uint32_t _literalsCount, uint32_t _offset, uint32_t _matchLength)
+{
+    // writes a sequence. _matchLength is zero for the last one (literals only).
+    uint32_t matchLength = (_matchLength > 0) ? _matchLength - CX_LZ_MIN_MATCH : 0;
+    uint8_t  token = (uint8_t)((cx_math_min(_literalsCount, CX_LZ_NIBBLE_MAX) << 4) | cx_math_min(matchLength, CX_LZ_NIBBLE_MAX));
+
+    if ((*_inOutPos) >= _dstCapacity) return false;
+    _dst[(*_inOutPos)++] = token;
+
+    if (!_cx_lz_write_length(_dst, _inOutPos, _dstCapacity, _literalsCount)
+        || (*_inOutPos) + _literalsCount > _dstCapacity)
+        return false;
+
+    memcpy(&_dst[*_inOutPos], _literals, _literalsCount);
+    (*_inOutPos) += _literalsCount;
+
+    if (0 == _matchLength) return true;
+
+    if ((*_inOutPos) + 2 > _dstCapacity) return false;
+    _dst[(*_inOutPos)++] = (uint8_t)(_offset & 0xFF);
+    _dst[(*_inOutPos)++] = (uint8_t)(_offset >> 8);
+
+    return _cx_lz_write_length(_dst, _inOutPos, _dstCapacity, matchLength);
+}
@@ -12,6 +12,7 @@
 #include <unistd.h> 
 #include <errno.h>
 #include <sys/epoll.h>
+#include <poll.h>
 #include <string.h>
 #include <pthread.h>
 
@@ -491,13 +492,13 @@ bool cx_net_flush(void* _ctx, uint32_t _clientId)
             // all the bytes were written to the socket successfully
             (*position) = 0;
         }
-        else if ((int32_t)(*position) > bytesWritten)
+        else if (bytesWritten >= 0)
         {
             // there're still some bytes left in our buffer that weren't written
             // make some space by shifting our pending bytes to the left in the buffer
             int32_t bytesRemaining = (*position) - bytesWritten;
             memmove(buffer, &(buffer[bytesWritten]), bytesRemaining);
-            (*position) = 0;
+            (*position) = bytesRemaining;
             reschedule = true;
         }
         else if (-1 == bytesWritten)
@@ -586,13 +587,51 @@ void cx_net_disconnect(void* _ctx, uint32_t _clientId, const char* _reason)
     }
 }
 
-void cx_net_wait_outboundbuff(void* _ctx, uint32_t _clientId, int32_t _timeout)
+bool cx_net_wait_outboundbuff(void* _ctx, uint32_t _clientId, int32_t _timeout)
 {
+    // blocks the calling thread until the outbound buffer has room for at least one more packet
+    // (see cx_net_flush), writing it out to the socket as soon as it becomes writable. _timeout is
+    // given in milliseconds (-1 waits forever). returns false on timeout or if the destination is gone.
     cx_net_cid_t cid = { _clientId };
-    CX_UNUSED(cid);
 
-    //TODO
-    CX_WARN(CX_ALW, "cx_net_wait_outboundbuff is not implemented yet!");
+    CX_CHECK_NOT_NULL(_ctx);
+    cx_net_ctx_t ctx = { _ctx };
+
+    struct pollfd pfd;
+    bool          available = false;
+    int32_t       waitTime = _timeout;
+    double        startTime = cx_time_counter();
+
+    while (true)
+    {
+        CX_MEM_ZERO(pfd);
+        pfd.fd = INVALID_DESCRIPTOR;
+        pfd.events = POLLOUT;
+
+        if (ctx.c->mtxInitialized) pthread_mutex_lock(&ctx.c->mtx);
+        if (CX_NET_STATE_SERVER & ctx.c->state)
+        {
+            if (CX_NET_VALID_CID(ctx.sv, cid))
+                pfd.fd = ctx.sv->clients[cid.comps.handle].sock;
+        }
+        else if ((CX_NET_STATE_CLIENT & ctx.c->state) && (CX_NET_STATE_CONNECTED & ctx.c->state))
+        {
+            pfd.fd = ctx.cl->c.sock;
+        }
+        available = (INVALID_DESCRIPTOR != pfd.fd) && cx_net_flush(_ctx, _clientId);
+        if (ctx.c->mtxInitialized) pthread_mutex_unlock(&ctx.c->mtx);
+
+        if (available || INVALID_DESCRIPTOR == pfd.fd) 
+            return available;
+
+        if (_timeout >= 0)
+        {
+            waitTime = _timeout - (int32_t)((cx_time_counter() - startTime) * 1000);
+            if (waitTime <= 0) return false;
+        }
+
+        poll(&pfd, 1, waitTime);
+    }
 }
 
 /****************************************************************************************
@@ -657,11 +696,14 @@ static void _cx_net_poll_events_client(cx_net_ctx_cl_t* _ctx, int32_t _timeout)
             if (CX_NET_STATE_CONNECTED & _ctx->c.state)
             {
                 // pending write operation, epoll says we can do it now without blocking (let's try)
+                // other threads might be appending packets to our outbound buffer meanwhile.
+                if (_ctx->c.mtxInitialized) pthread_mutex_lock(&_ctx->c.mtx);
                 if (cx_net_flush(_ctx, INVALID_CID))
                 {
                     // done. unset the EPOLLOUT flag
                     _cx_net_epoll_mod(_ctx->c.epollDescriptor, _ctx->c.sock, true, false);
                 }
+                if (_ctx->c.mtxInitialized) pthread_mutex_unlock(&_ctx->c.mtx);
             }
             else if (CX_NET_STATE_CONNECTING & _ctx->c.state)
             {               
@@ -709,10 +751,12 @@ static void _cx_net_poll_events_client(cx_net_ctx_cl_t* _ctx, int32_t _timeout)
         }
 
         //TODO fixme, do this only every 16ms or so
+        if (_ctx->c.mtxInitialized) pthread_mutex_lock(&_ctx->c.mtx);
         if (_ctx->outPos > 0)
         {
             cx_net_flush(_ctx, INVALID_CID);
         }
+        if (_ctx->c.mtxInitialized) pthread_mutex_unlock(&_ctx->c.mtx);
     }
 }
 
@@ -833,6 +877,8 @@ static void _cx_net_poll_events_server(cx_net_ctx_sv_t* _ctx, int32_t _timeout)
                 if (EPOLLOUT & _ctx->c.epollEvents[i].events)
                 {
                     // pending write operation, epoll says we can do it now without blocking (let's see)
+                    // other threads might be appending packets to our outbound buffer meanwhile.
+                    if (_ctx->c.mtxInitialized) pthread_mutex_lock(&_ctx->c.mtx);
                     if (cx_net_flush(_ctx, client->cid.id))
                     {
                         // done. get rid of the EPOLLOUT flag
@@ -841,6 +887,7 @@ static void _cx_net_poll_events_server(cx_net_ctx_sv_t* _ctx, int32_t _timeout)
                         event.data.fd = client->sock;
                         epoll_ctl(_ctx->c.epollDescriptor, EPOLL_CTL_MOD, client->sock, &event);
                     }
+                    if (_ctx->c.mtxInitialized) pthread_mutex_unlock(&_ctx->c.mtx);
                 }
             }
             CX_NET_LOG(_ctx, CX_WARN(INVALID_HANDLE != clientHandle, "[%s<--] socket %d is not registered as a client!", _ctx->c.name, clientSock));
@@ -857,8 +904,10 @@ static void _cx_net_poll_events_server(cx_net_ctx_sv_t* _ctx, int32_t _timeout)
         handle = cx_handle_at(_ctx->clientsHalloc, i);
         client = &_ctx->clients[handle];
 
+        if (_ctx->c.mtxInitialized) pthread_mutex_lock(&_ctx->c.mtx);
         if (client->outPos > 0)
             cx_net_flush(_ctx, client->cid.id);
+        if (_ctx->c.mtxInitialized) pthread_mutex_unlock(&_ctx->c.mtx);
 
         if (!client->validated && time - client->connectedTime > _ctx->c.validationTimeout)
             _ctx->tmpIds[validationCount++] = client->cid.id;
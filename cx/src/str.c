@@ -303,10 +303,14 @@ char* cx_str_format_d(const char* _format, ...)
     va_list args;
     va_start(args, _format);
 
+    va_list argsCopy;
+    va_copy(argsCopy, args);
+
     uint32_t len = vsnprintf(NULL, 0, _format, args) + 1;
     char* buffer = malloc(len);
-    vsnprintf(buffer, len, _format, args);
+    vsnprintf(buffer, len, _format, argsCopy);
 
+    va_end(argsCopy);
     va_end(args);
 
     return buffer;
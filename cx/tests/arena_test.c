@@ -0,0 +1,72 @@
+#include "test.h"
+#include "arena.h"
+
+cx_arena_t*     arena = NULL;
+uint32_t        arenaChunkSize = 64;
+
+int t_arena_init()
+{
+    arena = cx_arena_init(arenaChunkSize);
+
+    bool success = true
+        && NULL != arena;
+
+    return CUNIT_RESULT(success);
+}
+
+int t_arena_cleanup()
+{
+    cx_arena_destroy(arena);
+    arena = NULL;
+
+    bool success = true;
+    return CUNIT_RESULT(success);
+}
+
+void t_arena_should_alloc_aligned_memory()
+{
+    char* a = cx_arena_alloc(arena, 3);
+    char* b = cx_arena_alloc(arena, 5);
+
+    CU_ASSERT_PTR_NOT_NULL(a);
+    CU_ASSERT_PTR_NOT_NULL(b);
+    CU_ASSERT(0 == ((uintptr_t)a % 8));
+    CU_ASSERT(0 == ((uintptr_t)b % 8));
+    CU_ASSERT(b >= a + 3);
+    CU_ASSERT(16 == cx_arena_size(arena));
+}
+
+void t_arena_should_copy_strings()
+{
+    const char* values[] = { "lorem", "ipsum", "dolor sit amet, consectetur adipiscing elit" };
+    char*       copies[CX_ARR_SIZE(values)];
+
+    for (uint32_t i = 0; i < CX_ARR_SIZE(values); i++)
+    {
+        copies[i] = cx_arena_str_copy(arena, values[i], strlen(values[i]));
+    }
+
+    for (uint32_t i = 0; i < CX_ARR_SIZE(values); i++)
+    {
+        CU_ASSERT_STRING_EQUAL(copies[i], values[i]);
+    }
+}
+
+void t_arena_should_alloc_oversized_chunks()
+{
+    char* big = cx_arena_alloc(arena, arenaChunkSize * 4);
+    CU_ASSERT_PTR_NOT_NULL(big);
+
+    memset(big, 'x', arenaChunkSize * 4);
+    CU_ASSERT('x' == big[arenaChunkSize * 4 - 1]);
+}
+
+void t_arena_should_be_reset()
+{
+    cx_arena_reset(arena);
+    CU_ASSERT(0 == cx_arena_size(arena));
+
+    char* str = cx_arena_str_copy(arena, "reused", 6);
+    CU_ASSERT_STRING_EQUAL(str, "reused");
+    CU_ASSERT(8 == cx_arena_size(arena));
+}
@@ -0,0 +1,93 @@
+#include "test.h"
+#include "bloom.h"
+
+cx_bloom_t*     bloom = NULL;
+uint32_t        bloomItems = 1000;
+
+int t_bloom_init()
+{
+    bloom = cx_bloom_init(bloomItems, 10);
+
+    bool success = true
+        && NULL != bloom;
+
+    return CUNIT_RESULT(success);
+}
+
+int t_bloom_cleanup()
+{
+    cx_bloom_destroy(bloom);
+    bloom = NULL;
+
+    bool success = true;
+    return CUNIT_RESULT(success);
+}
+
+void t_bloom_should_not_contain_items_when_empty()
+{
+    for (uint32_t i = 0; i < bloomItems; i++)
+    {
+        CU_ASSERT(!cx_bloom_contains(bloom, &i, sizeof(i)));
+    }
+    CU_ASSERT(0 == cx_bloom_count(bloom));
+}
+
+void t_bloom_should_contain_added_items()
+{
+    for (uint32_t i = 0; i < bloomItems; i += 2)
+    {
+        cx_bloom_add(bloom, &i, sizeof(i));
+    }
+
+    for (uint32_t i = 0; i < bloomItems; i += 2)
+    {
+        CU_ASSERT(cx_bloom_contains(bloom, &i, sizeof(i)));
+    }
+    CU_ASSERT(bloomItems / 2 == cx_bloom_count(bloom));
+}
+
+void t_bloom_should_have_low_false_positive_rate()
+{
+    uint32_t falsePositives = 0;
+
+    for (uint32_t i = 1; i < bloomItems; i += 2)
+    {
+        if (cx_bloom_contains(bloom, &i, sizeof(i)))
+            falsePositives++;
+    }
+
+    // 10 bits per item should give us ~1% of false positives. (we only added half the expected items)
+    CU_ASSERT(falsePositives < (bloomItems / 2) / 20);
+}
+
+void t_bloom_should_be_imported()
+{
+    cx_bloom_t* copy = cx_bloom_import(bloom->bitsCount, bloom->hashCount, bloom->itemsCount, bloom->bits);
+    CU_ASSERT(NULL != copy);
+
+    if (NULL != copy)
+    {
+        for (uint32_t i = 0; i < bloomItems; i++)
+        {
+            CU_ASSERT(cx_bloom_contains(copy, &i, sizeof(i)) == cx_bloom_contains(bloom, &i, sizeof(i)));
+        }
+        CU_ASSERT(cx_bloom_count(bloom) == cx_bloom_count(copy));
+        cx_bloom_destroy(copy);
+    }
+
+    // invalid filters are rejected
+    CU_ASSERT(NULL == cx_bloom_import(0, bloom->hashCount, 0, bloom->bits));
+    CU_ASSERT(NULL == cx_bloom_import(bloom->bitsCount + 1, bloom->hashCount, 0, bloom->bits));
+    CU_ASSERT(NULL == cx_bloom_import(bloom->bitsCount, 0, 0, bloom->bits));
+}
+
+void t_bloom_should_be_cleared()
+{
+    cx_bloom_clear(bloom);
+
+    for (uint32_t i = 0; i < bloomItems; i++)
+    {
+        CU_ASSERT(!cx_bloom_contains(bloom, &i, sizeof(i)));
+    }
+    CU_ASSERT(0 == cx_bloom_count(bloom));
+}
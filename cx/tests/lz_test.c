@@ -0,0 +1,89 @@
+#include "test.h"
+#include "lz.h"
+
+char*           lzInput = NULL;
+char*           lzCompressed = NULL;
+char*           lzOutput = NULL;
+uint32_t        lzSize = 16384;
+
+int t_lz_init()
+{
+    lzInput = malloc(lzSize);
+    lzCompressed = malloc(cx_lz_bound(lzSize));
+    lzOutput = malloc(lzSize);
+
+    bool success = true
+        && NULL != lzInput
+        && NULL != lzCompressed
+        && NULL != lzOutput;
+
+    return CUNIT_RESULT(success);
+}
+
+int t_lz_cleanup()
+{
+    free(lzInput);
+    lzInput = NULL;
+    free(lzCompressed);
+    lzCompressed = NULL;
+    free(lzOutput);
+    lzOutput = NULL;
+
+    bool success = true;
+    return CUNIT_RESULT(success);
+}
+
+void t_lz_should_compress_repetitive_data()
+{
+    uint32_t pos = 0;
+    for (uint32_t i = 0; pos < lzSize; i++)
+    {
+        pos += snprintf(&lzInput[pos], lzSize - pos, "%u;%u;value_%u\n", 1560000000 + i, i % 100, i % 7);
+    }
+
+    uint32_t compressedSize = cx_lz_compress(lzInput, lzSize, lzCompressed, cx_lz_bound(lzSize));
+    CU_ASSERT(compressedSize > 0);
+    CU_ASSERT(compressedSize < lzSize / 2);
+
+    CU_ASSERT((int32_t)lzSize == cx_lz_decompress(lzCompressed, compressedSize, lzOutput, lzSize));
+    CU_ASSERT(0 == memcmp(lzInput, lzOutput, lzSize));
+}
+
+void t_lz_should_roundtrip_incompressible_data()
+{
+    uint32_t seed = 2463534242u;
+    for (uint32_t i = 0; i < lzSize; i++)
+    {
+        seed ^= seed << 13;
+        seed ^= seed >> 17;
+        seed ^= seed << 5;
+        lzInput[i] = (char)seed;
+    }
+
+    uint32_t compressedSize = cx_lz_compress(lzInput, lzSize, lzCompressed, cx_lz_bound(lzSize));
+    CU_ASSERT(compressedSize > 0);
+    CU_ASSERT(compressedSize <= cx_lz_bound(lzSize));
+
+    CU_ASSERT((int32_t)lzSize == cx_lz_decompress(lzCompressed, compressedSize, lzOutput, lzSize));
+    CU_ASSERT(0 == memcmp(lzInput, lzOutput, lzSize));
+}
+
+void t_lz_should_fail_when_output_does_not_fit()
+{
+    memset(lzInput, 'x', lzSize);
+
+    uint32_t compressedSize = cx_lz_compress(lzInput, lzSize, lzCompressed, cx_lz_bound(lzSize));
+    CU_ASSERT(compressedSize > 0);
+
+    CU_ASSERT(0 == cx_lz_compress(lzInput, lzSize, lzCompressed, compressedSize - 1));
+    CU_ASSERT(-1 == cx_lz_decompress(lzCompressed, compressedSize, lzOutput, lzSize - 1));
+}
+
+void t_lz_should_reject_malformed_data()
+{
+    // a match pointing before the beginning of the output
+    const char malformed[] = { 0x10, 'a', 0x05, 0x00 };
+
+    CU_ASSERT(-1 == cx_lz_decompress(malformed, sizeof(malformed), lzOutput, lzSize));
+    CU_ASSERT(0 == cx_lz_decompress(lzCompressed, 0, lzOutput, lzSize));
+}
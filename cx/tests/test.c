@@ -1,5 +1,8 @@
+#include "arena_test.c"
 #include "binrw_test.c"
+#include "bloom_test.c"
 #include "list_test.c"
+#include "lz_test.c"
 #include "halloc_test.c"
 #include "reslock_test.c"
 #include "sort_test.c"
@@ -20,6 +23,20 @@ int main(int _argc, char** _argv)
 
     // +=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=
 
+    suite = CU_add_suite("arena_test.c", t_arena_init, t_arena_cleanup);
+    if (NULL == suite
+        || (NULL == CU_add_test(suite, "t_arena_should_alloc_aligned_memory()", t_arena_should_alloc_aligned_memory))
+        || (NULL == CU_add_test(suite, "t_arena_should_copy_strings()", t_arena_should_copy_strings))
+        || (NULL == CU_add_test(suite, "t_arena_should_alloc_oversized_chunks()", t_arena_should_alloc_oversized_chunks))
+        || (NULL == CU_add_test(suite, "t_arena_should_be_reset()", t_arena_should_be_reset))
+        )
+    {
+        CU_cleanup_registry();
+        return CU_get_error();
+    }
+
+    // +=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=
+
     suite = CU_add_suite("binrw_test.c", t_binrw_init, t_binrw_cleanup);
     if (NULL == suite
         || (NULL == CU_add_test(suite, "t_binrw_should_rw_int64()", t_binrw_should_rw_int64))
@@ -43,6 +60,35 @@ int main(int _argc, char** _argv)
 
     // +=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=
 
+    suite = CU_add_suite("bloom_test.c", t_bloom_init, t_bloom_cleanup);
+    if (NULL == suite
+        || (NULL == CU_add_test(suite, "t_bloom_should_not_contain_items_when_empty()", t_bloom_should_not_contain_items_when_empty))
+        || (NULL == CU_add_test(suite, "t_bloom_should_contain_added_items()", t_bloom_should_contain_added_items))
+        || (NULL == CU_add_test(suite, "t_bloom_should_have_low_false_positive_rate()", t_bloom_should_have_low_false_positive_rate))
+        || (NULL == CU_add_test(suite, "t_bloom_should_be_imported()", t_bloom_should_be_imported))
+        || (NULL == CU_add_test(suite, "t_bloom_should_be_cleared()", t_bloom_should_be_cleared))
+        )
+    {
+        CU_cleanup_registry();
+        return CU_get_error();
+    }
+
+    // +=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=
+
+    suite = CU_add_suite("lz_test.c", t_lz_init, t_lz_cleanup);
+    if (NULL == suite
+        || (NULL == CU_add_test(suite, "t_lz_should_compress_repetitive_data()", t_lz_should_compress_repetitive_data))
+        || (NULL == CU_add_test(suite, "t_lz_should_roundtrip_incompressible_data()", t_lz_should_roundtrip_incompressible_data))
+        || (NULL == CU_add_test(suite, "t_lz_should_fail_when_output_does_not_fit()", t_lz_should_fail_when_output_does_not_fit))
+        || (NULL == CU_add_test(suite, "t_lz_should_reject_malformed_data()", t_lz_should_reject_malformed_data))
+        )
+    {
+        CU_cleanup_registry();
+        return CU_get_error();
+    }
+
+    // +=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=
+
     suite = CU_add_suite("file_test.c", t_file_init, t_file_cleanup);
     if (NULL == suite
         || (NULL == CU_add_test(suite, "t_file_should_absolutize_paths()", t_file_should_absolutize_paths))
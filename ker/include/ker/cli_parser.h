@@ -5,6 +5,8 @@
 #include <cx/cli.h>
 #include <cx/file.h>
 
+#include <ker/defines.h>
+
 /****************************************************************************************
  ***  PUBLIC FUNCTIONS
  ***************************************************************************************/
@@ -13,7 +15,17 @@ bool cli_parse_select(const cx_cli_cmd_t* _cmd, cx_err_t* _err, char** _outTable
 
 bool cli_parse_insert(const cx_cli_cmd_t* _cmd, cx_err_t* _err, char** _outTableName, uint16_t* _outKey, char** _outValue, uint64_t* _outTimestamp);
 
-bool cli_parse_create(const cx_cli_cmd_t* _cmd, cx_err_t* _err, char** _outTableName, uint8_t* _outConsistency, uint16_t* _outNumPartitions, uint32_t* _outCompactionInterval);
+bool cli_parse_delete(const cx_cli_cmd_t* _cmd, cx_err_t* _err, char** _outTableName, uint16_t* _outKey, uint64_t* _outTimestamp);
+
+bool cli_parse_is_batch(const cx_cli_cmd_t* _cmd);
+
+bool cli_parse_select_batch(const cx_cli_cmd_t* _cmd, cx_err_t* _err, char** _outTableName, table_record_t** _outRecords, uint16_t* _outRecordsCount);
+
+bool cli_parse_insert_batch(const cx_cli_cmd_t* _cmd, cx_err_t* _err, char** _outTableName, table_record_t** _outRecords, uint16_t* _outRecordsCount);
+
+bool cli_parse_scan(const cx_cli_cmd_t* _cmd, cx_err_t* _err, char** _outTableName, uint16_t* _outPartition, uint16_t* _outKeyMin, uint16_t* _outKeyMax);
+
+bool cli_parse_create(const cx_cli_cmd_t* _cmd, cx_err_t* _err, char** _outTableName, uint8_t* _outConsistency, uint16_t* _outNumPartitions, uint32_t* _outCompactionInterval, uint32_t* _outTtl);
 
 bool cli_parse_describe(const cx_cli_cmd_t* _cmd, cx_err_t* _err, char** _outTableName);
 
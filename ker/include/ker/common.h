@@ -10,6 +10,12 @@ QUERY_TYPE  common_parse_query(const char* _queryHead);
 
 bool        common_task_data_free(TASK_TYPE _type, void* _data);
 
+bool        common_is_tombstone(const table_record_t* _record);
+
+bool        common_is_tombstone_value(const char* _value);
+
+bool        common_is_expired(const table_record_t* _record, uint32_t _ttl, uint64_t _now);
+
 bool        cfg_get_uint8(t_config* _cfg, char* _key, uint8_t* _out);
 
 bool        cfg_get_uint16(t_config* _cfg, char* _key, uint16_t* _out);
@@ -55,7 +55,7 @@
 
 //TODO refactor pack_req methods to receive a pointer to a buffer position (uint32_t) and return void
 
-uint32_t            common_pack_req_create(char* _buffer, uint16_t _size, uint16_t _remoteId, const char* _tableName, uint8_t _consistency, uint16_t _numPartitions, uint32_t _compactionInterval);
+uint32_t            common_pack_req_create(char* _buffer, uint16_t _size, uint16_t _remoteId, const char* _tableName, uint8_t _consistency, uint16_t _numPartitions, uint32_t _compactionInterval, uint32_t _ttl);
 
 uint32_t            common_pack_req_drop(char* _buffer, uint16_t _size, uint16_t _remoteId, const char* _tableName);
 
@@ -65,6 +65,14 @@ uint32_t            common_pack_req_select(char* _buffer, uint16_t _size, uint16
 
 uint32_t            common_pack_req_insert(char* _buffer, uint16_t _size, uint16_t _remoteId, const char* _tableName, uint16_t _key, const char* _value, uint64_t _timestamp);
 
+uint32_t            common_pack_req_select_batch(char* _buffer, uint16_t _size, uint16_t _remoteId, const char* _tableName, const table_record_t* _records, uint16_t _recordsCount);
+
+bool                common_pack_req_insert_batch(char* _buffer, uint16_t _bufferSize, uint32_t* _bufferPos, uint16_t _remoteId, const char* _tableName, const table_record_t* _records, uint16_t _recordsCount, uint16_t* _recordsPacked);
+
+uint32_t            common_pack_req_delete(char* _buffer, uint16_t _size, uint16_t _remoteId, const char* _tableName, uint16_t _key, uint64_t _timestamp);
+
+uint32_t            common_pack_req_scan(char* _buffer, uint16_t _size, uint16_t _remoteId, const char* _tableName, uint16_t _partition, uint16_t _keyMin, uint16_t _keyMax);
+
 uint32_t            common_pack_res_create(char* _buffer, uint16_t _size, uint16_t _remoteId, const cx_err_t* _err);
 
 uint32_t            common_pack_res_drop(char* _buffer, uint16_t _size, uint16_t _remoteId, const cx_err_t* _err);
@@ -75,6 +83,14 @@ uint32_t            common_pack_res_select(char* _buffer, uint16_t _size, uint16
 
 uint32_t            common_pack_res_insert(char* _buffer, uint16_t _size, uint16_t _remoteId, const cx_err_t* _err);
 
+bool                common_pack_res_select_batch(char* _buffer, uint16_t _bufferSize, uint32_t* _bufferPos, uint16_t _remoteId, const table_record_t* _records, uint16_t _recordsCount, uint16_t* _recordsPacked, const cx_err_t* _err);
+
+uint32_t            common_pack_res_insert_batch(char* _buffer, uint16_t _size, uint16_t _remoteId, const cx_err_t* _err);
+
+uint32_t            common_pack_res_delete(char* _buffer, uint16_t _size, uint16_t _remoteId, const cx_err_t* _err);
+
+bool                common_pack_res_scan(char* _buffer, uint16_t _bufferSize, uint32_t* _bufferPos, uint16_t _remoteId, uint16_t _partitionsCount, const table_record_t* _records, uint32_t _recordsCount, uint32_t* _recordsPacked, const cx_err_t* _err);
+
 uint32_t            common_pack_table_meta(char* _buffer, uint16_t _size, const table_meta_t* _table);
 
 uint32_t            common_pack_table_record(char* _buffer, uint16_t _size, const table_record_t* _record);
@@ -97,6 +113,14 @@ data_select_t*      common_unpack_req_select(const char* _buffer, uint16_t _buff
 
 data_insert_t*      common_unpack_req_insert(const char* _buffer, uint16_t _bufferSize, uint32_t* _bufferPos, uint16_t* _outRemoteId);
 
+data_select_batch_t* common_unpack_req_select_batch(const char* _buffer, uint16_t _bufferSize, uint32_t* _bufferPos, uint16_t* _outRemoteId);
+
+data_insert_batch_t* common_unpack_req_insert_batch(const char* _buffer, uint16_t _bufferSize, uint32_t* _bufferPos, uint16_t* _outRemoteId);
+
+data_delete_t*      common_unpack_req_delete(const char* _buffer, uint16_t _bufferSize, uint32_t* _bufferPos, uint16_t* _outRemoteId);
+
+data_scan_t*        common_unpack_req_scan(const char* _buffer, uint16_t _bufferSize, uint32_t* _bufferPos, uint16_t* _outRemoteId);
+
 void                common_unpack_res_create(const char* _buffer, uint16_t _bufferSize, uint32_t* _bufferPos, uint16_t* _outRemoteId, cx_err_t* _err);
 
 void                common_unpack_res_drop(const char* _buffer, uint16_t _bufferSize, uint32_t* _bufferPos, uint16_t* _outRemoteId, cx_err_t* _err);
@@ -107,6 +131,14 @@ void                common_unpack_res_select(const char* _buffer, uint16_t _buff
 
 void                common_unpack_res_insert(const char* _buffer, uint16_t _bufferSize, uint32_t* _bufferPos, uint16_t* _outRemoteId, cx_err_t* _err);
 
+void                common_unpack_res_select_batch(const char* _buffer, uint16_t _bufferSize, uint32_t* _bufferPos, uint16_t* _outRemoteId, data_select_batch_t* _outData, cx_err_t* _err);
+
+void                common_unpack_res_insert_batch(const char* _buffer, uint16_t _bufferSize, uint32_t* _bufferPos, uint16_t* _outRemoteId, cx_err_t* _err);
+
+void                common_unpack_res_delete(const char* _buffer, uint16_t _bufferSize, uint32_t* _bufferPos, uint16_t* _outRemoteId, cx_err_t* _err);
+
+void                common_unpack_res_scan(const char* _buffer, uint16_t _bufferSize, uint32_t* _bufferPos, uint16_t* _outRemoteId, data_scan_t* _outData, cx_err_t* _err);
+
 void                common_unpack_table_meta(const char* _buffer, uint16_t _bufferSize, uint32_t* _bufferPos, table_meta_t* _outTable);
 
 void                common_unpack_table_record(const char* _buffer, uint16_t _bufferSize, uint32_t* _bufferPos, table_record_t* _outRecord);
@@ -18,6 +18,12 @@
 
 #define MAX_FILE_FRAG 1024
 
+#define MAX_BATCH_RECORDS 256
+
+#define SCAN_ALL_PARTITIONS UINT16_MAX
+
+#define TOMBSTONE_VALUE "\x7f"   // value of the records written by DELETE queries. clients can't insert it as a value.
+
 #define MAX_MEM_SEEDS 16
 #define MAX_MEM_NODES 100
 #define INVALID_MEM_NUMBER 0
@@ -57,6 +63,8 @@ typedef enum ERR_CODE
     ERR_INIT_FS_META,
     ERR_INIT_FS_TABLES,
     ERR_INIT_FS_BITMAP,
+    ERR_INIT_FS_BLOCKS,
+    ERR_INIT_FS_WAL,
     ERR_INIT_MM_MAIN,
     ERR_INIT_MM_FRAMES,
     ERR_CFG_NOTFOUND,
@@ -88,12 +96,14 @@ typedef enum QUERY_TYPE
     QUERY_LOGFILE,
     QUERY_EXIT,
     QUERY_MEMPOOL,
+    QUERY_SCAN,
+    QUERY_DELETE,
     QUERY_COUNT
 } QUERY_TYPE;
 
 static const char *QUERY_NAME[] = {
     "NONE", "CREATE", "DROP", "DESCRIBE", "SELECT", "INSERT",
-    "JOURNAL", "ADD", "RUN", "METRICS", "LOGFILE", "EXIT", "MEMPOOL"
+    "JOURNAL", "ADD", "RUN", "METRICS", "LOGFILE", "EXIT", "MEMPOOL", "SCAN", "DELETE"
 };
 
 typedef enum CONSISTENCY_TYPE
@@ -119,6 +129,7 @@ typedef struct table_meta_t
     uint8_t         consistency;                    // constistency needed for this table.
     uint16_t        partitionsCount;                // number of partitions for this table.
     uint32_t        compactionInterval;             // interval in ms to perform table compaction.
+    uint32_t        ttl;                            // seconds a record lives after its timestamp. zero means forever.
 } table_meta_t;
 
 typedef struct table_record_t
@@ -140,6 +151,7 @@ typedef struct data_create_t
     uint8_t         consistency;
     uint16_t        numPartitions;
     uint32_t        compactionInterval;
+    uint32_t        ttl;
 } data_create_t;
 
 typedef struct data_drop_t
@@ -166,6 +178,42 @@ typedef struct data_insert_t
     table_record_t  record;
 } data_insert_t;
 
+typedef struct data_delete_t
+{
+    table_name_t    tableName;
+    uint16_t        key;
+    uint64_t        timestamp;                      // timestamp of the tombstone to be written (zero means now).
+} data_delete_t;
+
+typedef struct data_select_batch_t
+{
+    table_name_t    tableName;
+    table_record_t* records;                        // records requested (only their keys are given). value is NULL if the key does not exist.
+    uint16_t        recordsCount;                   // number of elements in records.
+    uint16_t        recordsNext;                    // index of the next record to be filled in with the (chunked) response.
+    uint16_t        recordsRemaining;               // number of records still to be received in the (chunked) response.
+} data_select_batch_t;
+
+typedef struct data_insert_batch_t
+{
+    table_name_t    tableName;
+    table_record_t* records;                        // records to be inserted.
+    uint16_t        recordsCount;                   // number of elements in records.
+    uint16_t        recordsNext;                    // index of the next record to be written (MEM resumes from here after a reschedule).
+} data_insert_batch_t;
+
+typedef struct data_scan_t
+{
+    table_name_t    tableName;
+    uint16_t        partition;                      // partition to be scanned (SCAN_ALL_PARTITIONS to scan the whole table).
+    uint16_t        keyMin;                         // lowest key to be returned.
+    uint16_t        keyMax;                         // highest key to be returned.
+    uint16_t        partitionsCount;                // number of partitions of the table (filled in by the LFS).
+    table_record_t* records;                        // most recent record of each key found, sorted by partition and key.
+    uint32_t        recordsCount;                   // number of elements in records.
+    uint32_t        recordsRemaining;               // number of records still to be received in the (chunked) response.
+} data_scan_t;
+
 typedef struct data_dump_t
 {
     table_name_t    tableName;
@@ -179,6 +227,11 @@ typedef struct data_compact_t
     double          endStageTime;
 } data_compact_t;
 
+typedef struct data_compact_part_t
+{
+    struct compact_job_t* job;                      // compaction job shared with the compaction task being helped.
+} data_compact_part_t;
+
 typedef struct data_journal_t
 {
     double          blockedTime;
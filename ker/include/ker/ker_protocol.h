@@ -19,6 +19,10 @@ typedef enum
     KERP_RES_SELECT,
     KERP_RES_INSERT,
     KERP_RES_GOSSIP,
+    KERP_RES_SELECT_BATCH,
+    KERP_RES_INSERT_BATCH,
+    KERP_RES_SCAN,
+    KERP_RES_DELETE,
 } KER_PACKET_HEADERS;
 
 /****************************************************************************************
@@ -41,6 +45,14 @@ void ker_handle_req_select(const cx_net_common_t* _common, void* _userData, cons
 
 void ker_handle_req_insert(const cx_net_common_t* _common, void* _userData, const char* _buffer, uint16_t _bufferSize);
 
+void ker_handle_req_select_batch(const cx_net_common_t* _common, void* _userData, const char* _buffer, uint16_t _bufferSize);
+
+void ker_handle_req_insert_batch(const cx_net_common_t* _common, void* _userData, const char* _buffer, uint16_t _bufferSize);
+
+void ker_handle_req_delete(const cx_net_common_t* _common, void* _userData, const char* _buffer, uint16_t _bufferSize);
+
+void ker_handle_req_scan(const cx_net_common_t* _common, void* _userData, const char* _buffer, uint16_t _bufferSize);
+
 void ker_handle_req_journal(const cx_net_common_t* _common, void* _userData, const char* _buffer, uint16_t _bufferSize);
 
 void ker_handle_req_addmem(const cx_net_common_t* _common, void* _userData, const char* _buffer, uint16_t _bufferSize);
@@ -57,6 +69,14 @@ void ker_handle_res_select(const cx_net_common_t* _common, void* _userData, cons
 
 void ker_handle_res_insert(const cx_net_common_t* _common, void* _userData, const char* _buffer, uint16_t _bufferSize);
 
+void ker_handle_res_select_batch(const cx_net_common_t* _common, void* _userData, const char* _buffer, uint16_t _bufferSize);
+
+void ker_handle_res_insert_batch(const cx_net_common_t* _common, void* _userData, const char* _buffer, uint16_t _bufferSize);
+
+void ker_handle_res_delete(const cx_net_common_t* _common, void* _userData, const char* _buffer, uint16_t _bufferSize);
+
+void ker_handle_res_scan(const cx_net_common_t* _common, void* _userData, const char* _buffer, uint16_t _bufferSize);
+
 void ker_handle_res_gossip(const cx_net_common_t* _common, void* _userData, const char* _buffer, uint16_t _bufferSize);
 
 #endif // KER
@@ -67,7 +87,7 @@ void ker_handle_res_gossip(const cx_net_common_t* _common, void* _userData, cons
 
 uint32_t ker_pack_ack(char* _buffer, uint16_t _size, bool _isGossip, uint16_t _memNumber);
 
-uint32_t ker_pack_req_create(char* _buffer, uint16_t _size, uint16_t _remoteId, const char* _tableName, uint8_t _consistency, uint16_t _numPartitions, uint32_t _compactionInterval);
+uint32_t ker_pack_req_create(char* _buffer, uint16_t _size, uint16_t _remoteId, const char* _tableName, uint8_t _consistency, uint16_t _numPartitions, uint32_t _compactionInterval, uint32_t _ttl);
 
 uint32_t ker_pack_req_drop(char* _buffer, uint16_t _size, uint16_t _remoteId, const char* _tableName);
 
@@ -77,6 +97,14 @@ uint32_t ker_pack_req_select(char* _buffer, uint16_t _size, uint16_t _remoteId,
 
 uint32_t ker_pack_req_insert(char* _buffer, uint16_t _size, uint16_t _remoteId, const char* _tableName, uint16_t _key, const char* _value, uint64_t _timestamp);
 
+uint32_t ker_pack_req_select_batch(char* _buffer, uint16_t _size, uint16_t _remoteId, const char* _tableName, const table_record_t* _records, uint16_t _recordsCount);
+
+bool ker_pack_req_insert_batch(char* _buffer, uint16_t _size, uint32_t* _pos, uint16_t _remoteId, const char* _tableName, const table_record_t* _records, uint16_t _recordsCount, uint16_t* _recordsPacked);
+
+uint32_t ker_pack_req_delete(char* _buffer, uint16_t _size, uint16_t _remoteId, const char* _tableName, uint16_t _key, uint64_t _timestamp);
+
+uint32_t ker_pack_req_scan(char* _buffer, uint16_t _size, uint16_t _remoteId, const char* _tableName, uint16_t _partition, uint16_t _keyMin, uint16_t _keyMax);
+
 uint32_t ker_pack_req_journal(char* _buffer, uint16_t _size, uint16_t _remoteId);
 
 uint32_t ker_pack_req_run(char* _buffer, uint16_t _size, uint16_t _remoteId, const char* _lqlFilePath, const char* _logPath);
@@ -91,4 +119,12 @@ uint32_t ker_pack_res_select(char* _buffer, uint16_t _size, uint16_t _remoteId,
 
 uint32_t ker_pack_res_insert(char* _buffer, uint16_t _size, uint16_t _remoteId, const cx_err_t* _err);
 
+bool ker_pack_res_select_batch(char* _buffer, uint16_t _size, uint32_t* _pos, uint16_t _remoteId, const cx_err_t* _err, const table_record_t* _records, uint16_t _recordsCount, uint16_t* _recordsPacked);
+
+uint32_t ker_pack_res_insert_batch(char* _buffer, uint16_t _size, uint16_t _remoteId, const cx_err_t* _err);
+
+uint32_t ker_pack_res_delete(char* _buffer, uint16_t _size, uint16_t _remoteId, const cx_err_t* _err);
+
+bool ker_pack_res_scan(char* _buffer, uint16_t _size, uint32_t* _pos, uint16_t _remoteId, const cx_err_t* _err, uint16_t _partitionsCount, const table_record_t* _records, uint32_t _recordsCount, uint32_t* _recordsPacked);
+
 #endif // KER_PROTOCOL_H_
\ No newline at end of file
@@ -22,6 +22,14 @@ void report_select(const task_t* _task, FILE* _stream);
 
 void report_insert(const task_t* _task, FILE* _stream);
 
+void report_select_batch(const task_t* _task, FILE* _stream);
+
+void report_insert_batch(const task_t* _task, FILE* _stream);
+
+void report_delete(const task_t* _task, FILE* _stream);
+
+void report_scan(const task_t* _task, FILE* _stream);
+
 void report_create(const task_t* _task, FILE* _stream);
 
 void report_describe(const task_t* _task, FILE* _stream);
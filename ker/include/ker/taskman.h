@@ -48,6 +48,11 @@ typedef enum TASK_TYPE
     TASK_WT_JOURNAL =   TASK_WT | UINT8_C(8),   // worker thread task to run a memory journal.
     TASK_WT_ADDMEM =    TASK_WT | UINT8_C(9),   // worker thread task to assign a MEM node number to consistency criteria.
     TASK_WT_RUN =       TASK_WT | UINT8_C(10),  // worker thread task to run an LQL script.
+    TASK_WT_COMPACT_PART = TASK_WT | UINT8_C(11), // worker thread task to merge partitions of a table being compacted.
+    TASK_WT_SELECT_BATCH = TASK_WT | UINT8_C(12), // worker thread task to do a select query of multiple keys on a table.
+    TASK_WT_INSERT_BATCH = TASK_WT | UINT8_C(13), // worker thread task to do an insert query of multiple records in a table.
+    TASK_WT_SCAN =      TASK_WT | UINT8_C(14),  // worker thread task to read every record of a table (or a key range of a partition).
+    TASK_WT_DELETE =    TASK_WT | UINT8_C(15),  // worker thread task to delete a key from a table (writing a tombstone).
 } TASK_TYPE;
 
 typedef struct task_t
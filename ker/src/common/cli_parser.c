@@ -1,11 +1,13 @@
 #include <ker/cli_parser.h>
 #include <ker/defines.h>
+#include <ker/common.h>
 
 #include <cx/cx.h>
 #include <cx/str.h>
 #include <cx/math.h>
 #include <cx/timer.h>
 #include <cx/linesf.h>
+#include <cx/mem.h>
 
 #include <ctype.h>
 #include <string.h>
@@ -25,10 +27,14 @@ static bool     valid_timestamp(const char* _str);
 
 static bool     valid_consistency(const char* _str);
 
+static uint16_t parse_keys_list(const char* _str, table_record_t** _outRecords);
+
 static bool     valid_partitions_number(const char* _str);
 
 static bool     valid_compaction_interval(const char* _str);
 
+static bool     valid_ttl(const char* _str);
+
 static bool     valid_memory_number(const char* _str);
 
 static uint8_t  parse_consistency_str(const char* _str);
@@ -83,7 +89,157 @@ bool cli_parse_insert(const cx_cli_cmd_t* _cmd, cx_err_t* _err, char** _outTable
     return false;
 }
 
-bool cli_parse_create(const cx_cli_cmd_t* _cmd, cx_err_t* _err, char** _outTableName, uint8_t* _outConsistency, uint16_t* _outNumPartitions, uint32_t* _outCompactionInterval)
+bool cli_parse_delete(const cx_cli_cmd_t* _cmd, cx_err_t* _err, char** _outTableName, uint16_t* _outKey, uint64_t* _outTimestamp)
+{
+    CX_CHECK(0 == strcmp("DELETE", _cmd->header), "invalid command!");
+
+    if (_cmd->argsCount >= 2
+        && valid_table(_cmd->args[0])
+        && valid_key(_cmd->args[1])
+        && (_cmd->argsCount >= 3 ? valid_timestamp(_cmd->args[2]) : true))
+    {
+        (*_outTableName) = _cmd->args[0];
+        cx_str_to_upper(*_outTableName);
+        cx_str_to_uint16(_cmd->args[1], _outKey);
+        (*_outTimestamp) = 0;
+
+        if (_cmd->argsCount >= 3)
+        {
+            cx_str_to_uint64(_cmd->args[2], _outTimestamp);
+        }
+
+        return true;
+    }
+
+    CX_ERR_SET(_err, 1, "Invalid Syntax. Usage: DELETE [TABLE_NAME] [KEY] (TIMESTAMP)");
+    return false;
+}
+
+bool cli_parse_is_batch(const cx_cli_cmd_t* _cmd)
+{
+    // batch queries are SELECT/INSERT queries with a comma-separated list of keys.
+    return (_cmd->argsCount >= 2) && (NULL != strchr(_cmd->args[1], ','));
+}
+
+bool cli_parse_select_batch(const cx_cli_cmd_t* _cmd, cx_err_t* _err, char** _outTableName, table_record_t** _outRecords, uint16_t* _outRecordsCount)
+{
+    CX_CHECK(0 == strcmp("SELECT", _cmd->header), "invalid command!");
+
+    uint16_t recordsCount = 0;
+
+    if (_cmd->argsCount >= 2
+        && valid_table(_cmd->args[0])
+        && (recordsCount = parse_keys_list(_cmd->args[1], _outRecords)) > 0)
+    {
+        (*_outTableName) = _cmd->args[0];
+        cx_str_to_upper(*_outTableName);
+        (*_outRecordsCount) = recordsCount;
+        return true;
+    }
+
+    CX_ERR_SET(_err, 1, "Invalid Syntax. Usage: SELECT [TABLE_NAME] [KEY],[KEY],... (up to %d keys)", MAX_BATCH_RECORDS);
+    return false;
+}
+
+bool cli_parse_insert_batch(const cx_cli_cmd_t* _cmd, cx_err_t* _err, char** _outTableName, table_record_t** _outRecords, uint16_t* _outRecordsCount)
+{
+    CX_CHECK(0 == strcmp("INSERT", _cmd->header), "invalid command!");
+
+    // values can't contain semicolons, so we use them to separate the value of each key.
+    uint16_t        recordsCount = 0;
+    table_record_t* records = NULL;
+    uint16_t        valuesCount = 0;
+    uint64_t        timestamp = 0;
+    const char*     value = NULL;
+    const char*     valueEnd = NULL;
+    bool            valid = true;
+
+    if (_cmd->argsCount >= 3
+        && valid_table(_cmd->args[0])
+        && (_cmd->argsCount >= 4 ? valid_timestamp(_cmd->args[3]) : true)
+        && (recordsCount = parse_keys_list(_cmd->args[1], &records)) > 0)
+    {
+        if (_cmd->argsCount >= 4)
+        {
+            cx_str_to_uint64(_cmd->args[3], &timestamp);
+        }
+
+        value = _cmd->args[2];
+        while (valuesCount < recordsCount)
+        {
+            valueEnd = strchr(value, ';');
+            if (NULL == valueEnd) valueEnd = value + strlen(value);
+
+            records[valuesCount].value = malloc(valueEnd - value + 1);
+            memcpy(records[valuesCount].value, value, valueEnd - value);
+            records[valuesCount].value[valueEnd - value] = '\0';
+            records[valuesCount].timestamp = timestamp;
+            valuesCount++;
+
+            // same rule as valid_value, every value of the batch is checked on its own.
+            if (common_is_tombstone_value(records[valuesCount - 1].value))
+            {
+                valid = false;
+                break;
+            }
+            if ('\0' == *valueEnd) break;
+            value = valueEnd + 1;
+        }
+
+        if (valid && valuesCount == recordsCount && ('\0' == *valueEnd))
+        {
+            (*_outTableName) = _cmd->args[0];
+            cx_str_to_upper(*_outTableName);
+            (*_outRecords) = records;
+            (*_outRecordsCount) = recordsCount;
+            return true;
+        }
+
+        for (uint16_t i = 0; i < valuesCount; i++)
+            free(records[i].value);
+    }
+    free(records);
+
+    CX_ERR_SET(_err, 1, "Invalid Syntax. Usage: INSERT [TABLE_NAME] [KEY],[KEY],... \"[VALUE];[VALUE];...\" (TIMESTAMP) (up to %d keys)", MAX_BATCH_RECORDS);
+    return false;
+}
+
+bool cli_parse_scan(const cx_cli_cmd_t* _cmd, cx_err_t* _err, char** _outTableName, uint16_t* _outPartition, uint16_t* _outKeyMin, uint16_t* _outKeyMax)
+{
+    CX_CHECK(0 == strcmp("SCAN", _cmd->header), "invalid command!");
+
+    // the whole table is scanned unless a partition (and optionally a key range within it) is given.
+    if ((1 == _cmd->argsCount || 2 == _cmd->argsCount || 4 <= _cmd->argsCount)
+        && valid_table(_cmd->args[0])
+        && (_cmd->argsCount >= 2 ? valid_key(_cmd->args[1]) : true)
+        && (_cmd->argsCount >= 4 ? valid_key(_cmd->args[2]) && valid_key(_cmd->args[3]) : true))
+    {
+        (*_outTableName) = _cmd->args[0];
+        cx_str_to_upper(*_outTableName);
+        (*_outPartition) = SCAN_ALL_PARTITIONS;
+        (*_outKeyMin) = 0;
+        (*_outKeyMax) = UINT16_MAX;
+
+        if (_cmd->argsCount >= 2)
+        {
+            cx_str_to_uint16(_cmd->args[1], _outPartition);
+        }
+
+        if (_cmd->argsCount >= 4)
+        {
+            cx_str_to_uint16(_cmd->args[2], _outKeyMin);
+            cx_str_to_uint16(_cmd->args[3], _outKeyMax);
+        }
+
+        if ((*_outKeyMin) <= (*_outKeyMax))
+            return true;
+    }
+
+    CX_ERR_SET(_err, 1, "Invalid Syntax. Usage: SCAN [TABLE_NAME] (PARTITION) (KEY_FROM KEY_TO)");
+    return false;
+}
+
+bool cli_parse_create(const cx_cli_cmd_t* _cmd, cx_err_t* _err, char** _outTableName, uint8_t* _outConsistency, uint16_t* _outNumPartitions, uint32_t* _outCompactionInterval, uint32_t* _outTtl)
 {
     CX_CHECK(0 == strcmp("CREATE", _cmd->header), "invalid command!");
 
@@ -91,18 +247,25 @@ bool cli_parse_create(const cx_cli_cmd_t* _cmd, cx_err_t* _err, char** _outTable
         && valid_table(_cmd->args[0])
         && valid_consistency(_cmd->args[1])
         && valid_partitions_number(_cmd->args[2])
-        && valid_compaction_interval(_cmd->args[3]))
+        && valid_compaction_interval(_cmd->args[3])
+        && (_cmd->argsCount >= 5 ? valid_ttl(_cmd->args[4]) : true))
     {
         (*_outTableName) = _cmd->args[0];
         cx_str_to_upper(*_outTableName);
         (*_outConsistency) = parse_consistency_str(_cmd->args[1]);
         cx_str_to_uint16(_cmd->args[2], _outNumPartitions);
         cx_str_to_uint32(_cmd->args[3], _outCompactionInterval);
+        (*_outTtl) = 0;
+
+        if (_cmd->argsCount >= 5)
+        {
+            cx_str_to_uint32(_cmd->args[4], _outTtl);
+        }
 
         return true;
     }
 
-    CX_ERR_SET(_err, 1, "Invalid Syntax. Usage: CREATE [TABLE_NAME] [CONSISTENCY] [NUM_PARTITIONS] [COMPACTION_INTERVAL]");
+    CX_ERR_SET(_err, 1, "Invalid Syntax. Usage: CREATE [TABLE_NAME] [CONSISTENCY] [NUM_PARTITIONS] [COMPACTION_INTERVAL] (TTL_SECONDS)");
     return false;
 }
 
@@ -199,7 +362,8 @@ static bool valid_key(const char* _str)
 
 static bool valid_value(const char* _value)
 {
-    return NULL == strrchr(_value, ';');
+    return NULL == strrchr(_value, ';')
+        && !common_is_tombstone_value(_value);
 }
 
 static bool valid_timestamp(const char* _str)
@@ -225,12 +389,57 @@ static bool valid_compaction_interval(const char* _str)
     return cx_str_to_uint32(_str, &ui32);
 }
 
+static bool valid_ttl(const char* _str)
+{
+    uint32_t ui32 = 0;
+    return cx_str_to_uint32(_str, &ui32);
+}
+
 static bool valid_memory_number(const char* _str)
 {
     uint16_t ui16 = 0;
     return cx_str_to_uint16(_str, &ui16);
 }
 
+static uint16_t parse_keys_list(const char* _str, table_record_t** _outRecords)
+{
+    // parses a comma-separated list of keys. returns the number of keys parsed or zero
+    // if the list is invalid (in which case _outRecords is not allocated).
+    char            key[6];
+    uint16_t        count = 0;
+    const char*     begin = _str;
+    const char*     end = NULL;
+    table_record_t* records = CX_MEM_ARR_ALLOC(records, MAX_BATCH_RECORDS);
+
+    while (true)
+    {
+        end = strchr(begin, ',');
+        if (NULL == end) end = begin + strlen(begin);
+
+        if (count == MAX_BATCH_RECORDS
+            || end == begin
+            || (uint32_t)(end - begin) >= sizeof(key))
+            break;
+
+        memcpy(key, begin, end - begin);
+        key[end - begin] = '\0';
+        if (!valid_key(key)) break;
+
+        cx_str_to_uint16(key, &records[count].key);
+        count++;
+
+        if ('\0' == *end)
+        {
+            (*_outRecords) = records;
+            return count;
+        }
+        begin = end + 1;
+    }
+
+    free(records);
+    return 0;
+}
+
 static uint8_t parse_consistency_str(const char* _str)
 {
     if (strcasecmp("SC", _str) == 0)
@@ -21,6 +21,26 @@ QUERY_TYPE common_parse_query(const char* _queryHead)
     return QUERY_NONE;
 }
 
+bool common_is_tombstone(const table_record_t* _record)
+{
+    // records written by DELETE queries. they hide any older record of the same key until 
+    // the LFS gets rid of them (along with those older records) during compaction.
+    return common_is_tombstone_value(_record->value);
+}
+
+bool common_is_tombstone_value(const char* _value)
+{
+    // only the exact value is reserved, values merely containing it are regular values.
+    return NULL != _value && 0 == strcmp(TOMBSTONE_VALUE, _value);
+}
+
+bool common_is_expired(const table_record_t* _record, uint32_t _ttl, uint64_t _now)
+{
+    // records of tables created with a TTL (in seconds) are no longer visible once it elapses
+    // since their timestamp. a zero TTL means they never expire.
+    return 0 != _ttl && _record->timestamp + (uint64_t)_ttl * 1000 <= _now;
+}
+
 bool common_task_data_free(TASK_TYPE _type, void* _data)
 {
     switch (_type)
@@ -64,6 +84,46 @@ bool common_task_data_free(TASK_TYPE _type, void* _data)
         break;
     }
 
+    case TASK_WT_SELECT_BATCH:
+    {
+        data_select_batch_t* data = (data_select_batch_t*)_data;
+        for (uint16_t i = 0; i < data->recordsCount; i++)
+            free(data->records[i].value);
+        free(data->records);
+        data->records = NULL;
+        data->recordsCount = 0;
+        break;
+    }
+
+    case TASK_WT_DELETE:
+    {
+        data_delete_t* data = (data_delete_t*)_data;
+        //noop
+        break;
+    }
+
+    case TASK_WT_INSERT_BATCH:
+    {
+        data_insert_batch_t* data = (data_insert_batch_t*)_data;
+        for (uint16_t i = 0; i < data->recordsCount; i++)
+            free(data->records[i].value);
+        free(data->records);
+        data->records = NULL;
+        data->recordsCount = 0;
+        break;
+    }
+
+    case TASK_WT_SCAN:
+    {
+        data_scan_t* data = (data_scan_t*)_data;
+        for (uint32_t i = 0; i < data->recordsCount; i++)
+            free(data->records[i].value);
+        free(data->records);
+        data->records = NULL;
+        data->recordsCount = 0;
+        break;
+    }
+
     case TASK_WT_DUMP:
     {
         data_dump_t* data = (data_dump_t*)_data;
@@ -78,6 +138,13 @@ bool common_task_data_free(TASK_TYPE _type, void* _data)
         break;
     }
 
+    case TASK_WT_COMPACT_PART:
+    {
+        data_compact_part_t* data = (data_compact_part_t*)_data;
+        //noop (the job is released by the worker)
+        break;
+    }
+
     case TASK_WT_JOURNAL:
     {
         data_journal_t* data = (data_journal_t*)_data;
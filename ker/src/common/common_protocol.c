@@ -4,6 +4,7 @@
 #include <cx/binw.h>
 #include <cx/mem.h>
 #include <cx/str.h>
+#include <cx/math.h>
 
 /****************************************************************************************
  ***  PRIVATE DECLARATIONS
@@ -21,7 +22,7 @@ static void         _common_unpack_res_generic(const char* _buffer, uint16_t _bu
  ***  COMMON MESSAGE PACKERS
  ***************************************************************************************/
 
-uint32_t common_pack_req_create(char* _buffer, uint16_t _size, uint16_t _remoteId, const char* _tableName, uint8_t _consistency, uint16_t _numPartitions, uint32_t _compactionInterval)
+uint32_t common_pack_req_create(char* _buffer, uint16_t _size, uint16_t _remoteId, const char* _tableName, uint8_t _consistency, uint16_t _numPartitions, uint32_t _compactionInterval, uint32_t _ttl)
 {
     uint32_t pos = 0;
     common_pack_remote_id(_buffer, _size, &pos, _remoteId);
@@ -29,6 +30,7 @@ uint32_t common_pack_req_create(char* _buffer, uint16_t _size, uint16_t _remoteI
     cx_binw_uint8(_buffer, _size, &pos, _consistency);
     cx_binw_uint16(_buffer, _size, &pos, _numPartitions);
     cx_binw_uint32(_buffer, _size, &pos, _compactionInterval);
+    cx_binw_uint32(_buffer, _size, &pos, _ttl);
     return pos;
 }
 
@@ -68,6 +70,77 @@ uint32_t common_pack_req_insert(char* _buffer, uint16_t _size, uint16_t _remoteI
     return pos;
 }
 
+uint32_t common_pack_req_select_batch(char* _buffer, uint16_t _size, uint16_t _remoteId, const char* _tableName, const table_record_t* _records, uint16_t _recordsCount)
+{
+    // only the keys of the given records are packed. MAX_BATCH_RECORDS keys always fit in a single packet.
+    CX_CHECK(_recordsCount <= MAX_BATCH_RECORDS, "a maximum of %d keys can be requested in a single batch!", MAX_BATCH_RECORDS);
+
+    uint32_t pos = 0;
+    common_pack_remote_id(_buffer, _size, &pos, _remoteId);
+    cx_binw_str(_buffer, _size, &pos, _tableName);
+    cx_binw_uint16(_buffer, _size, &pos, _recordsCount);
+    for (uint16_t i = 0; i < _recordsCount; i++)
+    {
+        cx_binw_uint16(_buffer, _size, &pos, _records[i].key);
+    }
+    return pos;
+}
+
+bool common_pack_req_insert_batch(char* _buffer, uint16_t _bufferSize, uint32_t* _bufferPos, uint16_t _remoteId, const char* _tableName, const table_record_t* _records, uint16_t _recordsCount, uint16_t* _recordsPacked)
+{
+    // packs as many of the remaining records as they fit in a single packet. each packet is 
+    // a self-contained batch request, so the caller must send it and wait for its response 
+    // before calling this method again to pack the next batch of records.
+    (*_bufferPos) = 0;
+
+    common_pack_remote_id(_buffer, _bufferSize, _bufferPos, _remoteId);
+    cx_binw_str(_buffer, _bufferSize, _bufferPos, _tableName);
+
+    uint32_t countPos = (*_bufferPos);
+    uint16_t count = 0;
+    cx_binw_uint16(_buffer, _bufferSize, _bufferPos, count);
+
+    payload_t tmp;
+    uint32_t  recordSize = 0;
+
+    for (uint16_t i = (*_recordsPacked); i < _recordsCount; i++)
+    {
+        recordSize = common_pack_table_record(tmp, sizeof(tmp), &_records[i]);
+
+        if (recordSize > _bufferSize - (*_bufferPos))
+            break; // not enough space to append this one
+
+        memcpy(&_buffer[*_bufferPos], tmp, recordSize);
+        (*_bufferPos) = (*_bufferPos) + recordSize;
+        (*_recordsPacked) = (*_recordsPacked) + 1;
+        count++;
+    }
+
+    cx_binw_uint16(_buffer, _bufferSize, &countPos, count);
+    return (*_recordsPacked) == _recordsCount;
+}
+
+uint32_t common_pack_req_delete(char* _buffer, uint16_t _size, uint16_t _remoteId, const char* _tableName, uint16_t _key, uint64_t _timestamp)
+{
+    uint32_t pos = 0;
+    common_pack_remote_id(_buffer, _size, &pos, _remoteId);
+    cx_binw_str(_buffer, _size, &pos, _tableName);
+    cx_binw_uint16(_buffer, _size, &pos, _key);
+    cx_binw_uint64(_buffer, _size, &pos, _timestamp);
+    return pos;
+}
+
+uint32_t common_pack_req_scan(char* _buffer, uint16_t _size, uint16_t _remoteId, const char* _tableName, uint16_t _partition, uint16_t _keyMin, uint16_t _keyMax)
+{
+    uint32_t pos = 0;
+    common_pack_remote_id(_buffer, _size, &pos, _remoteId);
+    cx_binw_str(_buffer, _size, &pos, _tableName);
+    cx_binw_uint16(_buffer, _size, &pos, _partition);
+    cx_binw_uint16(_buffer, _size, &pos, _keyMin);
+    cx_binw_uint16(_buffer, _size, &pos, _keyMax);
+    return pos;
+}
+
 uint32_t common_pack_res_create(char* _buffer, uint16_t _size, uint16_t _remoteId, const cx_err_t* _err)
 {
     uint32_t pos = 0;
@@ -143,6 +216,104 @@ uint32_t common_pack_res_insert(char* _buffer, uint16_t _size, uint16_t _remoteI
     return pos;
 }
 
+bool common_pack_res_select_batch(char* _buffer, uint16_t _bufferSize, uint32_t* _bufferPos, uint16_t _remoteId, const table_record_t* _records, uint16_t _recordsCount, uint16_t* _recordsPacked, const cx_err_t* _err)
+{
+    // reset the buffer position. each call to this method assumes a new packet will be send
+    (*_bufferPos) = 0;
+
+    common_pack_remote_id(_buffer, _bufferSize, _bufferPos, _remoteId);
+
+    if ((*_recordsPacked) == 0) // first packet, send the result and the total amount
+    {
+        _common_pack_err(_buffer, _bufferSize, _bufferPos, _err);
+        if (ERR_NONE != _err->code)
+        {
+            return true; // the whole batch failed, there's nothing else to pack.
+        }
+        cx_binw_uint16(_buffer, _bufferSize, _bufferPos, _recordsCount);
+    }
+
+    // start sending them in chunks. each record is preceded by a flag telling whether it was found or not.
+    payload_t tmp;
+    uint32_t  recordSize = 0;
+
+    for (uint16_t i = (*_recordsPacked); i < _recordsCount; i++)
+    {
+        recordSize = 0;
+        cx_binw_bool(tmp, sizeof(tmp), &recordSize, NULL != _records[i].value);
+        if (NULL != _records[i].value)
+            recordSize += common_pack_table_record(&tmp[recordSize], sizeof(tmp) - recordSize, &_records[i]);
+
+        if (recordSize > _bufferSize - (*_bufferPos))
+        {
+            // not enough space to append this one
+            return false; // the packing is not yet complete
+        }
+
+        // append it
+        memcpy(&_buffer[*_bufferPos], tmp, recordSize);
+        (*_bufferPos) = (*_bufferPos) + recordSize;
+        (*_recordsPacked) = (*_recordsPacked) + 1;
+    }
+
+    return true;
+}
+
+uint32_t common_pack_res_insert_batch(char* _buffer, uint16_t _size, uint16_t _remoteId, const cx_err_t* _err)
+{
+    uint32_t pos = 0;
+    _common_pack_res_generic(_buffer, _size, &pos, _remoteId, _err);
+    return pos;
+}
+
+uint32_t common_pack_res_delete(char* _buffer, uint16_t _size, uint16_t _remoteId, const cx_err_t* _err)
+{
+    uint32_t pos = 0;
+    _common_pack_res_generic(_buffer, _size, &pos, _remoteId, _err);
+    return pos;
+}
+
+bool common_pack_res_scan(char* _buffer, uint16_t _bufferSize, uint32_t* _bufferPos, uint16_t _remoteId, uint16_t _partitionsCount, const table_record_t* _records, uint32_t _recordsCount, uint32_t* _recordsPacked, const cx_err_t* _err)
+{
+    // reset the buffer position. each call to this method assumes a new packet will be send
+    (*_bufferPos) = 0;
+
+    common_pack_remote_id(_buffer, _bufferSize, _bufferPos, _remoteId);
+
+    if ((*_recordsPacked) == 0) // first packet, send the result and the total amount
+    {
+        _common_pack_err(_buffer, _bufferSize, _bufferPos, _err);
+        if (ERR_NONE != _err->code)
+        {
+            return true; // the scan failed, there's nothing else to pack.
+        }
+        cx_binw_uint16(_buffer, _bufferSize, _bufferPos, _partitionsCount);
+        cx_binw_uint32(_buffer, _bufferSize, _bufferPos, _recordsCount);
+    }
+
+    // start sending them in chunks
+    payload_t tmp;
+    uint32_t  recordSize = 0;
+
+    for (uint32_t i = (*_recordsPacked); i < _recordsCount; i++)
+    {
+        recordSize = common_pack_table_record(tmp, sizeof(tmp), &_records[i]);
+
+        if (recordSize > _bufferSize - (*_bufferPos))
+        {
+            // not enough space to append this one
+            return false; // the packing is not yet complete
+        }
+
+        // append it
+        memcpy(&_buffer[*_bufferPos], tmp, recordSize);
+        (*_bufferPos) = (*_bufferPos) + recordSize;
+        (*_recordsPacked) = (*_recordsPacked) + 1;
+    }
+
+    return true;
+}
+
 uint32_t common_pack_table_meta(char* _buffer, uint16_t _size, const table_meta_t* _table)
 {
     uint32_t pos = 0;
@@ -150,6 +321,7 @@ uint32_t common_pack_table_meta(char* _buffer, uint16_t _size, const table_meta_
     cx_binw_uint8(_buffer, _size, &pos, _table->consistency);
     cx_binw_uint16(_buffer, _size, &pos, _table->partitionsCount);
     cx_binw_uint32(_buffer, _size, &pos, _table->compactionInterval);
+    cx_binw_uint32(_buffer, _size, &pos, _table->ttl);
     return pos;
 }
 
@@ -190,6 +362,7 @@ data_create_t* common_unpack_req_create(const char* _buffer, uint16_t _bufferSiz
     cx_binr_uint8(_buffer, _bufferSize, _bufferPos, &data->consistency);
     cx_binr_uint16(_buffer, _bufferSize, _bufferPos, &data->numPartitions);
     cx_binr_uint32(_buffer, _bufferSize, _bufferPos, &data->compactionInterval);
+    cx_binr_uint32(_buffer, _bufferSize, _bufferPos, &data->ttl);
     return data;
 }
 
@@ -243,6 +416,57 @@ data_insert_t* common_unpack_req_insert(const char* _buffer, uint16_t _bufferSiz
     return data;
 }
 
+data_select_batch_t* common_unpack_req_select_batch(const char* _buffer, uint16_t _bufferSize, uint32_t* _bufferPos, uint16_t* _outRemoteId)
+{
+    data_select_batch_t* data = CX_MEM_STRUCT_ALLOC(data);
+    common_unpack_remote_id(_buffer, _bufferSize, _bufferPos, _outRemoteId);
+    cx_binr_str(_buffer, _bufferSize, _bufferPos, data->tableName, sizeof(data->tableName));
+    cx_binr_uint16(_buffer, _bufferSize, _bufferPos, &data->recordsCount);
+
+    data->records = CX_MEM_ARR_ALLOC(data->records, data->recordsCount);
+    for (uint16_t i = 0; i < data->recordsCount; i++)
+    {
+        cx_binr_uint16(_buffer, _bufferSize, _bufferPos, &data->records[i].key);
+    }
+    return data;
+}
+
+data_insert_batch_t* common_unpack_req_insert_batch(const char* _buffer, uint16_t _bufferSize, uint32_t* _bufferPos, uint16_t* _outRemoteId)
+{
+    data_insert_batch_t* data = CX_MEM_STRUCT_ALLOC(data);
+    common_unpack_remote_id(_buffer, _bufferSize, _bufferPos, _outRemoteId);
+    cx_binr_str(_buffer, _bufferSize, _bufferPos, data->tableName, sizeof(data->tableName));
+    cx_binr_uint16(_buffer, _bufferSize, _bufferPos, &data->recordsCount);
+
+    data->records = CX_MEM_ARR_ALLOC(data->records, data->recordsCount);
+    for (uint16_t i = 0; i < data->recordsCount; i++)
+    {
+        common_unpack_table_record(_buffer, _bufferSize, _bufferPos, &data->records[i]);
+    }
+    return data;
+}
+
+data_delete_t* common_unpack_req_delete(const char* _buffer, uint16_t _bufferSize, uint32_t* _bufferPos, uint16_t* _outRemoteId)
+{
+    data_delete_t* data = CX_MEM_STRUCT_ALLOC(data);
+    common_unpack_remote_id(_buffer, _bufferSize, _bufferPos, _outRemoteId);
+    cx_binr_str(_buffer, _bufferSize, _bufferPos, data->tableName, sizeof(data->tableName));
+    cx_binr_uint16(_buffer, _bufferSize, _bufferPos, &data->key);
+    cx_binr_uint64(_buffer, _bufferSize, _bufferPos, &data->timestamp);
+    return data;
+}
+
+data_scan_t* common_unpack_req_scan(const char* _buffer, uint16_t _bufferSize, uint32_t* _bufferPos, uint16_t* _outRemoteId)
+{
+    data_scan_t* data = CX_MEM_STRUCT_ALLOC(data);
+    common_unpack_remote_id(_buffer, _bufferSize, _bufferPos, _outRemoteId);
+    cx_binr_str(_buffer, _bufferSize, _bufferPos, data->tableName, sizeof(data->tableName));
+    cx_binr_uint16(_buffer, _bufferSize, _bufferPos, &data->partition);
+    cx_binr_uint16(_buffer, _bufferSize, _bufferPos, &data->keyMin);
+    cx_binr_uint16(_buffer, _bufferSize, _bufferPos, &data->keyMax);
+    return data;
+}
+
 void common_unpack_res_create(const char* _buffer, uint16_t _bufferSize, uint32_t* _bufferPos, uint16_t* _outRemoteId, cx_err_t* _err)
 {
     _common_unpack_res_generic(_buffer, _bufferSize, _bufferPos, _outRemoteId, _err);
@@ -308,12 +532,98 @@ void common_unpack_res_insert(const char* _buffer, uint16_t _bufferSize, uint32_
     _common_unpack_res_generic(_buffer, _bufferSize, _bufferPos, _outRemoteId, _err);
 }
 
+void common_unpack_res_select_batch(const char* _buffer, uint16_t _bufferSize, uint32_t* _bufferPos, uint16_t* _outRemoteId, data_select_batch_t* _outData, cx_err_t* _err)
+{
+    // the records received are stored starting at _outData->recordsNext, which must be set
+    // by the requester to the index of the first record of the batch it sent.
+    uint16_t recordsCount = 0;
+    bool     found = false;
+
+    common_unpack_remote_id(_buffer, _bufferSize, _bufferPos, _outRemoteId);
+
+    // first packet (from the list of chunks)
+    if (_outData->recordsRemaining == 0)
+    {
+        _common_unpack_err(_buffer, _bufferSize, _bufferPos, _err);
+        if (ERR_NONE != _err->code)
+        {
+            // request failed... _err contains the reason of the failure.
+            return;
+        }
+
+        cx_binr_uint16(_buffer, _bufferSize, _bufferPos, &recordsCount);
+        CX_CHECK(_outData->recordsNext + recordsCount <= _outData->recordsCount, "invalid number of records received (%d)!", recordsCount);
+        _outData->recordsRemaining = cx_math_min(recordsCount, _outData->recordsCount - _outData->recordsNext);
+    }
+
+    while (_outData->recordsRemaining > 0 && (*_bufferPos) < _bufferSize)
+    {
+        table_record_t* record = &_outData->records[_outData->recordsNext];
+
+        cx_binr_bool(_buffer, _bufferSize, _bufferPos, &found);
+        if (found)
+        {
+            free(record->value);
+            common_unpack_table_record(_buffer, _bufferSize, _bufferPos, record);
+        }
+
+        _outData->recordsNext++;
+        _outData->recordsRemaining--;
+    }
+}
+
+void common_unpack_res_insert_batch(const char* _buffer, uint16_t _bufferSize, uint32_t* _bufferPos, uint16_t* _outRemoteId, cx_err_t* _err)
+{
+    _common_unpack_res_generic(_buffer, _bufferSize, _bufferPos, _outRemoteId, _err);
+}
+
+void common_unpack_res_delete(const char* _buffer, uint16_t _bufferSize, uint32_t* _bufferPos, uint16_t* _outRemoteId, cx_err_t* _err)
+{
+    _common_unpack_res_generic(_buffer, _bufferSize, _bufferPos, _outRemoteId, _err);
+}
+
+void common_unpack_res_scan(const char* _buffer, uint16_t _bufferSize, uint32_t* _bufferPos, uint16_t* _outRemoteId, data_scan_t* _outData, cx_err_t* _err)
+{
+    uint32_t recordsCount = 0;
+
+    common_unpack_remote_id(_buffer, _bufferSize, _bufferPos, _outRemoteId);
+
+    // first packet (from the list of chunks)
+    if (_outData->recordsRemaining == 0)
+    {
+        _common_unpack_err(_buffer, _bufferSize, _bufferPos, _err);
+        if (ERR_NONE != _err->code)
+        {
+            // request failed... _err contains the reason of the failure.
+            return;
+        }
+
+        // records received by a previous scan (if any) are replaced by the new ones
+        for (uint32_t i = 0; i < _outData->recordsCount; i++)
+            free(_outData->records[i].value);
+        free(_outData->records);
+
+        cx_binr_uint16(_buffer, _bufferSize, _bufferPos, &_outData->partitionsCount);
+        cx_binr_uint32(_buffer, _bufferSize, _bufferPos, &recordsCount);
+        _outData->records = CX_MEM_ARR_ALLOC(_outData->records, cx_math_max(recordsCount, 1));
+        _outData->recordsCount = recordsCount;
+        _outData->recordsRemaining = recordsCount;
+    }
+
+    while (_outData->recordsRemaining > 0 && (*_bufferPos) < _bufferSize)
+    {
+        common_unpack_table_record(_buffer, _bufferSize, _bufferPos, &_outData->records[_outData->recordsCount - _outData->recordsRemaining]);
+        _outData->recordsRemaining--;
+    }
+}
+
 void common_unpack_table_meta(const char* _buffer, uint16_t _bufferSize, uint32_t* _bufferPos, table_meta_t* _outTable)
 {
     cx_binr_str(_buffer, _bufferSize, _bufferPos, _outTable->name, sizeof(_outTable->name));
     cx_binr_uint8(_buffer, _bufferSize, _bufferPos, &_outTable->consistency);
     cx_binr_uint16(_buffer, _bufferSize, _bufferPos, &_outTable->partitionsCount);
     cx_binr_uint32(_buffer, _bufferSize, _bufferPos, &_outTable->compactionInterval);
+    cx_binr_uint32(_buffer, _bufferSize, _bufferPos, &_outTable->ttl);
 }
 
 void common_unpack_table_record(const char* _buffer, uint16_t _bufferSize, uint32_t* _bufferPos, table_record_t* _outRecord)
@@ -61,6 +61,76 @@ void report_insert(const task_t* _task, FILE* _stream)
     REPORT_END;
 }
 
+void report_select_batch(const task_t* _task, FILE* _stream)
+{
+    REPORT_BEGIN;
+    if (ERR_NONE == _task->err.code)
+    {
+        data_select_batch_t* data = _task->data;
+        for (uint16_t i = 0; i < data->recordsCount; i++)
+        {
+            if (NULL != data->records[i].value)
+                fprintf(_stream, "%" PRIu16 ": \"%s\".\n", data->records[i].key, data->records[i].value);
+            else
+                fprintf(_stream, "%" PRIu16 ": key does not exist.\n", data->records[i].key);
+        }
+    }
+    else
+    {
+        fprintf(_stream, "SELECT failed. %s\n", _task->err.desc);
+    }
+    REPORT_END;
+}
+
+void report_insert_batch(const task_t* _task, FILE* _stream)
+{
+    REPORT_BEGIN;
+    if (ERR_NONE == _task->err.code)
+    {
+        data_insert_batch_t* data = _task->data;
+        fprintf(_stream, "%" PRIu16 " records inserted into table '%s'.\n", data->recordsCount, data->tableName);
+    }
+    else
+    {
+        fprintf(_stream, "INSERT failed. %s\n", _task->err.desc);
+    }
+    REPORT_END;
+}
+
+void report_delete(const task_t* _task, FILE* _stream)
+{
+    REPORT_BEGIN;
+    if (ERR_NONE == _task->err.code)
+    {
+        data_delete_t* data = _task->data;
+        fprintf(_stream, "Key %" PRIu16 " deleted from table '%s'.\n", data->key, data->tableName);
+    }
+    else
+    {
+        fprintf(_stream, "DELETE failed. %s\n", _task->err.desc);
+    }
+    REPORT_END;
+}
+
+void report_scan(const task_t* _task, FILE* _stream)
+{
+    REPORT_BEGIN;
+    if (ERR_NONE == _task->err.code)
+    {
+        data_scan_t* data = _task->data;
+        for (uint32_t i = 0; i < data->recordsCount; i++)
+        {
+            fprintf(_stream, "%" PRIu16 ": \"%s\".\n", data->records[i].key, data->records[i].value);
+        }
+        fprintf(_stream, "%" PRIu32 " records found in table '%s'.\n", data->recordsCount, data->tableName);
+    }
+    else
+    {
+        fprintf(_stream, "SCAN failed. %s\n", _task->err.desc);
+    }
+    REPORT_END;
+}
+
 void report_create(const task_t* _task, FILE* _stream)
 {
     REPORT_BEGIN;
@@ -83,19 +153,20 @@ void report_describe(const task_t* _task, FILE* _stream)
     {
         data_describe_t* data = _task->data;
 
-        fprintf(_stream, "+--------------------------------+---------------+------------+---------------+\n");
-        fprintf(_stream, "| Name                           | Consistency   | Partitions | Compaction    |\n");
-        fprintf(_stream, "+--------------------------------+---------------+------------+---------------+\n");
+        fprintf(_stream, "+--------------------------------+---------------+------------+---------------+------------+\n");
+        fprintf(_stream, "| Name                           | Consistency   | Partitions | Compaction    | TTL        |\n");
+        fprintf(_stream, "+--------------------------------+---------------+------------+---------------+------------+\n");
 
         for (uint16_t i = 0; i < data->tablesCount; i++)
         {
-            fprintf(_stream, "| %-30s | %-13s | %-10" PRIu16 " | %-13" PRIu32 " |\n",
+            fprintf(_stream, "| %-30s | %-13s | %-10" PRIu16 " | %-13" PRIu32 " | %-10" PRIu32 " |\n",
                 data->tables[i].name,
                 CONSISTENCY_NAME[data->tables[i].consistency],
                 data->tables[i].partitionsCount,
-                data->tables[i].compactionInterval);
+                data->tables[i].compactionInterval,
+                data->tables[i].ttl);
         }
-        fprintf(_stream, "+--------------------------------+---------------+------------+---------------+\n");
+        fprintf(_stream, "+--------------------------------+---------------+------------+---------------+------------+\n");
     }
     else
     {
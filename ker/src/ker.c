@@ -288,10 +288,15 @@ static void handle_cli_command(const cx_cli_cmd_t* _cmd)
     uint8_t     consistency = 0;
     uint16_t    numPartitions = 0;
     uint32_t    compactionInterval = 0;
+    uint32_t    ttl = 0;
     cx_path_t   lqlScriptPath;
     cx_path_t   logPath;
     uint32_t    packetSize = 0;
     uint16_t    memNumber = 0;
+    table_record_t* records = NULL;
+    uint16_t    recordsCount = 0;
+    uint16_t    partition = 0;
+    uint16_t    keyMax = 0;
 
     if (QUERY_EXIT == query)
     {
@@ -312,9 +317,9 @@ static void handle_cli_command(const cx_cli_cmd_t* _cmd)
     }
     else if (QUERY_CREATE == query)
     {
-        if (cli_parse_create(_cmd, &err, &tableName, &consistency, &numPartitions, &compactionInterval))
+        if (cli_parse_create(_cmd, &err, &tableName, &consistency, &numPartitions, &compactionInterval, &ttl))
         {
-            packetSize = ker_pack_req_create(g_ctx.buff1, sizeof(g_ctx.buff1), 0, tableName, consistency, numPartitions, compactionInterval);
+            packetSize = ker_pack_req_create(g_ctx.buff1, sizeof(g_ctx.buff1), 0, tableName, consistency, numPartitions, compactionInterval, ttl);
             ker_handle_req_create(NULL, NULL, g_ctx.buff1, packetSize);
         }
     }
@@ -334,6 +339,43 @@ static void handle_cli_command(const cx_cli_cmd_t* _cmd)
             ker_handle_req_describe(NULL, NULL, g_ctx.buff1, packetSize);
         }
     }
+    else if (QUERY_SELECT == query && cli_parse_is_batch(_cmd))
+    {
+        if (cli_parse_select_batch(_cmd, &err, &tableName, &records, &recordsCount))
+        {
+            packetSize = ker_pack_req_select_batch(g_ctx.buff1, sizeof(g_ctx.buff1), 0, tableName, records, recordsCount);
+            ker_handle_req_select_batch(NULL, NULL, g_ctx.buff1, packetSize);
+            free(records);
+        }
+    }
+    else if (QUERY_INSERT == query && cli_parse_is_batch(_cmd))
+    {
+        if (cli_parse_insert_batch(_cmd, &err, &tableName, &records, &recordsCount))
+        {
+            uint32_t pos = 0;
+            uint16_t recordsPacked = 0;
+            if (ker_pack_req_insert_batch(g_ctx.buff1, sizeof(g_ctx.buff1), &pos, 0, tableName, records, recordsCount, &recordsPacked))
+            {
+                ker_handle_req_insert_batch(NULL, NULL, g_ctx.buff1, pos);
+            }
+            else
+            {
+                CX_ERR_SET(&err, 1, "The batch is too large to be inserted at once.");
+            }
+
+            for (uint16_t i = 0; i < recordsCount; i++)
+                free(records[i].value);
+            free(records);
+        }
+    }
+    else if (QUERY_SCAN == query)
+    {
+        if (cli_parse_scan(_cmd, &err, &tableName, &partition, &key, &keyMax))
+        {
+            packetSize = ker_pack_req_scan(g_ctx.buff1, sizeof(g_ctx.buff1), 0, tableName, partition, key, keyMax);
+            ker_handle_req_scan(NULL, NULL, g_ctx.buff1, packetSize);
+        }
+    }
     else if (QUERY_SELECT == query)
     {
         if (cli_parse_select(_cmd, &err, &tableName, &key))
@@ -350,6 +392,14 @@ static void handle_cli_command(const cx_cli_cmd_t* _cmd)
             ker_handle_req_insert(NULL, NULL, g_ctx.buff1, packetSize);
         }
     }
+    else if (QUERY_DELETE == query)
+    {
+        if (cli_parse_delete(_cmd, &err, &tableName, &key, &timestamp))
+        {
+            packetSize = ker_pack_req_delete(g_ctx.buff1, sizeof(g_ctx.buff1), 0, tableName, key, timestamp);
+            ker_handle_req_delete(NULL, NULL, g_ctx.buff1, packetSize);
+        }
+    }
     else if (QUERY_JOURNAL == query)
     {
         packetSize = ker_pack_req_journal(g_ctx.buff1, sizeof(g_ctx.buff1), 0);
@@ -492,6 +542,22 @@ static bool task_run_wk(task_t* _task)
         worker_handle_insert(_task, false);
         break;
 
+    case TASK_WT_DELETE:
+        worker_handle_delete(_task, false);
+        break;
+
+    case TASK_WT_SELECT_BATCH:
+        worker_handle_select_batch(_task, false);
+        break;
+
+    case TASK_WT_INSERT_BATCH:
+        worker_handle_insert_batch(_task, false);
+        break;
+
+    case TASK_WT_SCAN:
+        worker_handle_scan(_task, false);
+        break;
+
     case TASK_WT_JOURNAL:
         worker_handle_journal(_task, false);
         break;
@@ -587,6 +653,34 @@ static bool task_completed(task_t* _task)
         break;
     }
 
+    case TASK_WT_DELETE:
+    {
+        if (TASK_ORIGIN_CLI == _task->origin)
+            report_delete(_task, stdout);
+        break;
+    }
+
+    case TASK_WT_SELECT_BATCH:
+    {
+        if (TASK_ORIGIN_CLI == _task->origin)
+            report_select_batch(_task, stdout);
+        break;
+    }
+
+    case TASK_WT_INSERT_BATCH:
+    {
+        if (TASK_ORIGIN_CLI == _task->origin)
+            report_insert_batch(_task, stdout);
+        break;
+    }
+
+    case TASK_WT_SCAN:
+    {
+        if (TASK_ORIGIN_CLI == _task->origin)
+            report_scan(_task, stdout);
+        break;
+    }
+
     case TASK_WT_JOURNAL:
     {
         if (TASK_ORIGIN_CLI == _task->origin)
@@ -14,6 +14,7 @@
 #include <cx/file.h>
 #include <cx/timer.h>
 #include <cx/cli.h>
+#include <cx/math.h>
 
 #include <inttypes.h>
 
@@ -25,6 +26,10 @@ static void         _worker_parse_result(task_t* _req);
 
 static bool         _worker_request_mem(mempool_hints_t* _hints, uint8_t _header, const char* _payload, uint32_t _payloadSize, task_t* _task);
 
+static bool         _worker_batch_targets(mempool_hints_t* _hints, const table_record_t* _records, uint16_t _recordsCount, uint16_t* _outMemNumbers, cx_err_t* _err);
+
+static uint16_t     _worker_batch_group(const table_record_t* _records, uint16_t _recordsCount, const uint16_t* _memNumbers, bool* _inOutDone, uint16_t _first, table_record_t* _outRecords, uint16_t* _outIndices);
+
 static bool         _worker_run_query_scripted(cx_cli_cmd_t* _cmd, task_t* _task);
 
 /****************************************************************************************
@@ -44,7 +49,7 @@ void worker_handle_create(task_t* _req, bool _scripted)
     payload_t payload;
     uint32_t payloadSize = mem_pack_req_create(payload, sizeof(payload),
         _req->handle, data->tableName, data->consistency,
-        data->numPartitions, data->compactionInterval);
+        data->numPartitions, data->compactionInterval, data->ttl);
 
     _worker_request_mem(&hints, MEMP_REQ_CREATE, payload, payloadSize, _req);
 
@@ -52,6 +57,7 @@ void worker_handle_create(task_t* _req, bool _scripted)
     {
         table_meta_t meta;
         meta.compactionInterval = data->compactionInterval;
+        meta.ttl = data->ttl;
         meta.consistency = data->consistency;
         meta.partitionsCount = data->numPartitions;
         cx_str_copy(meta.name, sizeof(meta.name), data->tableName);
@@ -153,6 +159,165 @@ void worker_handle_insert(task_t* _req, bool _scripted)
     if (!_scripted) _worker_parse_result(_req);
 }
 
+void worker_handle_delete(task_t* _req, bool _scripted)
+{
+    data_delete_t* data = _req->data;
+
+    // a delete is a write, it goes to the same memory node an insert on that key would go to.
+    mempool_hints_t hints;
+    CX_MEM_ZERO(hints);
+    hints.query = QUERY_INSERT;
+    hints.tableName = data->tableName;
+    hints.key = data->key;
+
+    payload_t payload;
+    uint32_t payloadSize = mem_pack_req_delete(payload, sizeof(payload),
+        _req->handle, data->tableName, data->key, data->timestamp);
+
+    _worker_request_mem(&hints, MEMP_REQ_DELETE, payload, payloadSize, _req);
+
+    if (!_scripted) _worker_parse_result(_req);
+}
+
+void worker_handle_select_batch(task_t* _req, bool _scripted)
+{
+    data_select_batch_t* data = _req->data;
+
+    mempool_hints_t hints;
+    CX_MEM_ZERO(hints);
+    hints.query = QUERY_SELECT;
+    hints.tableName = data->tableName;
+
+    uint16_t* memNumbers = CX_MEM_ARR_ALLOC(memNumbers, cx_math_max(data->recordsCount, 1));
+    uint16_t* indices = CX_MEM_ARR_ALLOC(indices, cx_math_max(data->recordsCount, 1));
+    bool*     done = CX_MEM_ARR_ALLOC(done, cx_math_max(data->recordsCount, 1));
+
+    data_select_batch_t group;
+    CX_MEM_ZERO(group);
+    cx_str_copy(group.tableName, sizeof(group.tableName), data->tableName);
+    group.records = CX_MEM_ARR_ALLOC(group.records, cx_math_max(data->recordsCount, 1));
+
+    if (_worker_batch_targets(&hints, data->records, data->recordsCount, memNumbers, &_req->err))
+    {
+        for (uint16_t i = 0; i < data->recordsCount; i++)
+        {
+            if (done[i]) continue;
+
+            // a single request for all the keys stored by the same MEM node. its response is 
+            // unpacked into the task data, so we temporarily replace it with our group.
+            group.recordsCount = _worker_batch_group(data->records, data->recordsCount, memNumbers, done, i, group.records, indices);
+            group.recordsNext = 0;
+            group.recordsRemaining = 0;
+            hints.key = data->records[i].key;
+
+            payload_t payload;
+            uint32_t payloadSize = mem_pack_req_select_batch(payload, sizeof(payload),
+                _req->handle, group.tableName, group.records, group.recordsCount);
+
+            _req->data = &group;
+            bool success = _worker_request_mem(&hints, MEMP_REQ_SELECT_BATCH, payload, payloadSize, _req);
+            _req->data = data;
+
+            for (uint16_t j = 0; j < group.recordsCount; j++)
+            {
+                data->records[indices[j]].timestamp = group.records[j].timestamp;
+                data->records[indices[j]].value = group.records[j].value;
+                group.records[j].value = NULL;
+            }
+
+            if (!success) break;
+        }
+    }
+
+    free(group.records);
+    free(memNumbers);
+    free(indices);
+    free(done);
+
+    if (!_scripted) _worker_parse_result(_req);
+}
+
+void worker_handle_insert_batch(task_t* _req, bool _scripted)
+{
+    data_insert_batch_t* data = _req->data;
+
+    mempool_hints_t hints;
+    CX_MEM_ZERO(hints);
+    hints.query = QUERY_INSERT;
+    hints.tableName = data->tableName;
+
+    uint16_t*       memNumbers = CX_MEM_ARR_ALLOC(memNumbers, cx_math_max(data->recordsCount, 1));
+    uint16_t*       indices = CX_MEM_ARR_ALLOC(indices, cx_math_max(data->recordsCount, 1));
+    bool*           done = CX_MEM_ARR_ALLOC(done, cx_math_max(data->recordsCount, 1));
+    table_record_t* records = CX_MEM_ARR_ALLOC(records, cx_math_max(data->recordsCount, 1));
+    uint16_t        recordsCount = 0;
+    uint16_t        recordsPacked = 0;
+    uint16_t        recordsPackedBefore = 0;
+    uint32_t        payloadSize = 0;
+    bool            complete = false;
+    bool            success = true;
+    payload_t       payload;
+
+    if (_worker_batch_targets(&hints, data->records, data->recordsCount, memNumbers, &_req->err))
+    {
+        for (uint16_t i = 0; i < data->recordsCount && success; i++)
+        {
+            if (done[i]) continue;
+
+            // the records stored by the same MEM node are sent together, in as many requests as needed
+            // to fit them. the records of the group share their values with the ones in our task data.
+            recordsCount = _worker_batch_group(data->records, data->recordsCount, memNumbers, done, i, records, indices);
+            recordsPacked = 0;
+            complete = false;
+            hints.key = data->records[i].key;
+
+            while (!complete && success)
+            {
+                recordsPackedBefore = recordsPacked;
+                complete = mem_pack_req_insert_batch(payload, sizeof(payload), &payloadSize,
+                    _req->handle, data->tableName, records, recordsCount, &recordsPacked);
+
+                if (recordsPacked == recordsPackedBefore)
+                {
+                    CX_ERR_SET(&_req->err, ERR_GENERIC, "Record with key %d is too large to be inserted.", records[recordsPacked].key);
+                    success = false;
+                    break;
+                }
+
+                success = _worker_request_mem(&hints, MEMP_REQ_INSERT_BATCH, payload, payloadSize, _req);
+            }
+        }
+    }
+
+    free(records);
+    free(memNumbers);
+    free(indices);
+    free(done);
+
+    if (!_scripted) _worker_parse_result(_req);
+}
+
+void worker_handle_scan(task_t* _req, bool _scripted)
+{
+    data_scan_t* data = _req->data;
+
+    // the whole table (or partition) is requested to a single MEM node of its criterion, 
+    // which asks the LFS for it and merges the changes it hasn't journaled yet.
+    mempool_hints_t hints;
+    CX_MEM_ZERO(hints);
+    hints.query = QUERY_SELECT;
+    hints.tableName = data->tableName;
+    hints.key = data->keyMin;
+
+    payload_t payload;
+    uint32_t payloadSize = mem_pack_req_scan(payload, sizeof(payload),
+        _req->handle, data->tableName, data->partition, data->keyMin, data->keyMax);
+
+    _worker_request_mem(&hints, MEMP_REQ_SCAN, payload, payloadSize, _req);
+
+    if (!_scripted) _worker_parse_result(_req);
+}
+
 void worker_handle_journal(task_t* _req, bool _scripted)
 {
     mempool_journal(&_req->err);
@@ -303,6 +468,40 @@ static bool _worker_request_mem(mempool_hints_t* _hints, uint8_t _header, const
     return (ERR_NONE == _task->err.code);
 }
 
+static bool _worker_batch_targets(mempool_hints_t* _hints, const table_record_t* _records, uint16_t _recordsCount, uint16_t* _outMemNumbers, cx_err_t* _err)
+{
+    // figures out the MEM node each record of a batch would be sent to by a single query. 
+    // records of SHC tables end up spread across the nodes of the criteria.
+    for (uint16_t i = 0; i < _recordsCount; i++)
+    {
+        _hints->key = _records[i].key;
+        _outMemNumbers[i] = mempool_get(_hints, _err);
+
+        if (INVALID_MEM_NUMBER == _outMemNumbers[i])
+            return false;
+    }
+    return true;
+}
+
+static uint16_t _worker_batch_group(const table_record_t* _records, uint16_t _recordsCount, const uint16_t* _memNumbers, bool* _inOutDone, uint16_t _first, table_record_t* _outRecords, uint16_t* _outIndices)
+{
+    // copies to _outRecords every pending record (starting at _first) targeting the same MEM node 
+    // as _records[_first]. their original positions are stored in _outIndices.
+    uint16_t count = 0;
+
+    for (uint16_t i = _first; i < _recordsCount; i++)
+    {
+        if (!_inOutDone[i] && _memNumbers[i] == _memNumbers[_first])
+        {
+            _inOutDone[i] = true;
+            _outIndices[count] = i;
+            memcpy(&_outRecords[count], &_records[i], sizeof(_outRecords[count]));
+            count++;
+        }
+    }
+    return count;
+}
+
 static bool _worker_run_query_scripted(cx_cli_cmd_t* _cmd, task_t* _task)
 {
     FILE*       output = ((data_run_t*)_task->data)->output;
@@ -317,11 +516,16 @@ static bool _worker_run_query_scripted(cx_cli_cmd_t* _cmd, task_t* _task)
     uint8_t     consistency = 0;
     uint16_t    numPartitions = 0;
     uint32_t    compactionInterval = 0;
+    uint32_t    ttl = 0;
     uint16_t    memNumber = 0;
+    table_record_t* records = NULL;
+    uint16_t    recordsCount = 0;
+    uint16_t    partition = 0;
+    uint16_t    keyMax = 0;
 
     if (QUERY_CREATE == query)
     {
-        if (cli_parse_create(_cmd, &_task->err, &tableName, &consistency, &numPartitions, &compactionInterval))
+        if (cli_parse_create(_cmd, &_task->err, &tableName, &consistency, &numPartitions, &compactionInterval, &ttl))
         {
             validCommand = true;
 
@@ -330,6 +534,7 @@ static bool _worker_run_query_scripted(cx_cli_cmd_t* _cmd, task_t* _task)
             data->consistency = consistency;
             data->numPartitions = numPartitions;
             data->compactionInterval = compactionInterval;
+            data->ttl = ttl;
 
             _task->type = TASK_WT_CREATE;
             _task->data = data;
@@ -376,6 +581,61 @@ static bool _worker_run_query_scripted(cx_cli_cmd_t* _cmd, task_t* _task)
             report_describe(_task, output);
         }
     }
+    else if (QUERY_SELECT == query && cli_parse_is_batch(_cmd))
+    {
+        if (cli_parse_select_batch(_cmd, &_task->err, &tableName, &records, &recordsCount))
+        {
+            validCommand = true;
+
+            data_select_batch_t* data = CX_MEM_STRUCT_ALLOC(data);
+            cx_str_copy(data->tableName, sizeof(data->tableName), tableName);
+            data->records = records;
+            data->recordsCount = recordsCount;
+
+            _task->type = TASK_WT_SELECT_BATCH;
+            _task->data = data;
+
+            worker_handle_select_batch(_task, true);
+            report_select_batch(_task, output);
+        }
+    }
+    else if (QUERY_INSERT == query && cli_parse_is_batch(_cmd))
+    {
+        if (cli_parse_insert_batch(_cmd, &_task->err, &tableName, &records, &recordsCount))
+        {
+            validCommand = true;
+
+            data_insert_batch_t* data = CX_MEM_STRUCT_ALLOC(data);
+            cx_str_copy(data->tableName, sizeof(data->tableName), tableName);
+            data->records = records;
+            data->recordsCount = recordsCount;
+
+            _task->type = TASK_WT_INSERT_BATCH;
+            _task->data = data;
+
+            worker_handle_insert_batch(_task, true);
+            report_insert_batch(_task, output);
+        }
+    }
+    else if (QUERY_SCAN == query)
+    {
+        if (cli_parse_scan(_cmd, &_task->err, &tableName, &partition, &key, &keyMax))
+        {
+            validCommand = true;
+
+            data_scan_t* data = CX_MEM_STRUCT_ALLOC(data);
+            cx_str_copy(data->tableName, sizeof(data->tableName), tableName);
+            data->partition = partition;
+            data->keyMin = key;
+            data->keyMax = keyMax;
+
+            _task->type = TASK_WT_SCAN;
+            _task->data = data;
+
+            worker_handle_scan(_task, true);
+            report_scan(_task, output);
+        }
+    }
     else if (QUERY_SELECT == query)
     {
         if (cli_parse_select(_cmd, &_task->err, &tableName, &key))
@@ -412,6 +672,24 @@ static bool _worker_run_query_scripted(cx_cli_cmd_t* _cmd, task_t* _task)
             report_insert(_task, output);
         }
     }
+    else if (QUERY_DELETE == query)
+    {
+        if (cli_parse_delete(_cmd, &_task->err, &tableName, &key, &timestamp))
+        {
+            validCommand = true;
+
+            data_delete_t* data = CX_MEM_STRUCT_ALLOC(data);
+            cx_str_copy(data->tableName, sizeof(data->tableName), tableName);
+            data->key = key;
+            data->timestamp = timestamp;
+
+            _task->type = TASK_WT_DELETE;
+            _task->data = data;
+
+            worker_handle_delete(_task, true);
+            report_delete(_task, output);
+        }
+    }
     else if (QUERY_JOURNAL == query)
     {
         validCommand = true;
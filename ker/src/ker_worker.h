@@ -17,6 +17,14 @@ void        worker_handle_select(task_t* _req, bool _scripted);
 
 void        worker_handle_insert(task_t* _req, bool _scripted);
 
+void        worker_handle_delete(task_t* _req, bool _scripted);
+
+void        worker_handle_select_batch(task_t* _req, bool _scripted);
+
+void        worker_handle_insert_batch(task_t* _req, bool _scripted);
+
+void        worker_handle_scan(task_t* _req, bool _scripted);
+
 void        worker_handle_journal(task_t* _req, bool _scripted);
 
 void        worker_handle_addmem(task_t* _req, bool _scripted);
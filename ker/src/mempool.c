@@ -288,6 +288,10 @@ void mempool_add(uint16_t _memNumber, ipv4_t _ip, uint16_t _port)
         args.msgHandlers[KERP_RES_DESCRIBE] = (cx_net_handler_cb)ker_handle_res_describe;
         args.msgHandlers[KERP_RES_SELECT] = (cx_net_handler_cb)ker_handle_res_select;
         args.msgHandlers[KERP_RES_INSERT] = (cx_net_handler_cb)ker_handle_res_insert;
+        args.msgHandlers[KERP_RES_DELETE] = (cx_net_handler_cb)ker_handle_res_delete;
+        args.msgHandlers[KERP_RES_SELECT_BATCH] = (cx_net_handler_cb)ker_handle_res_select_batch;
+        args.msgHandlers[KERP_RES_INSERT_BATCH] = (cx_net_handler_cb)ker_handle_res_insert_batch;
+        args.msgHandlers[KERP_RES_SCAN] = (cx_net_handler_cb)ker_handle_res_scan;
 
         // start client context
         memNode->conn = cx_net_connect(&args);
@@ -17,6 +17,10 @@ typedef enum
     LFSP_REQ_DESCRIBE,
     LFSP_REQ_SELECT,
     LFSP_REQ_INSERT,
+    LFSP_REQ_SELECT_BATCH,
+    LFSP_REQ_INSERT_BATCH,
+    LFSP_REQ_SCAN,
+    LFSP_REQ_DELETE,
 } LFS_PACKET_HEADERS;
 
 /****************************************************************************************
@@ -39,6 +43,14 @@ void lfs_handle_req_select(cx_net_common_t* _common, void* _userData, const char
 
 void lfs_handle_req_insert(cx_net_common_t* _common, void* _userData, const char* _buffer, uint16_t _bufferSize);
 
+void lfs_handle_req_select_batch(cx_net_common_t* _common, void* _userData, const char* _buffer, uint16_t _bufferSize);
+
+void lfs_handle_req_insert_batch(cx_net_common_t* _common, void* _userData, const char* _buffer, uint16_t _bufferSize);
+
+void lfs_handle_req_delete(cx_net_common_t* _common, void* _userData, const char* _buffer, uint16_t _bufferSize);
+
+void lfs_handle_req_scan(cx_net_common_t* _common, void* _userData, const char* _buffer, uint16_t _bufferSize);
+
 #endif // LFS
 
 /****************************************************************************************
@@ -47,7 +59,7 @@ void lfs_handle_req_insert(cx_net_common_t* _common, void* _userData, const char
 
 uint32_t lfs_pack_auth(char* _buffer, uint16_t _size, password_t _passwd);
 
-uint32_t lfs_pack_req_create(char* _buffer, uint16_t _size, uint16_t _remoteId, const char* _tableName, uint8_t _consistency, uint16_t _numPartitions, uint32_t _compactionInterval);
+uint32_t lfs_pack_req_create(char* _buffer, uint16_t _size, uint16_t _remoteId, const char* _tableName, uint8_t _consistency, uint16_t _numPartitions, uint32_t _compactionInterval, uint32_t _ttl);
 
 uint32_t lfs_pack_req_drop(char* _buffer, uint16_t _size, uint16_t _remoteId, const char* _tableName);
 
@@ -57,4 +69,12 @@ uint32_t lfs_pack_req_select(char* _buffer, uint16_t _size, uint16_t _remoteId,
 
 uint32_t lfs_pack_req_insert(char* _buffer, uint16_t _size, uint16_t _remoteId, const char* _tableName, uint16_t _key, const char* _value, uint64_t _timestamp);
 
+uint32_t lfs_pack_req_select_batch(char* _buffer, uint16_t _size, uint16_t _remoteId, const char* _tableName, const table_record_t* _records, uint16_t _recordsCount);
+
+bool lfs_pack_req_insert_batch(char* _buffer, uint16_t _size, uint32_t* _pos, uint16_t _remoteId, const char* _tableName, const table_record_t* _records, uint16_t _recordsCount, uint16_t* _recordsPacked);
+
+uint32_t lfs_pack_req_delete(char* _buffer, uint16_t _size, uint16_t _remoteId, const char* _tableName, uint16_t _key, uint64_t _timestamp);
+
+uint32_t lfs_pack_req_scan(char* _buffer, uint16_t _size, uint16_t _remoteId, const char* _tableName, uint16_t _partition, uint16_t _keyMin, uint16_t _keyMax);
+
 #endif // LFS_PROTOCOL_H_
\ No newline at end of file
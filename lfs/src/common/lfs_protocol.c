@@ -88,6 +88,42 @@ void lfs_handle_req_insert(cx_net_common_t* _common, void* _userData, const char
     REQ_END;
 }
 
+void lfs_handle_req_select_batch(cx_net_common_t* _common, void* _userData, const char* _buffer, uint16_t _bufferSize)
+{
+    REQ_BEGIN(TASK_WT_SELECT_BATCH);
+    {
+        task->data = common_unpack_req_select_batch(_buffer, _bufferSize, &bufferPos, NULL);
+    }
+    REQ_END;
+}
+
+void lfs_handle_req_insert_batch(cx_net_common_t* _common, void* _userData, const char* _buffer, uint16_t _bufferSize)
+{
+    REQ_BEGIN(TASK_WT_INSERT_BATCH);
+    {
+        task->data = common_unpack_req_insert_batch(_buffer, _bufferSize, &bufferPos, NULL);
+    }
+    REQ_END;
+}
+
+void lfs_handle_req_delete(cx_net_common_t* _common, void* _userData, const char* _buffer, uint16_t _bufferSize)
+{
+    REQ_BEGIN(TASK_WT_DELETE);
+    {
+        task->data = common_unpack_req_delete(_buffer, _bufferSize, &bufferPos, NULL);
+    }
+    REQ_END;
+}
+
+void lfs_handle_req_scan(cx_net_common_t* _common, void* _userData, const char* _buffer, uint16_t _bufferSize)
+{
+    REQ_BEGIN(TASK_WT_SCAN);
+    {
+        task->data = common_unpack_req_scan(_buffer, _bufferSize, &bufferPos, NULL);
+    }
+    REQ_END;
+}
+
 #endif // LFS
 
 /****************************************************************************************
@@ -101,9 +137,9 @@ uint32_t lfs_pack_auth(char* _buffer, uint16_t _size, password_t _passwd)
     return pos;
 }
 
-uint32_t lfs_pack_req_create(char* _buffer, uint16_t _size, uint16_t _remoteId, const char* _tableName, uint8_t _consistency, uint16_t _numPartitions, uint32_t _compactionInterval)
+uint32_t lfs_pack_req_create(char* _buffer, uint16_t _size, uint16_t _remoteId, const char* _tableName, uint8_t _consistency, uint16_t _numPartitions, uint32_t _compactionInterval, uint32_t _ttl)
 {
-    return common_pack_req_create(_buffer, _size, _remoteId, _tableName, _consistency, _numPartitions, _compactionInterval);
+    return common_pack_req_create(_buffer, _size, _remoteId, _tableName, _consistency, _numPartitions, _compactionInterval, _ttl);
 }
 
 uint32_t lfs_pack_req_drop(char* _buffer, uint16_t _size, uint16_t _remoteId, const char* _tableName)
@@ -125,3 +161,23 @@ uint32_t lfs_pack_req_insert(char* _buffer, uint16_t _size, uint16_t _remoteId,
 {
     return common_pack_req_insert(_buffer, _size, _remoteId, _tableName, _key, _value, _timestamp);
 }
+
+uint32_t lfs_pack_req_select_batch(char* _buffer, uint16_t _size, uint16_t _remoteId, const char* _tableName, const table_record_t* _records, uint16_t _recordsCount)
+{
+    return common_pack_req_select_batch(_buffer, _size, _remoteId, _tableName, _records, _recordsCount);
+}
+
+bool lfs_pack_req_insert_batch(char* _buffer, uint16_t _size, uint32_t* _pos, uint16_t _remoteId, const char* _tableName, const table_record_t* _records, uint16_t _recordsCount, uint16_t* _recordsPacked)
+{
+    return common_pack_req_insert_batch(_buffer, _size, _pos, _remoteId, _tableName, _records, _recordsCount, _recordsPacked);
+}
+
+uint32_t lfs_pack_req_delete(char* _buffer, uint16_t _size, uint16_t _remoteId, const char* _tableName, uint16_t _key, uint64_t _timestamp)
+{
+    return common_pack_req_delete(_buffer, _size, _remoteId, _tableName, _key, _timestamp);
+}
+
+uint32_t lfs_pack_req_scan(char* _buffer, uint16_t _size, uint16_t _remoteId, const char* _tableName, uint16_t _partition, uint16_t _keyMin, uint16_t _keyMax)
+{
+    return common_pack_req_scan(_buffer, _size, _remoteId, _tableName, _partition, _keyMin, _keyMax);
+}
@@ -1,22 +1,38 @@
 #include "fs.h"
 
 #include "memtable.h"
+#include "fs_cache.h"
+#include "wal.h"
+#include "row_cache.h"
 
 #include <cx/mem.h>
 #include <cx/file.h>
 #include <cx/str.h>
 #include <cx/math.h>
+#include <cx/lz.h>
 #include <cx/timer.h>
+#include <cx/sort.h>
 #include <ker/taskman.h>
 
 #include <commons/config.h>
 
 #include <string.h>
+#include <strings.h>
 #include <math.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <endian.h>
 
 static fs_ctx_t*       m_fsCtx = NULL;        // private filesystem context
 
-#define BIT_IS_SET(_var, _i) ((_var) & (1 << (_i)))
+#define BIT_IS_SET(_var, _i) ((_var) & ((uint32_t)1 << (_i)))
+
+#define BIT_FIRST_UNSET(_var) ((uint32_t)__builtin_ctz(~(_var)))
+
+#define BIT_COUNT_SET(_var) ((uint32_t)__builtin_popcount(_var))
 
 #define SEGMENT_BITS (sizeof(uint32_t) * CHAR_BIT)
 
@@ -30,15 +46,73 @@ static uint32_t     _fs_calc_bitmap_size(uint32_t _maxBlocks);
 
 static bool         _fs_bootstrap(cx_path_t* _rootDir, uint32_t _maxBlocks, uint32_t _blockSize, cx_err_t* _err);
 
+static bool         _fs_bootstrap_blocks_data(cx_path_t* _rootDir, uint32_t _maxBlocks, uint32_t _blockSize, cx_err_t* _err);
+
 static bool         _fs_load_meta(cx_err_t* _err);
 
 static bool         _fs_load_tables(cx_err_t* _err);
 
 static bool         _fs_load_blocks(cx_err_t* _err);
 
-static bool         _fs_file_save(fs_file_t* _outFile, cx_err_t* _err);
+static bool         _fs_load_blocks_data(cx_err_t* _err);
+
+static bool         _fs_load_blocks_summary(cx_err_t* _err);
+
+static uint32_t     _fs_block_segment_get(uint32_t _segmentIndex);
+
+static uint32_t     _fs_block_segment_find_free();
+
+static void         _fs_block_mark(uint32_t _blockNumber, bool _used);
+
+static bool         _fs_load_all_filters(cx_err_t* _err);
+
+static void         _fs_load_filters(table_t* _table);
+
+static cx_bloom_t*  _fs_load_filter(const cx_path_t* _filePath);
+
+static bool         _fs_table_filter_check(table_t* _table, const cx_path_t* _filePath, uint16_t _key);
+
+static bool         _fs_file_get(const char* _tableName, const cx_path_t* _filePath, fs_file_t* _outFile, cx_err_t* _err);
+
+static bool         _fs_file_set(const char* _tableName, const cx_path_t* _filePath, fs_file_t* _file, cx_bloom_t* _filter, cx_err_t* _err);
+
+static void         _fs_file_uncache(table_t* _table, const cx_path_t* _filePath);
+
+static void         _fs_catalog_add(table_t* _table, const cx_path_t* _filePath, uint32_t _size);
+
+static void         _fs_catalog_remove(table_t* _table, const cx_path_t* _filePath);
 
-static bool         _fs_file_load(fs_file_t* _file, cx_err_t* _err);
+static void         _fs_catalog_move(table_t* _table, const cx_path_t* _filePathOld, const cx_path_t* _filePathNew);
+
+static void         _fs_catalog_load(table_t* _table);
+
+static int32_t      _fs_catalog_comp_dumps(const void* _a, const void* _b, void* _userData);
+
+static bool         _fs_parse_file_name(const cx_path_t* _filePath, const char* _prefix, const char* _extension, const char* _extensionCompaction, uint16_t* _outNumber, bool* _outDuringCompaction);
+
+static bool         _fs_file_save(fs_file_t* _outFile, const cx_bloom_t* _filter, cx_err_t* _err);
+
+static bool         _fs_file_sync_blocks(const fs_file_t* _file, cx_err_t* _err);
+
+static bool         _fs_path_sync(const cx_path_t* _path, bool _isFolder, cx_err_t* _err);
+
+static bool         _fs_file_load(fs_file_t* _file, cx_bloom_t** _outFilter, cx_err_t* _err);
+
+static bool         _fs_file_load_text(fs_file_t* _outFile, cx_err_t* _err);
+
+static uint32_t     _fs_file_frame_find(const fs_file_t* _file, uint32_t _offset);
+
+static uint32_t     _fs_file_frame_end(const fs_file_t* _file, uint32_t _frameIndex);
+
+static bool         _fs_file_frame_read(const fs_file_t* _file, uint32_t _frameIndex, char* _block, char* _buffer, cx_err_t* _err);
+
+static bool         _fs_file_read_range_frames(fs_file_t* _file, uint32_t _offset, uint32_t _size, char* _buffer, cx_err_t* _err);
+
+static bool         _fs_file_load_array(t_config* _file, const char* _key, uint32_t* _outArr, uint32_t _arrCapacity, uint32_t* _outCount);
+
+static void         _fs_file_encode_arr(char* _buff, uint32_t* _inOutPos, const uint32_t* _arr, uint32_t _count);
+
+static void         _fs_file_decode_arr(const char* _buff, uint32_t* _inOutPos, uint32_t* _outArr, uint32_t _count);
 
 static void         _fs_get_dump_path(cx_path_t* _outFilePath, const char* _tableName, uint16_t _dumpNumber, bool _isDuringCompaction);
 
@@ -46,15 +120,22 @@ static void         _fs_get_part_path(cx_path_t* _outFilePath, const char* _tabl
 
 static void         _fs_get_block_path(cx_path_t* _outFilePath, uint32_t _blockNumber);
 
+static off_t        _fs_get_block_offset(uint32_t _blockNumber);
+
+static int32_t      _fs_block_data_read(uint32_t _blockNumber, char* _buffer, cx_err_t* _err);
+
+static bool         _fs_block_data_write(uint32_t _blockNumber, const char* _buffer, uint32_t _bufferSize, cx_err_t* _err);
+
 /****************************************************************************************
  ***  PUBLIC FUNCTIONS
  ***************************************************************************************/
 
-bool fs_init(const char* _rootDir, uint32_t _blocksCount, uint32_t _blocksSize, cx_err_t* _err)
+bool fs_init(const char* _rootDir, uint32_t _blocksCount, uint32_t _blocksSize, uint32_t _blockCacheSize, cx_err_t* _err)
 {
     CX_CHECK(NULL == m_fsCtx, "fs is already initialized!");
 
     m_fsCtx = CX_MEM_STRUCT_ALLOC(m_fsCtx);
+    m_fsCtx->blocksDataFd = -1;
     CX_ERR_CLEAR(_err);
 
     bool rootDirOk = false;
@@ -99,8 +180,13 @@ bool fs_init(const char* _rootDir, uint32_t _blocksCount, uint32_t _blocksSize,
         return true
             && m_fsCtx->mtxBlocksInit
             && _fs_load_meta(_err)
+            && fs_cache_init(_blockCacheSize, m_fsCtx->meta.blocksSize, _err)
             && _fs_load_tables(_err)
-            && _fs_load_blocks(_err);
+            && wal_init(m_fsCtx->rootDir, _err)
+            && _fs_load_blocks(_err)
+            && _fs_load_blocks_summary(_err)
+            && _fs_load_blocks_data(_err)
+            && _fs_load_all_filters(_err);
     }
 
     return false;
@@ -110,18 +196,35 @@ void fs_destroy()
 {
     if (NULL == m_fsCtx) return;
 
-    // destroy blocksMap
-    free(m_fsCtx->blocksMap);
-    m_fsCtx->blocksMap = NULL;
-    
-    // close bitmap file
-    fflush(m_fsCtx->blocksFile);
-    fclose(m_fsCtx->blocksFile);
-    m_fsCtx->blocksFile = NULL;
+    // persist and unmap blocksMap
+    if (NULL != m_fsCtx->blocksMap)
+    {
+        fs_block_sync();
+        munmap(m_fsCtx->blocksMap, m_fsCtx->blocksMapSize);
+        m_fsCtx->blocksMap = NULL;
+    }
+    free(m_fsCtx->blocksSummary);
+    m_fsCtx->blocksSummary = NULL;
+
+    // close blocks data file
+    if (-1 != m_fsCtx->blocksDataFd)
+    {
+        fsync(m_fsCtx->blocksDataFd);
+        close(m_fsCtx->blocksDataFd);
+        m_fsCtx->blocksDataFd = -1;
+    }
+    free(m_fsCtx->blocksLength);
+    m_fsCtx->blocksLength = NULL;
+
+    // close the write-ahead log
+    wal_destroy();
 
     // destroy tablesMap
     cx_cdict_destroy(m_fsCtx->tablesMap, (cx_destroyer_cb)fs_table_destroy);
 
+    // destroy the block cache
+    fs_cache_destroy();
+
     // mutexes
     if (m_fsCtx->mtxBlocksInit)
     {
@@ -241,7 +344,7 @@ uint16_t fs_table_handle(const char* _tableName)
     return INVALID_HANDLE;
 }
 
-bool fs_table_create(table_t** _outTable, const char* _tableName, uint8_t _consistency, uint16_t _partitions, uint32_t _compactionInterval, cx_err_t* _err)
+bool fs_table_create(table_t** _outTable, const char* _tableName, uint8_t _consistency, uint16_t _partitions, uint32_t _compactionInterval, uint32_t _ttl, cx_err_t* _err)
 {
     CX_CHECK(strlen(_tableName) > 0, "Invalid _tableName!");
     CX_ERR_CLEAR(_err);
@@ -272,21 +375,26 @@ bool fs_table_create(table_t** _outTable, const char* _tableName, uint8_t _consi
                         config_set_value(meta, "partitionsCount", temp);
                         cx_str_from_uint32(_compactionInterval, temp, sizeof(temp));
                         config_set_value(meta, "compactionInterval", temp);
+                        cx_str_from_uint32(_ttl, temp, sizeof(temp));
+                        config_set_value(meta, "ttl", temp);
                         config_save(meta);
 
                         if (fs_table_meta_get(_tableName, &(*_outTable)->meta, _err)
-                            && memtable_init(_tableName, true, &(*_outTable)->memtable, _err))
+                            && memtable_init(_tableName, (*_outTable)->meta.partitionsCount, true, &(*_outTable)->memtable, _err))
                         {
                             fs_file_t partFile;
                             for (uint16_t i = 0; i < (*_outTable)->meta.partitionsCount; i++)
                             {
                                 CX_MEM_ZERO(partFile);
                                 partFile.size = 0;
+                                partFile.oldestTimestamp = UINT64_MAX;
                                 partFile.blocksCount = fs_block_alloc(1, partFile.blocks);
 
                                 if (1 == partFile.blocksCount)
                                 {
-                                    if (!fs_table_part_set(_tableName, i, false, &partFile, _err))
+                                    // the block must be empty on disk as well, it might have been used before.
+                                    if (!fs_block_write(partFile.blocks[0], NULL, 0, _err)
+                                        || !fs_table_part_set(_tableName, i, false, &partFile, cx_bloom_init(0, LFS_FILTER_BITS_PER_KEY), _err))
                                     {
                                         CX_ERR_SET(_err, 1, "Partition #%d for table '%s' could not be written!", i, _tableName);
                                         break;
@@ -416,6 +524,13 @@ bool fs_table_meta_get(const char* _tableName, table_meta_t* _outMeta, cx_err_t*
             goto key_missing;
         }
 
+        // optional, tables created before TTLs existed keep their records forever.
+        key = "ttl";
+        if (config_has_property(meta, key))
+        {
+            _outMeta->ttl = (uint32_t)config_get_int_value(meta, key);
+        }
+
         config_destroy(meta);
         return true;
 
@@ -434,24 +549,30 @@ bool fs_table_part_get(const char* _tableName, uint16_t _partNumber, bool _isDur
     cx_path_t path;
     _fs_get_part_path(&path, _tableName, _partNumber, _isDuringCompaction);
 
-    cx_str_copy(_outFile->path, sizeof(_outFile->path), path);
-    return _fs_file_load(_outFile, _err);
+    return _fs_file_get(_tableName, &path, _outFile, _err);
 }
 
-bool fs_table_part_set(const char* _tableName, uint16_t _partNumber, bool _isDuringCompaction, fs_file_t* _file, cx_err_t* _err)
+bool fs_table_part_set(const char* _tableName, uint16_t _partNumber, bool _isDuringCompaction, fs_file_t* _file, cx_bloom_t* _filter, cx_err_t* _err)
 {
     cx_path_t path;
     _fs_get_part_path(&path, _tableName, _partNumber, _isDuringCompaction);
 
-    cx_str_copy(_file->path, sizeof(_file->path), path);
-    return _fs_file_save(_file, _err);
+    return _fs_file_set(_tableName, &path, _file, _filter, _err);
 }
 
 bool fs_table_part_delete(const char* _tableName, uint16_t _partNumber, bool _isDuringCompaction, cx_err_t* _err)
 {
     fs_file_t part;
+    table_t*  table = NULL;
     if (fs_table_part_get(_tableName, _partNumber, _isDuringCompaction, &part, _err))
     {
+        if (fs_table_exists(_tableName, &table))
+        {
+            fs_table_filter_set(table, &part.path, NULL);
+            _fs_file_uncache(table, &part.path);
+            _fs_catalog_remove(table, &part.path);
+        }
+
         return fs_file_delete(&part, _err);
     }
     return false;
@@ -462,24 +583,30 @@ bool fs_table_dump_get(const char* _tableName, uint16_t _dumpNumber, bool _isDur
     cx_path_t path;
     _fs_get_dump_path(&path, _tableName, _dumpNumber, _isDuringCompaction);
 
-    cx_str_copy(_outFile->path, sizeof(_outFile->path), path);
-    return _fs_file_load(_outFile, _err);
+    return _fs_file_get(_tableName, &path, _outFile, _err);
 }
 
-bool fs_table_dump_set(const char* _tableName, uint16_t _dumpNumber, bool _isDuringCompaction, fs_file_t* _file, cx_err_t* _err)
+bool fs_table_dump_set(const char* _tableName, uint16_t _dumpNumber, bool _isDuringCompaction, fs_file_t* _file, cx_bloom_t* _filter, cx_err_t* _err)
 {
     cx_path_t path;
     _fs_get_dump_path(&path, _tableName, _dumpNumber, _isDuringCompaction);
 
-    cx_str_copy(_file->path, sizeof(_file->path), path);
-    return _fs_file_save(_file, _err);
+    return _fs_file_set(_tableName, &path, _file, _filter, _err);
 }
 
 bool fs_table_dump_delete(const char* _tableName, uint16_t _dumpNumber, bool _isDuringCompaction, cx_err_t* _err)
 {
     fs_file_t part;
+    table_t*  table = NULL;
     if (fs_table_dump_get(_tableName, _dumpNumber, _isDuringCompaction, &part, _err))
     {
+        if (fs_table_exists(_tableName, &table))
+        {
+            fs_table_filter_set(table, &part.path, NULL);
+            _fs_file_uncache(table, &part.path);
+            _fs_catalog_remove(table, &part.path);
+        }
+
         return fs_file_delete(&part, _err);
     }
     return false;
@@ -487,22 +614,20 @@ bool fs_table_dump_delete(const char* _tableName, uint16_t _dumpNumber, bool _is
 
 uint16_t fs_table_dump_number_next(const char* _tableName)
 {
-    cx_err_t err;
-    uint16_t   dumpNumber = 0;
-    uint16_t   dumpNumberLast = 0;
-    bool       dumpCompacted = false;
-    cx_path_t  filePath;
-    cx_path_t  fileName;
+    uint16_t      dumpNumberLast = 0;
+    char*         fileName = NULL;
+    table_file_t* file = NULL;
+    table_t*      table = NULL;
 
-    cx_file_explorer_t* explorer = fs_table_explorer(_tableName, &err);
-    if (NULL != explorer)
+    if (fs_table_exists(_tableName, &table))
     {
-        while (cx_file_explorer_next_file(explorer, &filePath))
+        cx_cdict_iter_begin(table->catalog);
+        while (cx_cdict_iter_next(table->catalog, &fileName, (void**)&file))
         {
-            if (fs_is_dump(&filePath, &dumpNumber, &dumpCompacted) && !dumpCompacted && dumpNumber > dumpNumberLast)
-                dumpNumberLast = dumpNumber;
+            if (TABLE_FILE_TYPE_DUMP == file->type && !file->duringCompaction && file->number > dumpNumberLast)
+                dumpNumberLast = file->number;
         }
-        cx_file_explorer_destroy(explorer);
+        cx_cdict_iter_end(table->catalog);
 
         return dumpNumberLast + 1;
     }
@@ -510,11 +635,66 @@ uint16_t fs_table_dump_number_next(const char* _tableName)
     return 0;
 }
 
-bool fs_table_dump_tryenqueue()
+table_file_t* fs_table_dump_list(table_t* _table, uint32_t* _outDumpsCount)
+{
+    // returns a snapshot of the dumps currently cataloged for the given table (both the 
+    // regular ones and the ones being compacted) from the oldest to the most recent one.
+    // readers rely on this order to break timestamp ties (the most recent dump wins).
+    // the caller is responsible for freeing it.
+    table_file_t* dumps = NULL;
+    char*         fileName = NULL;
+    table_file_t* file = NULL;
+    uint32_t      count = 0;
+
+    cx_cdict_iter_begin(_table->catalog);
+    dumps = CX_MEM_ARR_ALLOC(dumps, cx_math_max(cx_cdict_size(_table->catalog), 1));
+
+    while (cx_cdict_iter_next(_table->catalog, &fileName, (void**)&file))
+    {
+        if (TABLE_FILE_TYPE_DUMP == file->type)
+            memcpy(&dumps[count++], file, sizeof(*file));
+    }
+    cx_cdict_iter_end(_table->catalog);
+
+    cx_sort_quick(dumps, sizeof(dumps[0]), count, _fs_catalog_comp_dumps, NULL);
+
+    (*_outDumpsCount) = count;
+    return dumps;
+}
+
+void fs_table_dump_stats(table_t* _table, uint32_t* _outDumpsCount, uint64_t* _outDumpsSize)
+{
+    // number of dumps awaiting to be compacted and their total size in bytes. 
+    // every single one of them must be read on a SELECT missing the memtable, so the 
+    // count is a good measure of the read amplification of the given table.
+    char*         fileName = NULL;
+    table_file_t* file = NULL;
+    uint32_t      count = 0;
+    uint64_t      size = 0;
+
+    cx_cdict_iter_begin(_table->catalog);
+    while (cx_cdict_iter_next(_table->catalog, &fileName, (void**)&file))
+    {
+        if (TABLE_FILE_TYPE_DUMP == file->type && !file->duringCompaction)
+        {
+            count++;
+            size += file->size;
+        }
+    }
+    cx_cdict_iter_end(_table->catalog);
+
+    if (NULL != _outDumpsCount) (*_outDumpsCount) = count;
+    if (NULL != _outDumpsSize) (*_outDumpsSize) = size;
+}
+
+bool fs_table_dump_tryenqueue(uint16_t* _outDumpsCount)
 {
+    bool success = true;
     char* tableName = NULL;
     table_t* table = NULL;
 
+    (*_outDumpsCount) = 0;
+
     pthread_mutex_lock(&m_fsCtx->tablesMap->mtx);
     cx_cdict_iter_begin(m_fsCtx->tablesMap);
     while (cx_cdict_iter_next(m_fsCtx->tablesMap, &tableName, (void**)&table))
@@ -527,12 +707,17 @@ bool fs_table_dump_tryenqueue()
 
             task->data = data;
             taskman_activate(task);
+            (*_outDumpsCount)++;
+        }
+        else
+        {
+            success = false;
         }
     }
     cx_cdict_iter_end(m_fsCtx->tablesMap);
     pthread_mutex_unlock(&m_fsCtx->tablesMap->mtx);
 
-    return true;
+    return success;
 }
 
 bool fs_table_compact_tryenqueue(const char* _tableName)
@@ -617,6 +802,71 @@ void fs_table_free(table_t* _table)
         taskman_activate(task);
 }
 
+void fs_table_filter_set(table_t* _table, const cx_path_t* _filePath, cx_bloom_t* _filter)
+{
+    // replaces the in-memory bloom filter of the given table file. a NULL _filter just removes it.
+    cx_path_t   fileName;
+    cx_bloom_t* filter = NULL;
+    cx_file_get_name(_filePath, false, &fileName);
+
+    pthread_mutex_lock(&_table->filters->mtx);
+    if (cx_cdict_tryremove(_table->filters, fileName, (void**)&filter))
+    {
+        cx_bloom_destroy(filter);
+    }
+
+    if (NULL != _filter)
+    {
+        cx_cdict_set(_table->filters, fileName, _filter);
+    }
+    pthread_mutex_unlock(&_table->filters->mtx);
+}
+
+void fs_table_filter_move(table_t* _table, const cx_path_t* _filePathOld, const cx_path_t* _filePathNew)
+{
+    // must be called everytime a table file is renamed so that its filter follows it.
+    cx_path_t   fileName;
+    cx_bloom_t* filter = NULL;
+    cx_file_get_name(_filePathOld, false, &fileName);
+
+    pthread_mutex_lock(&_table->filters->mtx);
+    cx_cdict_tryremove(_table->filters, fileName, (void**)&filter);
+    fs_table_filter_set(_table, _filePathNew, filter);
+    pthread_mutex_unlock(&_table->filters->mtx);
+}
+
+bool fs_table_file_move(table_t* _table, const cx_path_t* _filePathOld, const cx_path_t* _filePathNew, cx_err_t* _err)
+{
+    // renames a partition/dump file of the given table. its in-memory filter follows it 
+    // and the descriptors cached for both names are dropped.
+    _fs_file_uncache(_table, _filePathOld);
+    _fs_file_uncache(_table, _filePathNew);
+
+    if (cx_file_move(_filePathOld, _filePathNew, _err))
+    {
+        fs_table_filter_move(_table, _filePathOld, _filePathNew);
+        _fs_catalog_move(_table, _filePathOld, _filePathNew);
+        return true;
+    }
+    return false;
+}
+
+bool fs_table_part_may_contain(table_t* _table, uint16_t _partNumber, bool _isDuringCompaction, uint16_t _key)
+{
+    cx_path_t path;
+    _fs_get_part_path(&path, _table->meta.name, _partNumber, _isDuringCompaction);
+
+    return _fs_table_filter_check(_table, &path, _key);
+}
+
+bool fs_table_dump_may_contain(table_t* _table, uint16_t _dumpNumber, bool _isDuringCompaction, uint16_t _key)
+{
+    cx_path_t path;
+    _fs_get_dump_path(&path, _table->meta.name, _dumpNumber, _isDuringCompaction);
+
+    return _fs_table_filter_check(_table, &path, _key);
+}
+
 cx_file_explorer_t* fs_table_explorer(const char* _tableName, cx_err_t* _err)
 {
     cx_path_t path;
@@ -632,64 +882,107 @@ uint32_t fs_block_alloc(uint32_t _blocksCount, uint32_t* _outBlocksArr)
 {
     pthread_mutex_lock(&m_fsCtx->mtxBlocks);
     uint32_t allocatedBlocks = 0;
+    uint32_t segmentIndex = 0;
 
-    // we'll cast the underlying char array as an uint32 array (4 bytes per element)
-    // so that we can iterate it and figure out which blocks are available faster 
-    // than checking one bit at a time. 
-    // we'll be basically checking 4 bytes (32 bits) at once and comparing the 
-    // value against UINT32_MAX (integer in which all the bits are set). 
-    // a matching value means that 4-bytes segment of our bit array
-    // is full (meaning there're no fs blocks available in there for us to use, 
-    // in that case, we'll just continue iterating and checking the next segment
-    // until we're able to find a free one). 
-    // if the value does not match, that means there's at least 1 bit that is not set
-    // (meaning there's a fs block available for us to allocate).
+    // the summary bitmap tells us which segments (4 bytes of our bit array) still have 
+    // at least one block available, so we can jump straight to the first non-full segment 
+    // (starting at our hint) and pick its first unset bit using a ctz instruction.
 
-    uint32_t* segments = (uint32_t*)m_fsCtx->blocksMap;
-    uint32_t maxSegments = (uint32_t)ceilf((float)m_fsCtx->meta.blocksCount / SEGMENT_BITS);
-    uint32_t lastSegmentMaxBit = m_fsCtx->meta.blocksCount % SEGMENT_BITS;
-    if (0 == lastSegmentMaxBit) lastSegmentMaxBit = SEGMENT_BITS;
+    while (allocatedBlocks < _blocksCount)
+    {
+        segmentIndex = _fs_block_segment_find_free();
+        if (UINT32_MAX == segmentIndex) break;
+
+        // we found a block available!
+        _outBlocksArr[allocatedBlocks] = segmentIndex * SEGMENT_BITS + BIT_FIRST_UNSET(_fs_block_segment_get(segmentIndex));
+        _fs_block_mark(_outBlocksArr[allocatedBlocks], true);
+        m_fsCtx->blocksHint = segmentIndex;
+
+        // it starts empty. its owner writes it later on, outside of this lock.
+        if (BLOCK_STORE_DATAFILE == m_fsCtx->meta.blockStore)
+            m_fsCtx->blocksLength[_outBlocksArr[allocatedBlocks]] = 0;
+        allocatedBlocks++;
+    }
+
+    pthread_mutex_unlock(&m_fsCtx->mtxBlocks);
+    return allocatedBlocks;
+}
 
-    uint32_t i = 0, j = 0, maxBit = 0;
+uint32_t fs_block_alloc_extent(uint32_t _blocksCount, uint32_t* _outBlocksArr)
+{
+    // allocates _blocksCount contiguous blocks (an extent), so that sequential reads of the 
+    // file hit consecutive regions of the underlying storage. it's all or nothing, 
+    // returns _blocksCount on success or zero if there's no free run long enough.
+    if (_blocksCount < 1) return 0;
+
+    pthread_mutex_lock(&m_fsCtx->mtxBlocks);
+
+    uint32_t segmentsCount = m_fsCtx->blocksSegmentsCount;
+    uint32_t segment = 0;
+    uint32_t runStart = 0;
+    uint32_t runLength = 0;
+    uint32_t i = 0;
 
-    while (allocatedBlocks < _blocksCount && i < maxSegments)
+    if (m_fsCtx->blocksFree >= _blocksCount)
     {
-        for (; i < maxSegments; i++)
+        while (runLength < _blocksCount && i < segmentsCount)
         {
-            if (UINT32_MAX != segments[i])
+            if (0 == i % SEGMENT_BITS && UINT32_MAX == m_fsCtx->blocksSummary[i / SEGMENT_BITS])
             {
-                maxBit = (i == maxSegments - 1)
-                    ? lastSegmentMaxBit
-                    : SEGMENT_BITS;
+                // the next SEGMENT_BITS segments are full, skip them all at once
+                runLength = 0;
+                i += SEGMENT_BITS;
+                continue;
+            }
 
-                // there's *at least* 1 bit available, let's figure out which one
-                for (; j < maxBit; j++)
+            segment = _fs_block_segment_get(i);
+            if (UINT32_MAX == segment)
+            {
+                runLength = 0;
+            }
+            else if (0 == segment)
+            {
+                if (0 == runLength) runStart = i * SEGMENT_BITS;
+                runLength += SEGMENT_BITS;
+            }
+            else
+            {
+                for (uint32_t j = 0; j < SEGMENT_BITS && runLength < _blocksCount; j++)
                 {
-                    if (!BIT_IS_SET(segments[i], j))
+                    if (BIT_IS_SET(segment, j))
                     {
-                        // we found a block available!
-                        _outBlocksArr[allocatedBlocks++] = i * SEGMENT_BITS + j;
-
-                        segments[i] |= ((uint32_t)1 << j);
-                        fseek(m_fsCtx->blocksFile, i * sizeof(uint32_t), SEEK_SET);
-                        fwrite(&segments[i], sizeof(uint32_t), 1, m_fsCtx->blocksFile);
-
-                        // initiate it empty
-                        fs_block_write(_outBlocksArr[allocatedBlocks - 1], NULL, 0, NULL);
-
-                        goto block_found;
+                        runLength = 0;
+                    }
+                    else
+                    {
+                        if (0 == runLength) runStart = i * SEGMENT_BITS + j;
+                        runLength++;
                     }
                 }
             }
-            j = 0;
+            i++;
         }
+    }
+
+    if (runLength >= _blocksCount)
+    {
+        for (uint32_t j = 0; j < _blocksCount; j++)
+        {
+            _outBlocksArr[j] = runStart + j;
+            _fs_block_mark(_outBlocksArr[j], true);
 
-    block_found:;
+            // it starts empty. its owner writes it later on, outside of this lock.
+            if (BLOCK_STORE_DATAFILE == m_fsCtx->meta.blockStore)
+                m_fsCtx->blocksLength[_outBlocksArr[j]] = 0;
+        }
+    }
+    else
+    {
+        _blocksCount = 0;
     }
-    fflush(m_fsCtx->blocksFile);
 
     pthread_mutex_unlock(&m_fsCtx->mtxBlocks);
-    return allocatedBlocks;
+    return _blocksCount;
 }
 
 void fs_block_free(uint32_t* _blocksArr, uint32_t _blocksCount)
@@ -700,34 +993,71 @@ void fs_block_free(uint32_t* _blocksArr, uint32_t _blocksCount)
 
     cx_path_t blockFilePath;
 
-    uint32_t* segments = (uint32_t*)m_fsCtx->blocksMap;
-    uint32_t segmentIndex = 0;
-    uint32_t bit = 0;
-
     for (uint32_t i = 0; i < _blocksCount; i++)
     {
-        segmentIndex = (uint32_t)floorf((float)_blocksArr[i] / SEGMENT_BITS);
-        bit = _blocksArr[i] % SEGMENT_BITS;
+        _fs_block_mark(_blocksArr[i], false);
 
-        segments[segmentIndex] &= ~((uint32_t)1 << bit);
-        fseek(m_fsCtx->blocksFile, segmentIndex * sizeof(uint32_t), SEEK_SET);
-        fwrite(&segments[segmentIndex], sizeof(uint32_t), 1, m_fsCtx->blocksFile);
+        // keep the allocations packed at the beginning of the bitmap
+        if (_blocksArr[i] / SEGMENT_BITS < m_fsCtx->blocksHint)
+            m_fsCtx->blocksHint = _blocksArr[i] / SEGMENT_BITS;
 
-        // delete the file in the ufs
-        _fs_get_block_path(&blockFilePath, _blocksArr[i]);
-        cx_file_remove(&blockFilePath, NULL);
+        if (BLOCK_STORE_FILES == m_fsCtx->meta.blockStore)
+        {
+            // delete the file in the ufs
+            _fs_get_block_path(&blockFilePath, _blocksArr[i]);
+            cx_file_remove(&blockFilePath, NULL);
+        }
+        fs_cache_invalidate(_blocksArr[i]);
     }
-    fflush(m_fsCtx->blocksFile);
 
     pthread_mutex_unlock(&m_fsCtx->mtxBlocks);
 }
 
+bool fs_block_sync()
+{
+    // blocksMap is a shared mapping of the bitmap file, so allocations and deallocations 
+    // reach the file eventually anyways. this function must be called at commit points 
+    // (dumps, compactions, table creation/deletion) to make sure they're persisted by then.
+    // returns false if the bitmap could not be synced (it's retried on the next call).
+    pthread_mutex_lock(&m_fsCtx->mtxBlocks);
+    bool dirty = m_fsCtx->blocksMapDirty;
+    m_fsCtx->blocksMapDirty = false;
+    pthread_mutex_unlock(&m_fsCtx->mtxBlocks);
+
+    if (dirty && 0 != msync(m_fsCtx->blocksMap, m_fsCtx->blocksMapSize, MS_SYNC))
+    {
+        pthread_mutex_lock(&m_fsCtx->mtxBlocks);
+        m_fsCtx->blocksMapDirty = true;
+        pthread_mutex_unlock(&m_fsCtx->mtxBlocks);
+        CX_WARN(CX_ALW, "bitmap file could not be synced! %s", strerror(errno));
+        return false;
+    }
+    return true;
+}
+
 int32_t fs_block_read(uint32_t _blockNumber, char* _buffer, cx_err_t* _err)
 {
-    cx_path_t blockFilePath;
-    _fs_get_block_path(&blockFilePath, _blockNumber);
+    uint32_t ticket = 0;
+    int32_t  bytesRead = fs_cache_get(_blockNumber, _buffer, &ticket);
+    if (-1 != bytesRead) return bytesRead;
+
+    if (BLOCK_STORE_DATAFILE == m_fsCtx->meta.blockStore)
+    {
+        bytesRead = _fs_block_data_read(_blockNumber, _buffer, _err);
+    }
+    else
+    {
+        cx_path_t blockFilePath;
+        _fs_get_block_path(&blockFilePath, _blockNumber);
+
+        bytesRead = cx_file_read(&blockFilePath, _buffer, m_fsCtx->meta.blocksSize, _err);
+    }
 
-    return cx_file_read(&blockFilePath, _buffer, m_fsCtx->meta.blocksSize, _err);
+    if (-1 != bytesRead)
+    {
+        fs_cache_put(_blockNumber, _buffer, (uint32_t)bytesRead, ticket);
+    }
+    return bytesRead;
 }
 
 bool fs_block_write(uint32_t _blockNumber, char* _buffer, uint32_t _bufferSize, cx_err_t* _err)
@@ -735,17 +1065,28 @@ bool fs_block_write(uint32_t _blockNumber, char* _buffer, uint32_t _bufferSize,
     CX_CHECK(_bufferSize <= m_fsCtx->meta.blocksSize, "_bufferSize must be less than or equal to blocksSize (%d bytes)!", 
         m_fsCtx->meta.blocksSize);
 
-    cx_path_t blockFilePath;
-    _fs_get_block_path(&blockFilePath, _blockNumber);
+    bool success = false;
 
-    if (NULL == _buffer || 0 == _bufferSize)
+    if (BLOCK_STORE_DATAFILE == m_fsCtx->meta.blockStore)
     {
-        return cx_file_touch(&blockFilePath, _err);
+        success = _fs_block_data_write(_blockNumber, _buffer, _bufferSize, _err);
     }
     else
     {
-        return cx_file_write(&blockFilePath, _buffer, _bufferSize, _err);
+        cx_path_t blockFilePath;
+        _fs_get_block_path(&blockFilePath, _blockNumber);
+
+        if (NULL == _buffer || 0 == _bufferSize)
+            success = cx_file_touch(&blockFilePath, _err);
+        else
+            success = cx_file_write(&blockFilePath, _buffer, _bufferSize, _err);
     }
+
+    // invalidate once the new contents are on disk (even if the write failed, they might be partially there).
+    // readers which took their ticket before this point can't cache what they read, old or new.
+    fs_cache_invalidate(_blockNumber);
+
+    return success;
 }
 
 uint32_t fs_block_size()
@@ -753,11 +1094,41 @@ uint32_t fs_block_size()
     return m_fsCtx->meta.blocksSize;
 }
 
+RECORD_FORMAT fs_record_format()
+{
+    return m_fsCtx->meta.recordFormat;
+}
+
+COMPRESSION fs_compression()
+{
+    return m_fsCtx->meta.compression;
+}
+
+void fs_block_cache_stats(uint64_t* _outHits, uint64_t* _outMisses, uint32_t* _outCapacity)
+{
+    fs_cache_stats(_outHits, _outMisses, _outCapacity);
+}
+
 bool fs_file_read(fs_file_t* _file, char* _buffer, cx_err_t* _err)
 {
     uint32_t buffPos = 0;
     int32_t bytesRead = 0;
 
+    if (COMPRESSION_NONE != _file->compression)
+    {
+        // each frame is decompressed straight into its final position of the buffer.
+        bool  success = true;
+        char* block = malloc(m_fsCtx->meta.blocksSize);
+
+        for (uint32_t i = 0; success && i < _file->blocksCount; i++)
+        {
+            success = _fs_file_frame_read(_file, i, block, &_buffer[_file->frames[i]], _err);
+        }
+
+        free(block);
+        return success;
+    }
+
     for (uint32_t i = 0; i < _file->blocksCount; i++)
     {
         bytesRead = fs_block_read(_file->blocks[i], &_buffer[buffPos], _err);
@@ -779,6 +1150,76 @@ bool fs_file_read(fs_file_t* _file, char* _buffer, cx_err_t* _err)
     return true;
 }
 
+bool fs_file_read_range(fs_file_t* _file, uint32_t _offset, uint32_t _size, char* _buffer, cx_err_t* _err)
+{
+    // reads _size bytes starting at the given byte _offset of the file, 
+    // touching only the blocks that overlap with the requested range.
+
+    if (_offset + _size > _file->size)
+    {
+        CX_ERR_SET(_err, 1, "range [%d, %d) is out of the bounds of the file (size is %d).", 
+            _offset, _offset + _size, _file->size);
+        return false;
+    }
+
+    if (COMPRESSION_NONE != _file->compression)
+        return _fs_file_read_range_frames(_file, _offset, _size, _buffer, _err);
+
+    bool     success = true;
+    uint32_t blockSize = m_fsCtx->meta.blocksSize;
+    uint32_t buffPos = 0;
+    uint32_t blockPos = _offset % blockSize;
+    uint32_t bytesNeeded = 0;
+    int32_t  bytesRead = 0;
+    char*    block = malloc(blockSize);
+
+    for (uint32_t i = _offset / blockSize; buffPos < _size && i < _file->blocksCount; i++)
+    {
+        bytesRead = fs_block_read(_file->blocks[i], block, _err);
+        if (-1 == bytesRead)
+        {
+            CX_ERR_SET(_err, 1, "block #%d could not be read!", _file->blocks[i]);
+            success = false;
+            break;
+        }
+
+        bytesNeeded = cx_math_min(_size - buffPos, blockSize - blockPos);
+        if ((uint32_t)bytesRead < blockPos + bytesNeeded)
+        {
+            CX_ERR_SET(_err, 1, "block #%d is truncated! (size is %d but we need %d)", 
+                _file->blocks[i], bytesRead, blockPos + bytesNeeded);
+            success = false;
+            break;
+        }
+
+        memcpy(&_buffer[buffPos], &block[blockPos], bytesNeeded);
+        buffPos += bytesNeeded;
+        blockPos = 0;
+    }
+
+    free(block);
+
+    if (success && buffPos != _size)
+    {
+        CX_ERR_SET(_err, 1, "range is not fully loaded! (size is %d but we read %d)", _size, buffPos);
+        success = false;
+    }
+
+    return success;
+}
+
+uint32_t fs_file_chunk_end(const fs_file_t* _file, uint32_t _offset)
+{
+    // returns the offset where the smallest readable unit of the file containing the given 
+    // byte _offset ends: its block or, for compressed files, its frame. sequential readers 
+    // should read whole units at once since a compressed frame is decompressed on every read.
+    if (COMPRESSION_NONE != _file->compression)
+        return _fs_file_frame_end(_file, _fs_file_frame_find(_file, _offset));
+
+    uint32_t blockSize = m_fsCtx->meta.blocksSize;
+    return cx_math_min((_offset / blockSize + 1) * blockSize, _file->size);
+}
+
 bool fs_file_delete(fs_file_t* _file, cx_err_t* _err)
 {
     fs_block_free(_file->blocks, _file->blocksCount);
@@ -788,28 +1229,14 @@ bool fs_file_delete(fs_file_t* _file, cx_err_t* _err)
 
 bool fs_is_dump(cx_path_t* _filePath, uint16_t* _outDumpNumber, bool* _outDuringCompaction)
 {
-    uint16_t dumpNumber = 0;
-    bool     duringCompaction = false;
-    
-    cx_path_t fileName;
-    cx_file_get_name(_filePath, false, &fileName);
-
-    if (cx_str_starts_with(fileName, LFS_DUMP_PREFIX, true))
-    {
-        duringCompaction = cx_str_ends_with(fileName, "." LFS_DUMP_EXTENSION_COMPACTION, true);
-
-        if (!duringCompaction && !cx_str_ends_with(fileName, "." LFS_DUMP_EXTENSION, true))
-            return false;
+    return _fs_parse_file_name(_filePath, LFS_DUMP_PREFIX, LFS_DUMP_EXTENSION, LFS_DUMP_EXTENSION_COMPACTION, 
+        _outDumpNumber, _outDuringCompaction);
+}
 
-        (*strchr(fileName, '.')) = '\0'; // get rid of the extension truncating at char '.'
-        if (cx_str_to_uint16(&fileName[sizeof(LFS_DUMP_PREFIX) - 1], &dumpNumber))
-        {
-            if (NULL != _outDumpNumber) (*_outDumpNumber) = dumpNumber;
-            if (NULL != _outDuringCompaction) (*_outDuringCompaction) = duringCompaction;
-            return true;
-        }
-    }
-    return false;
+bool fs_is_part(cx_path_t* _filePath, uint16_t* _outPartNumber, bool* _outDuringCompaction)
+{
+    return _fs_parse_file_name(_filePath, LFS_PART_PREFIX, LFS_PART_EXTENSION, LFS_PART_EXTENSION_COMPACTION, 
+        _outPartNumber, _outDuringCompaction);
 }
 
  /****************************************************************************************
@@ -874,6 +1301,15 @@ static bool _fs_bootstrap(cx_path_t* _rootDir, uint32_t _maxBlocks, uint32_t _bl
 
             config_set_value(meta, LFS_META_PROP_MAGIC_NUMBER, LFS_MAGIC_NUMBER);
 
+            // new filesystems store their records using the columnar format by default
+            config_set_value(meta, LFS_META_PROP_RECORD_FORMAT, LFS_RECORD_FORMAT_COLUMNAR);
+
+            // and their blocks in a single preallocated data file
+            config_set_value(meta, LFS_META_PROP_BLOCK_STORE, LFS_BLOCK_STORE_DATAFILE);
+
+            // and compress the contents of their partitions and dumps
+            config_set_value(meta, LFS_META_PROP_COMPRESSION, LFS_COMPRESSION_LZ);
+
             config_save(meta);
             config_destroy(meta);
 
@@ -901,24 +1337,62 @@ static bool _fs_bootstrap(cx_path_t* _rootDir, uint32_t _maxBlocks, uint32_t _bl
         free(emptyBuffer);
     }
 
+    // preallocate the blocks data file
+    success = success && _fs_bootstrap_blocks_data(_rootDir, _maxBlocks, _blockSize, _err);
+
     return success;
 }
 
-static bool _fs_load_meta(cx_err_t* _err)
+static bool _fs_bootstrap_blocks_data(cx_path_t* _rootDir, uint32_t _maxBlocks, uint32_t _blockSize, cx_err_t* _err)
 {
-    CX_ERR_CLEAR(_err);
-
-    char* temp = NULL;
-    char* key = "";
-    
-    cx_path_t metadataPath;
-    cx_file_path(&metadataPath, "%s/%s/%s", m_fsCtx->rootDir, LFS_DIR_METADATA, LFS_FILE_METADATA);
+    // the file is made of a header containing the length (uint32) of each block followed by
+    // the data of each block (_blockSize bytes each one). all the lengths initiate in zero.
+    bool      success = false;
+    off_t     size = (off_t)_maxBlocks * sizeof(uint32_t) + (off_t)_maxBlocks * _blockSize;
+    cx_path_t path;
 
-    t_config* meta = config_create(metadataPath);
+    cx_file_path(&path, "%s/%s/%s", _rootDir, LFS_DIR_BLOCKS, LFS_FILE_BLOCKS_DATA);
 
-    if (NULL != meta)
+    int fd = open(path, O_RDWR | O_CREAT | O_TRUNC, 0664);
+    if (-1 != fd)
     {
-        key = LFS_META_PROP_BLOCKS_COUNT;
+        if (0 == ftruncate(fd, size))
+        {
+            // reserve the space upfront so that block writes never need to grow the file.
+            // filesystems not supporting it just keep the (sparse) file we already have.
+            int result = posix_fallocate(fd, 0, size);
+            CX_WARN(0 == result, "blocks data file '%s' could not be preallocated. %s", path, strerror(result));
+            success = true;
+        }
+        else
+        {
+            CX_ERR_SET(_err, ERR_INIT_FS_BOOTSTRAP, "blocks data file '%s' could not be resized. %s", path, strerror(errno));
+        }
+        close(fd);
+    }
+    else
+    {
+        CX_ERR_SET(_err, ERR_INIT_FS_BOOTSTRAP, "blocks data file '%s' could not be created. %s", path, strerror(errno));
+    }
+
+    return success;
+}
+
+static bool _fs_load_meta(cx_err_t* _err)
+{
+    CX_ERR_CLEAR(_err);
+
+    char* temp = NULL;
+    char* key = "";
+    
+    cx_path_t metadataPath;
+    cx_file_path(&metadataPath, "%s/%s/%s", m_fsCtx->rootDir, LFS_DIR_METADATA, LFS_FILE_METADATA);
+
+    t_config* meta = config_create(metadataPath);
+
+    if (NULL != meta)
+    {
+        key = LFS_META_PROP_BLOCKS_COUNT;
         if (config_has_property(meta, key))
         {
             m_fsCtx->meta.blocksCount = (uint32_t)config_get_int_value(meta, key);
@@ -949,6 +1423,61 @@ static bool _fs_load_meta(cx_err_t* _err)
             goto key_missing;
         }
 
+        // optional. filesystems bootstrapped before the binary format existed 
+        // don't have this key and keep writing their records as text.
+        key = LFS_META_PROP_RECORD_FORMAT;
+        m_fsCtx->meta.recordFormat = RECORD_FORMAT_TEXT;
+        if (config_has_property(meta, key))
+        {
+            temp = config_get_string_value(meta, key);
+            if (0 == strcasecmp(temp, LFS_RECORD_FORMAT_BINARY))
+            {
+                m_fsCtx->meta.recordFormat = RECORD_FORMAT_BINARY;
+            }
+            else if (0 == strcasecmp(temp, LFS_RECORD_FORMAT_COLUMNAR))
+            {
+                m_fsCtx->meta.recordFormat = RECORD_FORMAT_COLUMNAR;
+            }
+            else if (0 != strcasecmp(temp, LFS_RECORD_FORMAT_TEXT))
+            {
+                CX_WARN(CX_ALW, "unknown record format '%s'. falling back to %s.", temp, LFS_RECORD_FORMAT_TEXT);
+            }
+        }
+
+        // optional. filesystems bootstrapped before the blocks data file existed
+        // don't have this key and keep storing one file per block.
+        key = LFS_META_PROP_BLOCK_STORE;
+        m_fsCtx->meta.blockStore = BLOCK_STORE_FILES;
+        if (config_has_property(meta, key))
+        {
+            temp = config_get_string_value(meta, key);
+            if (0 == strcasecmp(temp, LFS_BLOCK_STORE_DATAFILE))
+            {
+                m_fsCtx->meta.blockStore = BLOCK_STORE_DATAFILE;
+            }
+            else if (0 != strcasecmp(temp, LFS_BLOCK_STORE_FILES))
+            {
+                CX_WARN(CX_ALW, "unknown block store '%s'. falling back to %s.", temp, LFS_BLOCK_STORE_FILES);
+            }
+        }
+
+        // optional. filesystems bootstrapped before block compression existed
+        // don't have this key and keep writing their blocks uncompressed.
+        key = LFS_META_PROP_COMPRESSION;
+        m_fsCtx->meta.compression = COMPRESSION_NONE;
+        if (config_has_property(meta, key))
+        {
+            temp = config_get_string_value(meta, key);
+            if (0 == strcasecmp(temp, LFS_COMPRESSION_LZ))
+            {
+                m_fsCtx->meta.compression = COMPRESSION_LZ;
+            }
+            else if (0 != strcasecmp(temp, LFS_COMPRESSION_NONE))
+            {
+                CX_WARN(CX_ALW, "unknown compression '%s'. falling back to %s.", temp, LFS_COMPRESSION_NONE);
+            }
+        }
+
         if ((0 == strcmp(m_fsCtx->meta.magicNumber, LFS_MAGIC_NUMBER)))
         {
             config_destroy(meta);
@@ -1001,8 +1530,10 @@ static bool _fs_load_tables(cx_err_t* _err)
             
             if (fs_table_init(&table, tableName, _err)
                 && fs_table_meta_get(tableName, &table->meta, _err)
-                && memtable_init(tableName, true, &table->memtable, _err))
+                && memtable_init(tableName, table->meta.partitionsCount, true, &table->memtable, _err))
             {
+                _fs_catalog_load(table);
+
                 table->timerHandle = cx_timer_add(table->meta.compactionInterval, LFS_TIMER_COMPACT, table);
                 CX_CHECK(INVALID_HANDLE != table->timerHandle, "we ran out of timer handles for table '%s'!", table->meta.name);
                 
@@ -1034,49 +1565,275 @@ static bool _fs_load_blocks(cx_err_t* _err)
     cx_path_t bitmapPath;
     cx_file_path(&bitmapPath, "%s/%s/%s", m_fsCtx->rootDir, LFS_DIR_METADATA, LFS_FILE_BITMAP);
 
-    int32_t size = (int32_t)_fs_calc_bitmap_size(m_fsCtx->meta.blocksCount);
-    m_fsCtx->blocksMap = malloc(size);
-    
-    int32_t bytesRead = cx_file_read(&bitmapPath, m_fsCtx->blocksMap, size, _err);
-    if (size == bytesRead)
+    uint32_t size = _fs_calc_bitmap_size(m_fsCtx->meta.blocksCount);
+    struct stat st;
+
+    int fd = open(bitmapPath, O_RDWR);
+    if (-1 == fd)
+    {
+        CX_ERR_SET(_err, ERR_INIT_FS_BITMAP, "bitmap file '%s' could not be opened for writing! %s", bitmapPath, strerror(errno));
+        return false;
+    }
+
+    if (0 != fstat(fd, &st) || size != st.st_size)
     {
-        // the bitmap file is OK
-        m_fsCtx->blocksFile = fopen(bitmapPath, "r+");
-        if (NULL == m_fsCtx->blocksFile)
+        CX_ERR_SET(_err, ERR_INIT_FS_BITMAP, "the amount of bytes expected and the "
+            "size of the bitmap file '%s' do not match. "
+            "the file might be corrupt at this point.", bitmapPath);
+    }
+    else
+    {
+        // the bitmap file is OK. map it so that allocations only need to flip bits in memory.
+        m_fsCtx->blocksMap = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        if (MAP_FAILED == m_fsCtx->blocksMap)
         {
-            CX_ERR_SET(_err, ERR_INIT_FS_BITMAP, "bitmap file '%s' could not be opened for writing!", bitmapPath);
+            m_fsCtx->blocksMap = NULL;
+            CX_ERR_SET(_err, ERR_INIT_FS_BITMAP, "bitmap file '%s' could not be mapped! %s", bitmapPath, strerror(errno));
         }
         else
         {
-            return true;
+            m_fsCtx->blocksMapSize = size;
+            m_fsCtx->blocksMapDirty = false;
         }
     }
-    else if (-1 == bytesRead)
+
+    // the mapping remains valid after closing the descriptor.
+    close(fd);
+    return NULL != m_fsCtx->blocksMap;
+}
+
+static bool _fs_load_blocks_summary(cx_err_t* _err)
+{
+    // builds the summary bitmap (one bit per segment of blocksMap, set if the segment is full)
+    // and counts the blocks available. summary bits beyond the last segment are always set.
+    m_fsCtx->blocksSegmentsCount = (m_fsCtx->meta.blocksCount + SEGMENT_BITS - 1) / SEGMENT_BITS;
+
+    uint32_t summarySize = (m_fsCtx->blocksSegmentsCount + SEGMENT_BITS - 1) / SEGMENT_BITS;
+    m_fsCtx->blocksSummary = CX_MEM_ARR_ALLOC(m_fsCtx->blocksSummary, summarySize);
+    if (NULL == m_fsCtx->blocksSummary)
+    {
+        CX_ERR_SET(_err, ERR_INIT_FS_BITMAP, "bitmap summary could not be allocated!");
+        return false;
+    }
+
+    uint32_t segment = 0;
+    m_fsCtx->blocksFree = 0;
+    m_fsCtx->blocksHint = 0;
+
+    for (uint32_t i = 0; i < summarySize * SEGMENT_BITS; i++)
     {
-        // noop. _err already contains the reason of the cx_file_read call failure.
+        segment = (i < m_fsCtx->blocksSegmentsCount) ? _fs_block_segment_get(i) : UINT32_MAX;
+
+        if (UINT32_MAX == segment)
+            m_fsCtx->blocksSummary[i / SEGMENT_BITS] |= ((uint32_t)1 << (i % SEGMENT_BITS));
+        
+        m_fsCtx->blocksFree += SEGMENT_BITS - BIT_COUNT_SET(segment);
+    }
+
+    CX_INFO("%d blocks available out of %d.", m_fsCtx->blocksFree, m_fsCtx->meta.blocksCount);
+    return true;
+}
+
+static uint32_t _fs_block_segment_get(uint32_t _segmentIndex)
+{
+    // returns the given segment of blocksMap. bits of the last segment beyond 
+    // meta.blocksCount don't represent real blocks, so they're returned as set.
+    uint32_t segment = ((uint32_t*)m_fsCtx->blocksMap)[_segmentIndex];
+    uint32_t lastBits = m_fsCtx->meta.blocksCount % SEGMENT_BITS;
+
+    if (_segmentIndex == m_fsCtx->blocksSegmentsCount - 1 && lastBits > 0)
+        segment |= ~(((uint32_t)1 << lastBits) - 1);
+
+    return segment;
+}
+
+static uint32_t _fs_block_segment_find_free()
+{
+    // returns the index of the first segment with at least one block available 
+    // starting at blocksHint (and wrapping around), or UINT32_MAX if they're all full.
+    if (0 == m_fsCtx->blocksFree) return UINT32_MAX;
+
+    uint32_t summarySize = (m_fsCtx->blocksSegmentsCount + SEGMENT_BITS - 1) / SEGMENT_BITS;
+    uint32_t first = m_fsCtx->blocksHint / SEGMENT_BITS;
+    uint32_t w = 0;
+
+    for (uint32_t i = 0; i < summarySize; i++)
+    {
+        w = (first + i) % summarySize;
+        if (UINT32_MAX != m_fsCtx->blocksSummary[w])
+            return w * SEGMENT_BITS + BIT_FIRST_UNSET(m_fsCtx->blocksSummary[w]);
+    }
+
+    CX_CHECK(CX_ALW, "blocksFree is %d but the summary bitmap is full!", m_fsCtx->blocksFree);
+    return UINT32_MAX;
+}
+
+static void _fs_block_mark(uint32_t _blockNumber, bool _used)
+{
+    // sets (or unsets) the bit of the given block updating the summary bitmap accordingly.
+    // mtxBlocks must be locked by the caller.
+    CX_CHECK(_blockNumber < m_fsCtx->meta.blocksCount, "invalid block number #%d!", _blockNumber);
+
+    uint32_t* segments = (uint32_t*)m_fsCtx->blocksMap;
+    uint32_t  segmentIndex = _blockNumber / SEGMENT_BITS;
+    uint32_t  mask = (uint32_t)1 << (_blockNumber % SEGMENT_BITS);
+    uint32_t  summaryMask = (uint32_t)1 << (segmentIndex % SEGMENT_BITS);
+
+    if (_used == (0 != (segments[segmentIndex] & mask))) return;
+
+    if (_used)
+    {
+        segments[segmentIndex] |= mask;
+        m_fsCtx->blocksFree--;
+
+        if (UINT32_MAX == _fs_block_segment_get(segmentIndex))
+            m_fsCtx->blocksSummary[segmentIndex / SEGMENT_BITS] |= summaryMask;
     }
     else
     {
-        CX_ERR_SET(_err, ERR_INIT_FS_BITMAP, "the amount of bytes expected and the "
-            "amount of actual bytes read from the bitmap file '%s' do not match. "
-            "the file might be corrupt at this point.", bitmapPath);
+        segments[segmentIndex] &= ~mask;
+        m_fsCtx->blocksFree++;
+        m_fsCtx->blocksSummary[segmentIndex / SEGMENT_BITS] &= ~summaryMask;
     }
 
-    if (NULL != m_fsCtx->blocksMap) 
+    m_fsCtx->blocksMapDirty = true;
+}
+
+static bool _fs_load_blocks_data(cx_err_t* _err)
+{
+    if (BLOCK_STORE_DATAFILE != m_fsCtx->meta.blockStore) return true;
+
+    cx_path_t dataPath;
+    cx_file_path(&dataPath, "%s/%s/%s", m_fsCtx->rootDir, LFS_DIR_BLOCKS, LFS_FILE_BLOCKS_DATA);
+
+    size_t headerSize = (size_t)m_fsCtx->meta.blocksCount * sizeof(uint32_t);
+    off_t  size = (off_t)headerSize + (off_t)m_fsCtx->meta.blocksCount * m_fsCtx->meta.blocksSize;
+    struct stat st;
+
+    m_fsCtx->blocksDataFd = open(dataPath, O_RDWR);
+    if (-1 == m_fsCtx->blocksDataFd)
     {
-        free(m_fsCtx->blocksMap);
-        m_fsCtx->blocksMap = NULL;
+        CX_ERR_SET(_err, ERR_INIT_FS_BLOCKS, "blocks data file '%s' could not be opened. %s", dataPath, strerror(errno));
+        return false;
     }
 
-    if (NULL != m_fsCtx->blocksFile)
+    if (0 != fstat(m_fsCtx->blocksDataFd, &st) || st.st_size < size)
     {
-        fclose(m_fsCtx->blocksFile);
-        m_fsCtx->blocksFile = NULL;
+        CX_ERR_SET(_err, ERR_INIT_FS_BLOCKS, "blocks data file '%s' is smaller than expected. "
+            "the file might be corrupt at this point.", dataPath);
     }
-    
+    else
+    {
+        // keep the length of every block in memory, so reads don't need to touch the header.
+        m_fsCtx->blocksLength = malloc(headerSize);
+        if ((ssize_t)headerSize == pread(m_fsCtx->blocksDataFd, m_fsCtx->blocksLength, headerSize, 0))
+        {
+            return true;
+        }
+        CX_ERR_SET(_err, ERR_INIT_FS_BLOCKS, "blocks data file '%s' header could not be read.", dataPath);
+    }
+
+    free(m_fsCtx->blocksLength);
+    m_fsCtx->blocksLength = NULL;
+    close(m_fsCtx->blocksDataFd);
+    m_fsCtx->blocksDataFd = -1;
     return false;
 }
 
+static bool _fs_load_all_filters(cx_err_t* _err)
+{
+    // loads the in-memory bloom filters of every table imported from the filesystem.
+    // they're stored along with the metadata of each file, only the files written by older 
+    // versions need to be read in full to build them (once, saving us from doing it on 
+    // every single SELECT request afterwards).
+    char*    tableName = NULL;
+    table_t* table = NULL;
+
+    cx_cdict_iter_begin(m_fsCtx->tablesMap);
+    while (cx_cdict_iter_next(m_fsCtx->tablesMap, &tableName, (void**)&table))
+    {
+        _fs_load_filters(table);
+    }
+    cx_cdict_iter_end(m_fsCtx->tablesMap);
+
+    return true;
+}
+
+static void _fs_load_filters(table_t* _table)
+{
+    cx_err_t      err;
+    memtable_t    memt;
+    uint32_t      dumpsCount = 0;
+    table_file_t* dumps = NULL;
+    cx_path_t     filePath;
+    cx_bloom_t*   filter = NULL;
+
+    for (uint16_t i = 0; i < _table->meta.partitionsCount; i++)
+    {
+        _fs_get_part_path(&filePath, _table->meta.name, i, false);
+
+        if (NULL != (filter = _fs_load_filter(&filePath)))
+        {
+            fs_table_filter_set(_table, &filePath, filter);
+        }
+        else if (memtable_init_from_part(_table->meta.name, i, false, &memt, &err))
+        {
+            fs_table_filter_set(_table, &filePath, memtable_make_filter(&memt));
+            memtable_destroy(&memt);
+        }
+    }
+
+    dumps = fs_table_dump_list(_table, &dumpsCount);
+
+    for (uint32_t i = 0; i < dumpsCount; i++)
+    {
+        _fs_get_dump_path(&filePath, _table->meta.name, dumps[i].number, dumps[i].duringCompaction);
+
+        if (NULL != (filter = _fs_load_filter(&filePath)))
+        {
+            fs_table_filter_set(_table, &filePath, filter);
+        }
+        else if (memtable_init_from_dump(_table->meta.name, dumps[i].number, dumps[i].duringCompaction, &memt, &err))
+        {
+            fs_table_filter_set(_table, &filePath, memtable_make_filter(&memt));
+            memtable_destroy(&memt);
+        }
+    }
+    free(dumps);
+}
+
+static cx_bloom_t* _fs_load_filter(const cx_path_t* _filePath)
+{
+    // returns the bloom filter stored in the metadata of the given file (NULL if it doesn't have one).
+    cx_err_t    err;
+    fs_file_t   file;
+    cx_bloom_t* filter = NULL;
+
+    cx_str_copy(file.path, sizeof(file.path), *_filePath);
+    _fs_file_load(&file, &filter, &err);
+
+    return filter;
+}
+
+static bool _fs_table_filter_check(table_t* _table, const cx_path_t* _filePath, uint16_t _key)
+{
+    // returns false only if the file definitely does not contain the given key.
+    // files without a filter are assumed to contain it.
+    bool        mayContain = true;
+    cx_path_t   fileName;
+    cx_bloom_t* filter = NULL;
+    cx_file_get_name(_filePath, false, &fileName);
+
+    pthread_mutex_lock(&_table->filters->mtx);
+    if (cx_cdict_get(_table->filters, fileName, (void**)&filter))
+    {
+        mayContain = cx_bloom_contains(filter, &_key, sizeof(_key));
+    }
+    pthread_mutex_unlock(&_table->filters->mtx);
+
+    return mayContain;
+}
+
 bool fs_table_init(table_t** _outTable, const char* _tableName, cx_err_t* _err)
 {
     CX_CHECK(strlen(_tableName) > 0, "Invalid table name!");
@@ -1088,9 +1845,24 @@ bool fs_table_init(table_t** _outTable, const char* _tableName, cx_err_t* _err)
     
     table->blockedQueue = queue_create();
     CX_CHECK_NOT_NULL(table->blockedQueue);
+
+    table->filters = cx_cdict_init();
+    CX_CHECK_NOT_NULL(table->filters);
+
+    table->files = cx_cdict_init();
+    CX_CHECK_NOT_NULL(table->files);
+
+    table->catalog = cx_cdict_init();
+    CX_CHECK_NOT_NULL(table->catalog);
+
+    // optional. the row cache is NULL when disabled (or if it could not be created).
+    table->rowCache = row_cache_init(g_ctx.cfg.rowCacheSize, g_ctx.cfg.valueSize);
         
     success = true 
         && NULL != table->blockedQueue
+        && NULL != table->filters
+        && NULL != table->files
+        && NULL != table->catalog
         && cx_reslock_init(&table->reslock, true);
 
     if (!success)
@@ -1129,131 +1901,675 @@ void fs_table_destroy(table_t* _table)
             _table->blockedQueue = NULL;
         }
 
+        if (NULL != _table->filters)
+        {
+            cx_cdict_destroy(_table->filters, (cx_destroyer_cb)cx_bloom_destroy);
+            _table->filters = NULL;
+        }
+
+        if (NULL != _table->files)
+        {
+            cx_cdict_destroy(_table->files, (cx_destroyer_cb)free);
+            _table->files = NULL;
+        }
+
+        if (NULL != _table->catalog)
+        {
+            cx_cdict_destroy(_table->catalog, (cx_destroyer_cb)free);
+            _table->catalog = NULL;
+        }
+
+        row_cache_destroy(_table->rowCache);
+        _table->rowCache = NULL;
+
         free(_table);
     }
 }
 
-static bool _fs_file_load(fs_file_t* _outFile, cx_err_t* _err)
+static bool _fs_file_get(const char* _tableName, const cx_path_t* _filePath, fs_file_t* _outFile, cx_err_t* _err)
 {
-    bool success = false;
-    char* key = NULL;
-    bool keyMissing = false;
-    t_config* file = NULL;
-    CX_ERR_CLEAR(_err);
+    // returns the descriptor of the given partition/dump file. descriptors are cached in memory
+    // per table, so the metadata file is only read the first time the file is requested.
+    bool       success = false;
+    table_t*   table = NULL;
+    fs_file_t* cached = NULL;
+    cx_path_t  fileName;
+
+    cx_str_copy(_outFile->path, sizeof(_outFile->path), *_filePath);
+
+    if (!fs_table_exists(_tableName, &table))
+        return _fs_file_load(_outFile, NULL, _err);
+
+    cx_file_get_name(_filePath, false, &fileName);
+
+    pthread_mutex_lock(&table->files->mtx);
+    if (cx_cdict_get(table->files, fileName, (void**)&cached))
+    {
+        memcpy(_outFile, cached, sizeof(*_outFile));
+        CX_ERR_CLEAR(_err);
+        success = true;
+    }
+    else if (_fs_file_load(_outFile, NULL, _err))
+    {
+        cached = CX_MEM_STRUCT_ALLOC(cached);
+        memcpy(cached, _outFile, sizeof(*cached));
+        cx_cdict_set(table->files, fileName, cached);
+        success = true;
+    }
+    pthread_mutex_unlock(&table->files->mtx);
+
+    return success;
+}
+
+static bool _fs_file_set(const char* _tableName, const cx_path_t* _filePath, fs_file_t* _file, cx_bloom_t* _filter, cx_err_t* _err)
+{
+    // writes the descriptor of the given partition/dump file along with the bloom filter of its keys
+    // (if any), which replaces the in-memory filter of the file once it's written. _filter is owned 
+    // by the table from now on (it's destroyed right away if there's no table or the write fails).
+    bool       success = false;
+    table_t*   table = NULL;
+    fs_file_t* cached = NULL;
+    cx_path_t  fileName;
+
+    cx_str_copy(_file->path, sizeof(_file->path), *_filePath);
 
-    if (cx_file_exists(&_outFile->path))
+    if (!fs_table_exists(_tableName, &table))
+    {
+        success = _fs_file_save(_file, _filter, _err);
+        cx_bloom_destroy(_filter);
+        return success;
+    }
+
+    cx_file_get_name(_filePath, false, &fileName);
+
+    pthread_mutex_lock(&table->files->mtx);
+    success = _fs_file_save(_file, _filter, _err);
+    if (cx_cdict_tryremove(table->files, fileName, (void**)&cached))
+    {
+        free(cached);
+    }
+    if (success)
+    {
+        cached = CX_MEM_STRUCT_ALLOC(cached);
+        memcpy(cached, _file, sizeof(*cached));
+        cx_cdict_set(table->files, fileName, cached);
+        _fs_catalog_add(table, _filePath, _file->size);
+    }
+    pthread_mutex_unlock(&table->files->mtx);
+
+    if (success)
+        fs_table_filter_set(table, _filePath, _filter);
+    else
+        cx_bloom_destroy(_filter);
+
+    return success;
+}
+
+static void _fs_file_uncache(table_t* _table, const cx_path_t* _filePath)
+{
+    fs_file_t* cached = NULL;
+    cx_path_t  fileName;
+    cx_file_get_name(_filePath, false, &fileName);
+
+    pthread_mutex_lock(&_table->files->mtx);
+    if (cx_cdict_tryremove(_table->files, fileName, (void**)&cached))
+    {
+        free(cached);
+    }
+    pthread_mutex_unlock(&_table->files->mtx);
+}
+
+static void _fs_catalog_add(table_t* _table, const cx_path_t* _filePath, uint32_t _size)
+{
+    table_file_t  entry;
+    table_file_t* file = NULL;
+    cx_path_t     fileName;
+
+    if (fs_is_part((cx_path_t*)_filePath, &entry.number, &entry.duringCompaction))
+    {
+        entry.type = TABLE_FILE_TYPE_PART;
+    }
+    else if (fs_is_dump((cx_path_t*)_filePath, &entry.number, &entry.duringCompaction))
     {
-        file = config_create(_outFile->path);
-        if (NULL != file)
+        entry.type = TABLE_FILE_TYPE_DUMP;
+    }
+    else
+    {
+        return;
+    }
+    entry.size = _size;
+
+    cx_file_get_name(_filePath, false, &fileName);
+
+    pthread_mutex_lock(&_table->catalog->mtx);
+    if (!cx_cdict_get(_table->catalog, fileName, (void**)&file))
+    {
+        file = CX_MEM_STRUCT_ALLOC(file);
+        cx_cdict_set(_table->catalog, fileName, file);
+    }
+    memcpy(file, &entry, sizeof(*file));
+    pthread_mutex_unlock(&_table->catalog->mtx);
+}
+
+static void _fs_catalog_remove(table_t* _table, const cx_path_t* _filePath)
+{
+    table_file_t* file = NULL;
+    cx_path_t     fileName;
+    cx_file_get_name(_filePath, false, &fileName);
+
+    pthread_mutex_lock(&_table->catalog->mtx);
+    if (cx_cdict_tryremove(_table->catalog, fileName, (void**)&file))
+    {
+        free(file);
+    }
+    pthread_mutex_unlock(&_table->catalog->mtx);
+}
+
+static void _fs_catalog_move(table_t* _table, const cx_path_t* _filePathOld, const cx_path_t* _filePathNew)
+{
+    // the contents of a renamed file don't change, so its catalog entry keeps its size.
+    uint32_t      size = 0;
+    table_file_t* file = NULL;
+    cx_path_t     fileName;
+    cx_file_get_name(_filePathOld, false, &fileName);
+
+    pthread_mutex_lock(&_table->catalog->mtx);
+    if (cx_cdict_get(_table->catalog, fileName, (void**)&file))
+    {
+        size = file->size;
+    }
+    pthread_mutex_unlock(&_table->catalog->mtx);
+
+    _fs_catalog_remove(_table, _filePathOld);
+    _fs_catalog_add(_table, _filePathNew, size);
+}
+
+static void _fs_catalog_load(table_t* _table)
+{
+    // rebuilds the catalog of the given table from the files in its directory.
+    // this is the only time we need to explore it, from now on the catalog is kept 
+    // up to date by every operation creating, renaming or deleting table files.
+    cx_err_t  err;
+    cx_path_t filePath;
+    fs_file_t file;
+    uint16_t  number = 0;
+    bool      duringCompaction = false;
+
+    cx_file_explorer_t* exp = fs_table_explorer(_table->meta.name, &err);
+    if (NULL != exp)
+    {
+        while (cx_file_explorer_next_file(exp, &filePath))
         {
-            key = LFS_FILE_PROP_SIZE;
-            if (config_has_property(file, key))
+            if (fs_is_part(&filePath, &number, &duringCompaction) || fs_is_dump(&filePath, &number, &duringCompaction))
             {
-                _outFile->size = (uint32_t)config_get_int_value(file, key);
-            }
-            else
-            {
-                keyMissing = true;
-                goto key_missing;
+                // the descriptor is cached as well, we'll need it as soon as the filters are built.
+                file.size = 0;
+                _fs_file_get(_table->meta.name, &filePath, &file, &err);
+                _fs_catalog_add(_table, &filePath, file.size);
             }
+        }
+        cx_file_explorer_destroy(exp);
+    }
+}
 
-            key = LFS_FILE_PROP_BLOCKS;
-            if (config_has_property(file, key))
-            {
-                char** blocks = config_get_array_value(file, key);
+static int32_t _fs_catalog_comp_dumps(const void* _a, const void* _b, void* _userData)
+{
+    const table_file_t* a = _a;
+    const table_file_t* b = _b;
+
+    // dumps being compacted are older than the regular ones (dump numbers start over once they're
+    // renamed, see fs_table_dump_number_next). within each group, higher numbers are more recent.
+    if (a->duringCompaction != b->duringCompaction) return a->duringCompaction ? -1 : 1;
+    if (a->number == b->number) return 0;
+    return (a->number < b->number) ? -1 : 1;
+}
 
-                uint32_t i = 0, j = 0;
-                bool finished = (NULL == blocks[i]);
-                while (!finished && j < CX_ARR_SIZE(_outFile->blocks))
-                {
-                    cx_str_to_uint32(blocks[i], &(_outFile->blocks[j++]));
-                    free(blocks[i++]);
-                    finished = (NULL == blocks[i]);
-                }
-                free(blocks);
+static bool _fs_parse_file_name(const cx_path_t* _filePath, const char* _prefix, const char* _extension, const char* _extensionCompaction, uint16_t* _outNumber, bool* _outDuringCompaction)
+{
+    // parses file names formatted as [PREFIX][NUMBER].[EXTENSION] (or [EXTENSION_COMPACTION]).
+    uint16_t  number = 0;
+    bool      duringCompaction = false;
+    char*     extension = NULL;
+    cx_path_t fileName;
+    cx_file_get_name(_filePath, false, &fileName);
 
-                CX_CHECK(finished, "there're still pending blocks to read! static buffer of %d elements is not enough!",
-                    CX_ARR_SIZE(_outFile->blocks));
+    if (!cx_str_starts_with(fileName, _prefix, true)) return false;
 
-                _outFile->blocksCount = j;
-            }
-            else
+    extension = strchr(fileName, '.');
+    if (NULL == extension) return false;
+
+    duringCompaction = (0 == strcasecmp(&extension[1], _extensionCompaction));
+    if (!duringCompaction && 0 != strcasecmp(&extension[1], _extension)) return false;
+
+    (*extension) = '\0'; // get rid of the extension truncating at char '.'
+    if (cx_str_to_uint16(&fileName[strlen(_prefix)], &number))
+    {
+        if (NULL != _outNumber) (*_outNumber) = number;
+        if (NULL != _outDuringCompaction) (*_outDuringCompaction) = duringCompaction;
+        return true;
+    }
+    return false;
+}
+
+static bool _fs_file_load(fs_file_t* _outFile, cx_bloom_t** _outFilter, cx_err_t* _err)
+{
+    // metadata files are stored in binary format (see _fs_file_save). files written by older
+    // versions are plain text (SIZE=...\nBLOCKS=[...]) and don't start with our magic number.
+    // the bloom filter stored after the descriptor is only read if _outFilter is not NULL, it gets
+    // the filter (owned by the caller) or NULL if the file doesn't have one.
+    bool     success = false;
+    uint32_t buffSize = LFS_FILE_HEADER_SIZE + sizeof(uint32_t) * (4 + MAX_FILE_FRAG * 4);
+    uint32_t pos = 0;
+    uint32_t u32 = 0;
+    uint32_t oldest[2] = { 0, 0 };
+    uint32_t filter[3] = { 0, 0, 0 };
+    uint32_t filterSize = 0;
+    uint64_t fileSize = 0;
+    uint16_t u16 = 0;
+    uint16_t version = 0;
+    uint32_t framesCount = 0;
+    char*    buff = NULL;
+    int32_t  bytesRead = 0;
+    CX_ERR_CLEAR(_err);
+
+    if (!cx_file_exists(&_outFile->path))
+    {
+        CX_ERR_SET(_err, 1, "File '%s' does not exist.", _outFile->path);
+        return false;
+    }
+
+    // files written by older versions don't know the timestamp of their oldest record.
+    _outFile->oldestTimestamp = 0;
+
+    if (NULL != _outFilter)
+    {
+        (*_outFilter) = NULL;
+        buffSize = cx_math_max(buffSize, cx_file_get_size(&_outFile->path));
+    }
+
+    buff = malloc(buffSize);
+    bytesRead = cx_file_read(&_outFile->path, buff, buffSize, _err);
+
+    if (bytesRead < LFS_FILE_HEADER_SIZE || 0 != memcmp(buff, LFS_FILE_MAGIC, sizeof(LFS_FILE_MAGIC) - 1))
+    {
+        free(buff);
+        return (-1 != bytesRead) && _fs_file_load_text(_outFile, _err);
+    }
+
+    pos = sizeof(LFS_FILE_MAGIC) - 1;
+    memcpy(&u16, &buff[pos], sizeof(u16));
+    pos += sizeof(u16);
+
+    version = le16toh(u16);
+
+    if (version > LFS_FILE_VERSION)
+    {
+        CX_ERR_SET(_err, 1, "File '%s' has an unsupported version %d (latest supported version is %d).", 
+            _outFile->path, version, LFS_FILE_VERSION);
+    }
+    else
+    {
+        memcpy(&u16, &buff[pos], sizeof(u16));
+        pos += sizeof(u16);
+        _outFile->recordFormat = (RECORD_FORMAT)le16toh(u16);
+
+        _fs_file_decode_arr(buff, &pos, &_outFile->size, 1);
+        _fs_file_decode_arr(buff, &pos, &_outFile->blocksCount, 1);
+        _fs_file_decode_arr(buff, &pos, &_outFile->indexCount, 1);
+
+        // version 1 files are always uncompressed.
+        _outFile->compression = COMPRESSION_NONE;
+        if (version >= 2)
+        {
+            _fs_file_decode_arr(buff, &pos, &u32, 1);
+            _outFile->compression = (COMPRESSION)u32;
+        }
+        if (version >= 3)
+        {
+            _fs_file_decode_arr(buff, &pos, oldest, 2);
+            _outFile->oldestTimestamp = (uint64_t)oldest[1] << 32 | oldest[0];
+        }
+        if (version >= 4)
+        {
+            _fs_file_decode_arr(buff, &pos, &filterSize, 1);
+        }
+        framesCount = (COMPRESSION_NONE != _outFile->compression) ? _outFile->blocksCount : 0;
+
+        // we only read the filter if we're asked for it, otherwise our buffer may end before it does.
+        fileSize = (uint64_t)pos + sizeof(uint32_t) * (_outFile->blocksCount + _outFile->indexCount * 2 + framesCount) + filterSize;
+
+        if (_outFile->blocksCount > MAX_FILE_FRAG || _outFile->indexCount > MAX_FILE_FRAG || _outFile->compression > COMPRESSION_LZ
+            || (uint32_t)bytesRead != cx_math_min(fileSize, buffSize))
+        {
+            CX_ERR_SET(_err, 1, "File '%s' is corrupt.", _outFile->path);
+        }
+        else
+        {
+            _fs_file_decode_arr(buff, &pos, _outFile->blocks, _outFile->blocksCount);
+            _fs_file_decode_arr(buff, &pos, _outFile->indexKeys, _outFile->indexCount);
+            _fs_file_decode_arr(buff, &pos, _outFile->indexOffsets, _outFile->indexCount);
+            _fs_file_decode_arr(buff, &pos, _outFile->frames, framesCount);
+
+            // every frame must start where the previous one ends and fit in our decompression buffers.
+            success = (0 == framesCount || 0 == _outFile->frames[0]);
+            for (uint32_t i = 0; success && i < framesCount; i++)
             {
-                keyMissing = true;
-                goto key_missing;
+                success = _outFile->frames[i] <= _fs_file_frame_end(_outFile, i)
+                    && _fs_file_frame_end(_outFile, i) - _outFile->frames[i] <= m_fsCtx->meta.blocksSize * LFS_COMPRESSION_FRAME_BLOCKS;
             }
 
-            success = true;
+            if (!success) CX_ERR_SET(_err, 1, "File '%s' is corrupt. Its frames are out of bounds.", _outFile->path);
 
-        key_missing:
-            if (keyMissing)
+            if (success && NULL != _outFilter && filterSize >= sizeof(filter))
             {
-                CX_ERR_SET(_err, 1, "File '%s' is corrupt. Key '%s' is missing.", _outFile->path, key);
+                _fs_file_decode_arr(buff, &pos, filter, 3);
+                if (filterSize - sizeof(filter) == filter[0] / 8)
+                    (*_outFilter) = cx_bloom_import(filter[0], filter[1], filter[2], (uint8_t*)&buff[pos]);
             }
         }
+    }
+
+    free(buff);
+    return success;
+}
+
+static bool _fs_file_load_text(fs_file_t* _outFile, cx_err_t* _err)
+{
+    bool success = false;
+    char* key = NULL;
+    bool keyMissing = false;
+    t_config* file = NULL;
+    CX_ERR_CLEAR(_err);
+
+    file = config_create(_outFile->path);
+    if (NULL != file)
+    {
+        key = LFS_FILE_PROP_SIZE;
+        if (config_has_property(file, key))
+        {
+            _outFile->size = (uint32_t)config_get_int_value(file, key);
+        }
         else
         {
-            CX_ERR_SET(_err, 1, "File '%s' could not be loaded!", _outFile->path);
+            keyMissing = true;
+            goto key_missing;
+        }
+
+        key = LFS_FILE_PROP_BLOCKS;
+        if (!_fs_file_load_array(file, key, _outFile->blocks, CX_ARR_SIZE(_outFile->blocks), &_outFile->blocksCount))
+        {
+            keyMissing = true;
+            goto key_missing;
+        }
+
+        // optional keys (files created by older versions don't have them)
+        _outFile->compression = COMPRESSION_NONE;
+        _outFile->recordFormat = RECORD_FORMAT_TEXT;
+        key = LFS_FILE_PROP_RECORD_FORMAT;
+        if (config_has_property(file, key) 
+            && 0 == strcasecmp(LFS_RECORD_FORMAT_BINARY, config_get_string_value(file, key)))
+        {
+            _outFile->recordFormat = RECORD_FORMAT_BINARY;
+        }
+
+        uint32_t indexOffsetsCount = 0;
+        if (!_fs_file_load_array(file, LFS_FILE_PROP_INDEX_KEYS, _outFile->indexKeys, CX_ARR_SIZE(_outFile->indexKeys), &_outFile->indexCount)
+            || !_fs_file_load_array(file, LFS_FILE_PROP_INDEX_OFFSETS, _outFile->indexOffsets, CX_ARR_SIZE(_outFile->indexOffsets), &indexOffsetsCount)
+            || indexOffsetsCount != _outFile->indexCount)
+        {
+            // the file is not indexed, lookups will need to load it entirely.
+            _outFile->indexCount = 0;
+        }
+
+        success = true;
+
+    key_missing:
+        if (keyMissing)
+        {
+            CX_ERR_SET(_err, 1, "File '%s' is corrupt. Key '%s' is missing.", _outFile->path, key);
         }
     }
     else
     {
-        CX_ERR_SET(_err, 1, "File '%s' does not exist.", _outFile->path);
+        CX_ERR_SET(_err, 1, "File '%s' could not be loaded!", _outFile->path);
     }
 
     if (NULL != file) config_destroy(file);
     return success;
 }
 
-static bool _fs_file_save(fs_file_t* _file, cx_err_t* _err)
+static bool _fs_file_load_array(t_config* _file, const char* _key, uint32_t* _outArr, uint32_t _arrCapacity, uint32_t* _outCount)
 {
-    bool success = false;
-    t_config* file = NULL;
+    (*_outCount) = 0;
+    if (!config_has_property(_file, (char*)_key)) return false;
+
+    char** values = config_get_array_value(_file, (char*)_key);
+
+    uint32_t i = 0, j = 0;
+    bool finished = (NULL == values[i]);
+    while (!finished && j < _arrCapacity)
+    {
+        cx_str_to_uint32(values[i], &_outArr[j++]);
+        free(values[i++]);
+        finished = (NULL == values[i]);
+    }
+    free(values);
+
+    CX_CHECK(finished, "there're still pending values to read! static buffer of %d elements is not enough!", _arrCapacity);
+
+    (*_outCount) = j;
+    return true;
+}
+
+static bool _fs_file_save(fs_file_t* _file, const cx_bloom_t* _filter, cx_err_t* _err)
+{
+    // serializes the file descriptor as a LFS_FILE_HEADER_SIZE bytes header
+    // [MAGIC][VERSION][RECORD_FORMAT][SIZE][BLOCKS_COUNT][INDEX_COUNT] followed by the compression,
+    // the oldest timestamp (low and high halves), the size of the filter, the blocks, index keys and 
+    // index offsets arrays, the frames array (compressed files only) and the bloom filter of the keys 
+    // of the file [BITS_COUNT][HASH_COUNT][ITEMS_COUNT][BITS] (only if _filter is not NULL).
+    // all the integers are stored in little-endian.
+    // once this function returns true, the file is durable: its blocks are synced before the metadata
+    // is written (so it never points to data which isn't on disk yet) and then the metadata itself.
+    bool     success = false;
+    cx_path_t folderPath;
+    uint32_t compression = (uint32_t)_file->compression;
+    uint32_t oldest[2] = { (uint32_t)_file->oldestTimestamp, (uint32_t)(_file->oldestTimestamp >> 32) };
+    uint32_t filterSize = (NULL != _filter) ? sizeof(uint32_t) * 3 + _filter->bitsCount / 8 : 0;
+    uint32_t framesCount = (COMPRESSION_NONE != _file->compression) ? _file->blocksCount : 0;
+    uint32_t buffSize = LFS_FILE_HEADER_SIZE + sizeof(uint32_t) * (4 + _file->blocksCount + _file->indexCount * 2 + framesCount) + filterSize;
+    uint32_t pos = 0;
+    uint16_t u16 = 0;
+    char*    buff = malloc(buffSize);
     CX_ERR_CLEAR(_err);
-    char temp[32];
 
-    if (cx_file_remove(&_file->path, _err) && cx_file_touch(&_file->path, _err))
+    memcpy(&buff[pos], LFS_FILE_MAGIC, sizeof(LFS_FILE_MAGIC) - 1);
+    pos += sizeof(LFS_FILE_MAGIC) - 1;
+
+    u16 = htole16(LFS_FILE_VERSION);
+    memcpy(&buff[pos], &u16, sizeof(u16));
+    pos += sizeof(u16);
+
+    u16 = htole16((uint16_t)_file->recordFormat);
+    memcpy(&buff[pos], &u16, sizeof(u16));
+    pos += sizeof(u16);
+
+    _fs_file_encode_arr(buff, &pos, &_file->size, 1);
+    _fs_file_encode_arr(buff, &pos, &_file->blocksCount, 1);
+    _fs_file_encode_arr(buff, &pos, &_file->indexCount, 1);
+    _fs_file_encode_arr(buff, &pos, &compression, 1);
+    _fs_file_encode_arr(buff, &pos, oldest, 2);
+    _fs_file_encode_arr(buff, &pos, &filterSize, 1);
+    _fs_file_encode_arr(buff, &pos, _file->blocks, _file->blocksCount);
+    _fs_file_encode_arr(buff, &pos, _file->indexKeys, _file->indexCount);
+    _fs_file_encode_arr(buff, &pos, _file->indexOffsets, _file->indexCount);
+    _fs_file_encode_arr(buff, &pos, _file->frames, framesCount);
+
+    if (NULL != _filter)
     {
-        file = config_create(_file->path);
-        if (NULL != file)
-        {
-            cx_str_from_uint32(_file->size, temp, sizeof(temp));
-            config_set_value(file, LFS_FILE_PROP_SIZE, temp);
+        _fs_file_encode_arr(buff, &pos, &_filter->bitsCount, 1);
+        _fs_file_encode_arr(buff, &pos, &_filter->hashCount, 1);
+        _fs_file_encode_arr(buff, &pos, &_filter->itemsCount, 1);
+        memcpy(&buff[pos], _filter->bits, _filter->bitsCount / 8);
+        pos += _filter->bitsCount / 8;
+    }
 
-            if (_file->blocksCount > 0)
-            {
-                char* buff = cx_str_copy_d("");
-                char* buffPrev = NULL;
-                for (uint32_t i = 0; i < _file->blocksCount; i++)
-                {
-                    cx_str_format(temp, sizeof(temp), ",%d", _file->blocks[i]);
-                    buffPrev = buff;
-                    buff = cx_str_cat_d(buffPrev, temp);
-                    free(buffPrev);
-                }
-                buffPrev = buff;
-                buff = cx_str_format_d("[%s]", &(buffPrev[1]));
+    cx_file_get_path(&_file->path, &folderPath);
+    success = _fs_file_sync_blocks(_file, _err)
+        && cx_file_write(&_file->path, buff, pos, _err)
+        && _fs_path_sync(&_file->path, false, _err)
+        && _fs_path_sync(&folderPath, true, _err);
+    
+    free(buff);
+    return success;
+}
 
-                config_set_value(file, LFS_FILE_PROP_BLOCKS, buff);
+static bool _fs_file_sync_blocks(const fs_file_t* _file, cx_err_t* _err)
+{
+    cx_path_t blockFilePath;
 
-                config_save(file);
-                free(buffPrev);
-                free(buff);
-            }
-            else
-            {
-                config_set_value(file, LFS_FILE_PROP_BLOCKS, "[]");
-            }
+    if (0 == _file->blocksCount) return true;
 
-            success = true;
+    if (BLOCK_STORE_DATAFILE == m_fsCtx->meta.blockStore)
+    {
+        // a single sync of the blocks data file covers every block of the file (and their lengths).
+        if (0 != fdatasync(m_fsCtx->blocksDataFd))
+        {
+            CX_ERR_SET(_err, 1, "blocks data file could not be synced. %s", strerror(errno));
+            return false;
         }
+        return true;
+    }
+
+    for (uint32_t i = 0; i < _file->blocksCount; i++)
+    {
+        _fs_get_block_path(&blockFilePath, _file->blocks[i]);
+        if (!_fs_path_sync(&blockFilePath, false, _err))
+            return false;
+    }
+    return true;
+}
+
+static bool _fs_path_sync(const cx_path_t* _path, bool _isFolder, cx_err_t* _err)
+{
+    // folders are synced as well so that the entries of the files we just created are durable too.
+    int fd = open(*_path, _isFolder ? (O_RDONLY | O_DIRECTORY) : O_RDONLY);
+    if (-1 == fd || 0 != (_isFolder ? fsync(fd) : fdatasync(fd)))
+    {
+        CX_ERR_SET(_err, 1, "'%s' could not be synced. %s", *_path, strerror(errno));
+        if (-1 != fd) close(fd);
+        return false;
+    }
+    close(fd);
+    return true;
+}
+
+static void _fs_file_encode_arr(char* _buff, uint32_t* _inOutPos, const uint32_t* _arr, uint32_t _count)
+{
+    uint32_t u32 = 0;
+    for (uint32_t i = 0; i < _count; i++)
+    {
+        u32 = htole32(_arr[i]);
+        memcpy(&_buff[*_inOutPos], &u32, sizeof(u32));
+        (*_inOutPos) += sizeof(u32);
+    }
+}
+
+static void _fs_file_decode_arr(const char* _buff, uint32_t* _inOutPos, uint32_t* _outArr, uint32_t _count)
+{
+    uint32_t u32 = 0;
+    for (uint32_t i = 0; i < _count; i++)
+    {
+        memcpy(&u32, &_buff[*_inOutPos], sizeof(u32));
+        _outArr[i] = le32toh(u32);
+        (*_inOutPos) += sizeof(u32);
+    }
+}
+
+static uint32_t _fs_file_frame_find(const fs_file_t* _file, uint32_t _offset)
+{
+    // returns the index of the frame containing the given byte _offset of the file
+    // (the last frame starting at or before it).
+    uint32_t lo = 0;
+    uint32_t hi = _file->blocksCount;
+    uint32_t mid = 0;
+
+    while (hi - lo > 1)
+    {
+        mid = lo + (hi - lo) / 2;
+        if (_file->frames[mid] <= _offset)
+            lo = mid;
         else
+            hi = mid;
+    }
+
+    return lo;
+}
+
+static uint32_t _fs_file_frame_end(const fs_file_t* _file, uint32_t _frameIndex)
+{
+    return (_frameIndex + 1 < _file->blocksCount) ? _file->frames[_frameIndex + 1] : _file->size;
+}
+
+static bool _fs_file_frame_read(const fs_file_t* _file, uint32_t _frameIndex, char* _block, char* _buffer, cx_err_t* _err)
+{
+    // reads the compressed frame stored in the given block of the file and decompresses 
+    // it into _buffer. _block must have room for a block and _buffer for the whole frame.
+    uint32_t frameSize = _fs_file_frame_end(_file, _frameIndex) - _file->frames[_frameIndex];
+    int32_t  bytesRead = fs_block_read(_file->blocks[_frameIndex], _block, _err);
+
+    if (-1 == bytesRead)
+    {
+        CX_ERR_SET(_err, 1, "block #%d could not be read!", _file->blocks[_frameIndex]);
+        return false;
+    }
+
+    if ((int32_t)frameSize != cx_lz_decompress(_block, (uint32_t)bytesRead, _buffer, frameSize))
+    {
+        CX_ERR_SET(_err, 1, "block #%d is corrupt! (it does not decompress into %d bytes)", 
+            _file->blocks[_frameIndex], frameSize);
+        return false;
+    }
+
+    return true;
+}
+
+static bool _fs_file_read_range_frames(fs_file_t* _file, uint32_t _offset, uint32_t _size, char* _buffer, cx_err_t* _err)
+{
+    // same as fs_file_read_range but for compressed files. every frame overlapping 
+    // with the requested range is decompressed and the slice we need is copied.
+    bool     success = true;
+    uint32_t blockSize = m_fsCtx->meta.blocksSize;
+    uint32_t buffPos = 0;
+    uint32_t frameIndex = _fs_file_frame_find(_file, _offset);
+    uint32_t framePos = _offset - _file->frames[frameIndex];
+    uint32_t bytesNeeded = 0;
+    char*    block = malloc(blockSize);
+    char*    frame = malloc(blockSize * LFS_COMPRESSION_FRAME_BLOCKS);
+
+    for (uint32_t i = frameIndex; buffPos < _size && i < _file->blocksCount; i++)
+    {
+        if (!_fs_file_frame_read(_file, i, block, frame, _err))
         {
-            CX_ERR_SET(_err, 1, "file '%s' could not be loaded!", _file->path);
+            success = false;
+            break;
         }
+
+        bytesNeeded = cx_math_min(_size - buffPos, _fs_file_frame_end(_file, i) - _file->frames[i] - framePos);
+        memcpy(&_buffer[buffPos], &frame[framePos], bytesNeeded);
+        buffPos += bytesNeeded;
+        framePos = 0;
+    }
+
+    free(block);
+    free(frame);
+
+    if (success && buffPos != _size)
+    {
+        CX_ERR_SET(_err, 1, "range is not fully loaded! (size is %d but we read %d)", _size, buffPos);
+        success = false;
     }
 
-    if (NULL != file) config_destroy(file);
     return success;
 }
 
@@ -1275,4 +2591,50 @@ static void _fs_get_block_path(cx_path_t* _outFilePath, uint32_t _blockNumber)
 {
     cx_file_path(_outFilePath, "%s/%s/%s%d.%s", m_fsCtx->rootDir, LFS_DIR_BLOCKS,
         LFS_BLOCK_PREFIX, _blockNumber, LFS_BLOCK_EXTENSION);
-}
\ No newline at end of file
+}
+
+static off_t _fs_get_block_offset(uint32_t _blockNumber)
+{
+    // blocks data is stored right after the header containing the length of each block.
+    return (off_t)m_fsCtx->meta.blocksCount * sizeof(uint32_t) + (off_t)_blockNumber * m_fsCtx->meta.blocksSize;
+}
+
+static int32_t _fs_block_data_read(uint32_t _blockNumber, char* _buffer, cx_err_t* _err)
+{
+    CX_CHECK(_blockNumber < m_fsCtx->meta.blocksCount, "invalid block number #%d!", _blockNumber);
+
+    uint32_t length = m_fsCtx->blocksLength[_blockNumber];
+    if (0 == length) return 0;
+
+    if ((ssize_t)length != pread(m_fsCtx->blocksDataFd, _buffer, length, _fs_get_block_offset(_blockNumber)))
+    {
+        CX_ERR_SET(_err, 1, "block #%d could not be read from the blocks data file. %s", _blockNumber, strerror(errno));
+        return -1;
+    }
+    return (int32_t)length;
+}
+
+static bool _fs_block_data_write(uint32_t _blockNumber, const char* _buffer, uint32_t _bufferSize, cx_err_t* _err)
+{
+    CX_CHECK(_blockNumber < m_fsCtx->meta.blocksCount, "invalid block number #%d!", _blockNumber);
+
+    if (NULL == _buffer) _bufferSize = 0;
+
+    if (_bufferSize > 0
+        && (ssize_t)_bufferSize != pwrite(m_fsCtx->blocksDataFd, _buffer, _bufferSize, _fs_get_block_offset(_blockNumber)))
+    {
+        CX_ERR_SET(_err, 1, "block #%d could not be written to the blocks data file. %s", _blockNumber, strerror(errno));
+        return false;
+    }
+
+    // the length goes last, so a failed write never exposes partially written data.
+    if ((ssize_t)sizeof(_bufferSize) != pwrite(m_fsCtx->blocksDataFd, &_bufferSize, sizeof(_bufferSize), 
+        (off_t)_blockNumber * sizeof(uint32_t)))
+    {
+        CX_ERR_SET(_err, 1, "block #%d length could not be written to the blocks data file. %s", _blockNumber, strerror(errno));
+        return false;
+    }
+
+    m_fsCtx->blocksLength[_blockNumber] = _bufferSize;
+    return true;
+}
@@ -15,7 +15,7 @@
  ***  PUBLIC FUNCTIONS
  ***************************************************************************************/
 
-bool                fs_init(const char* _rootDir, uint32_t _blocksCount, uint32_t _blocksSize, cx_err_t* _err);
+bool                fs_init(const char* _rootDir, uint32_t _blocksCount, uint32_t _blocksSize, uint32_t _blockCacheSize, cx_err_t* _err);
 
 void                fs_destroy();
 
@@ -35,7 +35,7 @@ bool                fs_table_avail_guard_begin(const char* _tableName, cx_err_t*
 
 void                fs_table_avail_guard_end(table_t* _table);
 
-bool                fs_table_create(table_t** _outTable, const char* _tableName, uint8_t _consistency, uint16_t _partitions, uint32_t _compactionInterval, cx_err_t* _err);
+bool                fs_table_create(table_t** _outTable, const char* _tableName, uint8_t _consistency, uint16_t _partitions, uint32_t _compactionInterval, uint32_t _ttl, cx_err_t* _err);
 
 bool                fs_table_delete(const char* _tableName, table_t** _outTable, cx_err_t* _err);
 
@@ -43,19 +43,23 @@ bool                fs_table_meta_get(const char* _tableName, table_meta_t* _out
 
 bool                fs_table_part_get(const char* _tableName, uint16_t _partNumber, bool _isDuringCompaction, fs_file_t* _outFile, cx_err_t* _err);
 
-bool                fs_table_part_set(const char* _tableName, uint16_t _partNumber, bool _isDuringCompaction, fs_file_t* _file, cx_err_t* _err);
+bool                fs_table_part_set(const char* _tableName, uint16_t _partNumber, bool _isDuringCompaction, fs_file_t* _file, cx_bloom_t* _filter, cx_err_t* _err);
 
 bool                fs_table_part_delete(const char* _tableName, uint16_t _partNumber, bool _isDuringCompaction, cx_err_t* _err);
 
 bool                fs_table_dump_get(const char* _tableName, uint16_t _dumpNumber, bool _isDuringCompaction, fs_file_t* _outFile, cx_err_t* _err);
 
-bool                fs_table_dump_set(const char* _tableName, uint16_t _dumpNumber, bool _isDuringCompaction, fs_file_t* _file, cx_err_t* _err);
+bool                fs_table_dump_set(const char* _tableName, uint16_t _dumpNumber, bool _isDuringCompaction, fs_file_t* _file, cx_bloom_t* _filter, cx_err_t* _err);
 
 bool                fs_table_dump_delete(const char* _tableName, uint16_t _dumpNumber, bool _isDuringCompaction, cx_err_t* _err);
 
 uint16_t            fs_table_dump_number_next(const char* _tableName);
 
-bool                fs_table_dump_tryenqueue();
+table_file_t*       fs_table_dump_list(table_t* _table, uint32_t* _outDumpsCount);
+
+void                fs_table_dump_stats(table_t* _table, uint32_t* _outDumpsCount, uint64_t* _outDumpsSize);
+
+bool                fs_table_dump_tryenqueue(uint16_t* _outDumpsCount);
 
 bool                fs_table_compact_tryenqueue(const char* _tableName);
 
@@ -65,22 +69,48 @@ void                fs_table_unblock(table_t* _table, double* _blockedTime);
 
 void                fs_table_free(table_t* _table);
 
+void                fs_table_filter_set(table_t* _table, const cx_path_t* _filePath, cx_bloom_t* _filter);
+
+void                fs_table_filter_move(table_t* _table, const cx_path_t* _filePathOld, const cx_path_t* _filePathNew);
+
+bool                fs_table_file_move(table_t* _table, const cx_path_t* _filePathOld, const cx_path_t* _filePathNew, cx_err_t* _err);
+
+bool                fs_table_part_may_contain(table_t* _table, uint16_t _partNumber, bool _isDuringCompaction, uint16_t _key);
+
+bool                fs_table_dump_may_contain(table_t* _table, uint16_t _dumpNumber, bool _isDuringCompaction, uint16_t _key);
+
 cx_file_explorer_t* fs_table_explorer(const char* _tableName, cx_err_t* _err);
 
 uint32_t            fs_block_alloc(uint32_t _blocksCount, uint32_t* _outBlocksArr);
 
+uint32_t            fs_block_alloc_extent(uint32_t _blocksCount, uint32_t* _outBlocksArr);
+
 void                fs_block_free(uint32_t* _blocksArr, uint32_t _blocksCount);
 
+bool                fs_block_sync();
+
 int32_t             fs_block_read(uint32_t _blockNumber, char* _buffer, cx_err_t* _err);
 
 bool                fs_block_write(uint32_t _blockNumber, char* _buffer, uint32_t _bufferSize, cx_err_t* _err);
 
 uint32_t            fs_block_size();
 
+RECORD_FORMAT       fs_record_format();
+
+COMPRESSION         fs_compression();
+
+void                fs_block_cache_stats(uint64_t* _outHits, uint64_t* _outMisses, uint32_t* _outCapacity);
+
 bool                fs_file_read(fs_file_t* _file, char* _buffer, cx_err_t* _err);
 
+bool                fs_file_read_range(fs_file_t* _file, uint32_t _offset, uint32_t _size, char* _buffer, cx_err_t* _err);
+
+uint32_t            fs_file_chunk_end(const fs_file_t* _file, uint32_t _offset);
+
 bool                fs_file_delete(fs_file_t* _file, cx_err_t* _err);
 
 bool                fs_is_dump(cx_path_t* _filePath, uint16_t* _outDumpNumber, bool* _outDuringCompaction);
 
+bool                fs_is_part(cx_path_t* _filePath, uint16_t* _outPartNumber, bool* _outDuringCompaction);
+
 #endif // LFS_FS_H_
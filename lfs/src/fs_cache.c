@@ -0,0 +1,286 @@
+#include "fs_cache.h"
+
+#include <cx/mem.h>
+#include <cx/math.h>
+
+#include <string.h>
+#include <pthread.h>
+
+#define FS_CACHE_SHARDS     16      // number of independent shards (each one with its own lock).
+#define FS_CACHE_NONE       -1      // invalid slot index.
+
+typedef struct fs_cache_slot_t
+{
+    uint32_t            blockNumber;            // number of the block cached in this slot.
+    uint32_t            size;                   // number of valid bytes in the slot data.
+    int32_t             next;                   // index of the next slot in the same hash bucket chain.
+    bool                used;                   // true if this slot is holding a block.
+    bool                referenced;             // CLOCK reference bit. set on every hit, cleared when the hand passes by.
+} fs_cache_slot_t;
+
+typedef struct fs_cache_shard_t
+{
+    pthread_mutex_t     mtx;                    // mutex for syncing operations on this shard.
+    fs_cache_slot_t*    slots;                  // array of slotsCount slots.
+    uint32_t            slotsCount;             // number of slots (blocks) this shard can hold.
+    char*               data;                   // buffer of slotsCount * blockSize bytes holding the contents of each slot.
+    int32_t*            buckets;                // hash table mapping block numbers to chains of slots.
+    uint32_t            bucketsCount;           // number of buckets in our hash table (power of two).
+    uint32_t            hand;                   // CLOCK hand. next slot candidate to be evicted.
+    uint32_t            invalidations;          // number of invalidations performed. used to discard stale puts.
+    uint64_t            hits;                   // number of lookups found in this shard.
+    uint64_t            misses;                 // number of lookups not found in this shard.
+} fs_cache_shard_t;
+
+typedef struct fs_cache_ctx_t
+{
+    uint32_t            blockSize;              // size in bytes of each block.
+    uint32_t            capacity;               // total number of blocks that fit in the cache.
+    fs_cache_shard_t    shards[FS_CACHE_SHARDS];// independent shards. blocks are assigned by blockNumber % FS_CACHE_SHARDS.
+} fs_cache_ctx_t;
+
+static fs_cache_ctx_t* m_cacheCtx = NULL;      // private block cache context
+
+/****************************************************************************************
+ ***  PRIVATE DECLARATIONS
+ ***************************************************************************************/
+
+static int32_t      _fs_cache_find(fs_cache_shard_t* _shard, uint32_t _blockNumber, int32_t* _outPrev);
+
+static void         _fs_cache_unlink(fs_cache_shard_t* _shard, int32_t _slot);
+
+static uint32_t     _fs_cache_evict(fs_cache_shard_t* _shard);
+
+/****************************************************************************************
+ ***  PUBLIC FUNCTIONS
+ ***************************************************************************************/
+
+bool fs_cache_init(uint32_t _cacheSize, uint32_t _blockSize, cx_err_t* _err)
+{
+    CX_CHECK(NULL == m_cacheCtx, "fs cache is already initialized!");
+    CX_CHECK(_blockSize > 0, "_blockSize must be greater than zero!");
+
+    uint32_t capacity = _cacheSize / _blockSize;
+    if (capacity < FS_CACHE_SHARDS)
+    {
+        // not even one block per shard. the cache is disabled.
+        CX_INFO("block cache disabled.");
+        return true;
+    }
+
+    m_cacheCtx = CX_MEM_STRUCT_ALLOC(m_cacheCtx);
+    m_cacheCtx->blockSize = _blockSize;
+    m_cacheCtx->capacity = 0;
+
+    for (uint32_t i = 0; i < FS_CACHE_SHARDS; i++)
+    {
+        fs_cache_shard_t* shard = &m_cacheCtx->shards[i];
+        shard->slotsCount = capacity / FS_CACHE_SHARDS;
+        
+        shard->bucketsCount = 1;
+        while (shard->bucketsCount < shard->slotsCount * 2) shard->bucketsCount <<= 1;
+
+        shard->slots = CX_MEM_ARR_ALLOC(shard->slots, shard->slotsCount);
+        shard->buckets = malloc(shard->bucketsCount * sizeof(*shard->buckets));
+        shard->data = malloc((size_t)shard->slotsCount * _blockSize);
+
+        if (NULL == shard->slots || NULL == shard->buckets || NULL == shard->data
+            || 0 != pthread_mutex_init(&shard->mtx, NULL))
+        {
+            CX_ERR_SET(_err, 1, "block cache shard #%d initialization failed!", i);
+            fs_cache_destroy();
+            return false;
+        }
+
+        memset(shard->buckets, 0xFF, shard->bucketsCount * sizeof(*shard->buckets)); // FS_CACHE_NONE
+        m_cacheCtx->capacity += shard->slotsCount;
+    }
+
+    CX_INFO("block cache initialized with %d blocks (%d bytes).", m_cacheCtx->capacity, m_cacheCtx->capacity * _blockSize);
+    return true;
+}
+
+void fs_cache_destroy()
+{
+    if (NULL == m_cacheCtx) return;
+
+    for (uint32_t i = 0; i < FS_CACHE_SHARDS; i++)
+    {
+        fs_cache_shard_t* shard = &m_cacheCtx->shards[i];
+        if (NULL != shard->slots)
+        {
+            pthread_mutex_destroy(&shard->mtx);
+        }
+        free(shard->slots);
+        free(shard->buckets);
+        free(shard->data);
+    }
+
+    free(m_cacheCtx);
+    m_cacheCtx = NULL;
+}
+
+bool fs_cache_enabled()
+{
+    return NULL != m_cacheCtx;
+}
+
+int32_t fs_cache_get(uint32_t _blockNumber, char* _buffer, uint32_t* _outTicket)
+{
+    // copies the cached block contents into _buffer returning the amount of bytes copied.
+    // returns -1 on a miss. in that case _outTicket must be given back to fs_cache_put
+    // once the block is read from disk so that we never cache contents invalidated meanwhile.
+
+    if (NULL == m_cacheCtx) return -1;
+
+    fs_cache_shard_t* shard = &m_cacheCtx->shards[_blockNumber % FS_CACHE_SHARDS];
+    int32_t result = -1;
+
+    pthread_mutex_lock(&shard->mtx);
+    int32_t slot = _fs_cache_find(shard, _blockNumber, NULL);
+    if (FS_CACHE_NONE != slot)
+    {
+        shard->slots[slot].referenced = true;
+        result = (int32_t)shard->slots[slot].size;
+        memcpy(_buffer, &shard->data[(size_t)slot * m_cacheCtx->blockSize], shard->slots[slot].size);
+        shard->hits++;
+    }
+    else
+    {
+        shard->misses++;
+    }
+    
+    if (NULL != _outTicket) (*_outTicket) = shard->invalidations;
+    pthread_mutex_unlock(&shard->mtx);
+
+    return result;
+}
+
+void fs_cache_put(uint32_t _blockNumber, const char* _buffer, uint32_t _size, uint32_t _ticket)
+{
+    if (NULL == m_cacheCtx) return;
+
+    CX_CHECK(_size <= m_cacheCtx->blockSize, "_size must be less than or equal to blockSize (%d bytes)!", m_cacheCtx->blockSize);
+
+    fs_cache_shard_t* shard = &m_cacheCtx->shards[_blockNumber % FS_CACHE_SHARDS];
+
+    pthread_mutex_lock(&shard->mtx);
+    if (_ticket == shard->invalidations && FS_CACHE_NONE == _fs_cache_find(shard, _blockNumber, NULL))
+    {
+        uint32_t slot = _fs_cache_evict(shard);
+        uint32_t bucket = (_blockNumber / FS_CACHE_SHARDS) & (shard->bucketsCount - 1);
+
+        shard->slots[slot].blockNumber = _blockNumber;
+        shard->slots[slot].size = _size;
+        shard->slots[slot].used = true;
+        shard->slots[slot].referenced = false;
+        shard->slots[slot].next = shard->buckets[bucket];
+        shard->buckets[bucket] = (int32_t)slot;
+        memcpy(&shard->data[(size_t)slot * m_cacheCtx->blockSize], _buffer, _size);
+    }
+    pthread_mutex_unlock(&shard->mtx);
+}
+
+void fs_cache_invalidate(uint32_t _blockNumber)
+{
+    if (NULL == m_cacheCtx) return;
+
+    fs_cache_shard_t* shard = &m_cacheCtx->shards[_blockNumber % FS_CACHE_SHARDS];
+
+    pthread_mutex_lock(&shard->mtx);
+    int32_t slot = _fs_cache_find(shard, _blockNumber, NULL);
+    if (FS_CACHE_NONE != slot)
+    {
+        _fs_cache_unlink(shard, slot);
+    }
+    shard->invalidations++;
+    pthread_mutex_unlock(&shard->mtx);
+}
+
+void fs_cache_stats(uint64_t* _outHits, uint64_t* _outMisses, uint32_t* _outCapacity)
+{
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+
+    if (NULL != m_cacheCtx)
+    {
+        for (uint32_t i = 0; i < FS_CACHE_SHARDS; i++)
+        {
+            pthread_mutex_lock(&m_cacheCtx->shards[i].mtx);
+            hits += m_cacheCtx->shards[i].hits;
+            misses += m_cacheCtx->shards[i].misses;
+            pthread_mutex_unlock(&m_cacheCtx->shards[i].mtx);
+        }
+    }
+
+    if (NULL != _outHits) (*_outHits) = hits;
+    if (NULL != _outMisses) (*_outMisses) = misses;
+    if (NULL != _outCapacity) (*_outCapacity) = (NULL != m_cacheCtx) ? m_cacheCtx->capacity : 0;
+}
+
+/****************************************************************************************
+ ***  PRIVATE FUNCTIONS
+ ***************************************************************************************/
+
+static int32_t _fs_cache_find(fs_cache_shard_t* _shard, uint32_t _blockNumber, int32_t* _outPrev)
+{
+    int32_t prev = FS_CACHE_NONE;
+    // every block of this shard has the same remainder modulo FS_CACHE_SHARDS, so those 
+    // low bits are dropped before hashing or most of the buckets would never be used.
+    int32_t slot = _shard->buckets[(_blockNumber / FS_CACHE_SHARDS) & (_shard->bucketsCount - 1)];
+
+    while (FS_CACHE_NONE != slot && _shard->slots[slot].blockNumber != _blockNumber)
+    {
+        prev = slot;
+        slot = _shard->slots[slot].next;
+    }
+
+    if (NULL != _outPrev) (*_outPrev) = prev;
+    return slot;
+}
+
+static void _fs_cache_unlink(fs_cache_shard_t* _shard, int32_t _slot)
+{
+    // removes the given slot from its hash bucket chain and marks it as free.
+    int32_t prev = FS_CACHE_NONE;
+    _fs_cache_find(_shard, _shard->slots[_slot].blockNumber, &prev);
+
+    if (FS_CACHE_NONE == prev)
+    {
+        _shard->buckets[(_shard->slots[_slot].blockNumber / FS_CACHE_SHARDS) & (_shard->bucketsCount - 1)] = _shard->slots[_slot].next;
+    }
+    else
+    {
+        _shard->slots[prev].next = _shard->slots[_slot].next;
+    }
+
+    _shard->slots[_slot].used = false;
+    _shard->slots[_slot].referenced = false;
+    _shard->slots[_slot].next = FS_CACHE_NONE;
+}
+
+static uint32_t _fs_cache_evict(fs_cache_shard_t* _shard)
+{
+    // CLOCK eviction: advance the hand giving a second chance to every referenced slot
+    // until we find a free slot or one which was not referenced since the last pass.
+    uint32_t slot = 0;
+
+    while (true)
+    {
+        slot = _shard->hand;
+        _shard->hand = (_shard->hand + 1) % _shard->slotsCount;
+
+        if (!_shard->slots[slot].used)
+            return slot;
+
+        if (_shard->slots[slot].referenced)
+        {
+            _shard->slots[slot].referenced = false;
+        }
+        else
+        {
+            _fs_cache_unlink(_shard, (int32_t)slot);
+            return slot;
+        }
+    }
+}
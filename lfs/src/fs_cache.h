@@ -0,0 +1,27 @@
+#ifndef LFS_FS_CACHE_H_
+#define LFS_FS_CACHE_H_
+
+#include <cx/cx.h>
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/****************************************************************************************
+ ***  PUBLIC FUNCTIONS
+ ***************************************************************************************/
+
+bool                fs_cache_init(uint32_t _cacheSize, uint32_t _blockSize, cx_err_t* _err);
+
+void                fs_cache_destroy();
+
+bool                fs_cache_enabled();
+
+int32_t             fs_cache_get(uint32_t _blockNumber, char* _buffer, uint32_t* _outTicket);
+
+void                fs_cache_put(uint32_t _blockNumber, const char* _buffer, uint32_t _size, uint32_t _ticket);
+
+void                fs_cache_invalidate(uint32_t _blockNumber);
+
+void                fs_cache_stats(uint64_t* _outHits, uint64_t* _outMisses, uint32_t* _outCapacity);
+
+#endif // LFS_FS_CACHE_H_
@@ -2,6 +2,8 @@
 #include "memtable.h"
 #include "lfs_worker.h"
 #include "fs.h"
+#include "wal.h"
+#include "row_cache.h"
 
 #include <ker/cli_parser.h>
 #include <ker/reporter.h>
@@ -27,7 +29,9 @@
 
 #include <stdio.h>
 #include <string.h>
+#include <strings.h>
 #include <unistd.h>
+#include <inttypes.h>
 
 #ifdef DEBUG
 #define OUTPUT_LOG_ENABLED false
@@ -35,6 +39,8 @@
 #define OUTPUT_LOG_ENABLED true
 #endif 
 
+#define API_RESPONSE_TIMEOUT    5000    // milliseconds we wait for a client to make room for the next chunk of a response.
+
 lfs_ctx_t           g_ctx;                                  // global LFS context
 
 /****************************************************************************************
@@ -59,11 +65,18 @@ static bool         task_completed(task_t* _task);
 static bool         task_free(task_t* _task);
 static bool         task_reschedule(task_t* _task);
 
+static bool         compaction_needed(table_t* _table, bool _intervalElapsed);
+
 static void         api_response_create(const task_t* _task);
 static void         api_response_drop(const task_t* _task);
 static void         api_response_describe(const task_t* _task);
 static void         api_response_select(const task_t* _task);
 static void         api_response_insert(const task_t* _task);
+static void         api_response_delete(const task_t* _task);
+static void         api_response_select_batch(const task_t* _task);
+static void         api_response_insert_batch(const task_t* _task);
+static void         api_response_scan(const task_t* _task);
+static bool         api_response_chunk(uint8_t _header, uint32_t _payloadSize, const task_t* _task);
 
 static bool         on_connection_mem(cx_net_ctx_sv_t* _ctx, const ipv4_t _ipv4);
 static void         on_disconnection_mem(cx_net_ctx_sv_t* _ctx, cx_net_client_t* _client);
@@ -161,6 +174,7 @@ int main(int _argc, char** _argv)
 static bool cfg_load(const char* _cfgFilePath, cx_err_t* _err)
 {
     char* key = "";
+    char temp[32];
     bool isReloading = false;
 
     if (!g_ctx.cfgInitialized)
@@ -205,6 +219,14 @@ static bool cfg_load(const char* _cfgFilePath, cx_err_t* _err)
 
             key = LFS_CFG_VALUE_SIZE;
             if (!cfg_get_uint16(cfg, key, &g_ctx.cfg.valueSize)) goto key_missing;
+
+            // optional. (defaults to LFS_BLOCK_CACHE_SIZE_DEFAULT)
+            key = LFS_CFG_BLOCK_CACHE_SIZE;
+            if (!cfg_get_uint32(cfg, key, &g_ctx.cfg.blockCacheSize)) g_ctx.cfg.blockCacheSize = LFS_BLOCK_CACHE_SIZE_DEFAULT;
+
+            // optional. (defaults to LFS_ROW_CACHE_SIZE_DEFAULT)
+            key = LFS_CFG_ROW_CACHE_SIZE;
+            if (!cfg_get_uint32(cfg, key, &g_ctx.cfg.rowCacheSize)) g_ctx.cfg.rowCacheSize = LFS_ROW_CACHE_SIZE_DEFAULT;
         }
 
         ////////////////////////////////////////////////////////////////////////////////////////
@@ -215,6 +237,33 @@ static bool cfg_load(const char* _cfgFilePath, cx_err_t* _err)
         key = LFS_CFG_INT_DUMP;
         if (!cfg_get_uint32(cfg, key, &g_ctx.cfg.dumpInterval)) goto key_missing;
 
+        // optional. (defaults to the number of workers)
+        key = LFS_CFG_COMPACTION_PARALLELISM;
+        if (!cfg_get_uint16(cfg, key, &g_ctx.cfg.compactionParallelism)) g_ctx.cfg.compactionParallelism = g_ctx.cfg.workers;
+
+        // optional. (defaults to COMPACTION_POLICY_INTERVAL)
+        key = LFS_CFG_COMPACTION_POLICY;
+        g_ctx.cfg.compactionPolicy = COMPACTION_POLICY_INTERVAL;
+        if (cfg_get_string(cfg, key, temp, sizeof(temp)))
+        {
+            if (0 == strcasecmp(temp, LFS_COMPACTION_POLICY_TIERED))
+            {
+                g_ctx.cfg.compactionPolicy = COMPACTION_POLICY_TIERED;
+            }
+            else if (0 != strcasecmp(temp, LFS_COMPACTION_POLICY_INTERVAL))
+            {
+                CX_WARN(CX_ALW, "unknown compaction policy '%s'. falling back to %s.", temp, LFS_COMPACTION_POLICY_INTERVAL);
+            }
+        }
+
+        // optional. (defaults to LFS_COMPACTION_DUMPS_DEFAULT)
+        key = LFS_CFG_COMPACTION_MIN_DUMPS;
+        if (!cfg_get_uint16(cfg, key, &g_ctx.cfg.compactionMinDumps)) g_ctx.cfg.compactionMinDumps = LFS_COMPACTION_DUMPS_DEFAULT;
+
+        // optional. (defaults to zero, the size of the dumps is not taken into account)
+        key = LFS_CFG_COMPACTION_MIN_BYTES;
+        if (!cfg_get_uint32(cfg, key, &g_ctx.cfg.compactionMinBytes)) g_ctx.cfg.compactionMinBytes = 0;
+
         config_destroy(cfg);
         return true;
 
@@ -248,7 +297,7 @@ static bool lfs_init(cx_err_t* _err)
         return false;
     }
 
-    return fs_init(g_ctx.cfg.rootDir, g_ctx.cfg.blocksCount, g_ctx.cfg.blocksSize, _err);
+    return fs_init(g_ctx.cfg.rootDir, g_ctx.cfg.blocksCount, g_ctx.cfg.blocksSize, g_ctx.cfg.blockCacheSize, _err);
 }
 
 static void lfs_destroy()
@@ -287,6 +336,10 @@ static bool net_init(cx_err_t* _err)
     svCtxArgs.msgHandlers[LFSP_REQ_DESCRIBE] = (cx_net_handler_cb)lfs_handle_req_describe;
     svCtxArgs.msgHandlers[LFSP_REQ_SELECT] = (cx_net_handler_cb)lfs_handle_req_select;
     svCtxArgs.msgHandlers[LFSP_REQ_INSERT] = (cx_net_handler_cb)lfs_handle_req_insert;
+    svCtxArgs.msgHandlers[LFSP_REQ_DELETE] = (cx_net_handler_cb)lfs_handle_req_delete;
+    svCtxArgs.msgHandlers[LFSP_REQ_SELECT_BATCH] = (cx_net_handler_cb)lfs_handle_req_select_batch;
+    svCtxArgs.msgHandlers[LFSP_REQ_INSERT_BATCH] = (cx_net_handler_cb)lfs_handle_req_insert_batch;
+    svCtxArgs.msgHandlers[LFSP_REQ_SCAN] = (cx_net_handler_cb)lfs_handle_req_scan;
 
     // start server context and start listening for requests
     g_ctx.sv = cx_net_listen(&svCtxArgs);
@@ -322,7 +375,12 @@ static void handle_cli_command(const cx_cli_cmd_t* _cmd)
     uint8_t     consistency = 0;
     uint16_t    numPartitions = 0;
     uint32_t    compactionInterval = 0;
+    uint32_t    ttl = 0;
     uint32_t    packetSize = 0;
+    table_record_t* records = NULL;
+    uint16_t    recordsCount = 0;
+    uint16_t    partition = 0;
+    uint16_t    keyMax = 0;
 
     if (QUERY_EXIT == query)
     {
@@ -341,11 +399,48 @@ static void handle_cli_command(const cx_cli_cmd_t* _cmd)
         }
         cx_cli_command_end();
     }
+    else if (QUERY_METRICS == query)
+    {
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+        uint32_t capacity = 0;
+        char     info[256];
+
+        fs_block_cache_stats(&hits, &misses, &capacity);
+        cx_str_format(info, sizeof(info), "block cache: %" PRIu64 " hits, %" PRIu64 " misses, %.2f%% hit ratio (capacity: %u blocks).",
+            hits, misses, (hits + misses) > 0 ? (100.0 * hits / (hits + misses)) : 0.0, capacity);
+        report_info(info, stdout);
+
+        uint16_t      tablesCount = 0;
+        table_meta_t* tables = fs_describe(&tablesCount, &err);
+        table_t*      table = NULL;
+        uint32_t      dumpsCount = 0;
+        uint64_t      dumpsSize = 0;
+
+        for (uint16_t i = 0; i < tablesCount; i++)
+        {
+            if (fs_table_exists(tables[i].name, &table))
+            {
+                fs_table_dump_stats(table, &dumpsCount, &dumpsSize);
+                cx_str_format(info, sizeof(info), "table '%s': %u dumps awaiting compaction (%" PRIu64 " bytes).",
+                    tables[i].name, dumpsCount, dumpsSize);
+                report_info(info, stdout);
+
+                row_cache_stats(table->rowCache, &hits, &misses, &capacity);
+                cx_str_format(info, sizeof(info), "table '%s': row cache %" PRIu64 " hits, %" PRIu64 " misses, %.2f%% hit ratio (capacity: %u rows).",
+                    tables[i].name, hits, misses, (hits + misses) > 0 ? (100.0 * hits / (hits + misses)) : 0.0, capacity);
+                report_info(info, stdout);
+            }
+        }
+        if (NULL != tables) free(tables);
+
+        cx_cli_command_end();
+    }
     else if (QUERY_CREATE == query)
     {
-        if (cli_parse_create(_cmd, &err, &tableName, &consistency, &numPartitions, &compactionInterval))
+        if (cli_parse_create(_cmd, &err, &tableName, &consistency, &numPartitions, &compactionInterval, &ttl))
         {
-            packetSize = lfs_pack_req_create(g_ctx.buff1, sizeof(g_ctx.buff1), 0, tableName, consistency, numPartitions, compactionInterval);
+            packetSize = lfs_pack_req_create(g_ctx.buff1, sizeof(g_ctx.buff1), 0, tableName, consistency, numPartitions, compactionInterval, ttl);
             lfs_handle_req_create((cx_net_common_t*)g_ctx.sv, NULL, g_ctx.buff1, packetSize);
         }
     }
@@ -365,6 +460,43 @@ static void handle_cli_command(const cx_cli_cmd_t* _cmd)
             lfs_handle_req_describe((cx_net_common_t*)g_ctx.sv, NULL, g_ctx.buff1, packetSize);
         }
     }
+    else if (QUERY_SELECT == query && cli_parse_is_batch(_cmd))
+    {
+        if (cli_parse_select_batch(_cmd, &err, &tableName, &records, &recordsCount))
+        {
+            packetSize = lfs_pack_req_select_batch(g_ctx.buff1, sizeof(g_ctx.buff1), 0, tableName, records, recordsCount);
+            lfs_handle_req_select_batch((cx_net_common_t*)g_ctx.sv, NULL, g_ctx.buff1, packetSize);
+            free(records);
+        }
+    }
+    else if (QUERY_INSERT == query && cli_parse_is_batch(_cmd))
+    {
+        if (cli_parse_insert_batch(_cmd, &err, &tableName, &records, &recordsCount))
+        {
+            uint32_t pos = 0;
+            uint16_t recordsPacked = 0;
+            if (lfs_pack_req_insert_batch(g_ctx.buff1, sizeof(g_ctx.buff1), &pos, 0, tableName, records, recordsCount, &recordsPacked))
+            {
+                lfs_handle_req_insert_batch((cx_net_common_t*)g_ctx.sv, NULL, g_ctx.buff1, pos);
+            }
+            else
+            {
+                CX_ERR_SET(&err, 1, "The batch is too large to be inserted at once.");
+            }
+
+            for (uint16_t i = 0; i < recordsCount; i++)
+                free(records[i].value);
+            free(records);
+        }
+    }
+    else if (QUERY_SCAN == query)
+    {
+        if (cli_parse_scan(_cmd, &err, &tableName, &partition, &key, &keyMax))
+        {
+            packetSize = lfs_pack_req_scan(g_ctx.buff1, sizeof(g_ctx.buff1), 0, tableName, partition, key, keyMax);
+            lfs_handle_req_scan((cx_net_common_t*)g_ctx.sv, NULL, g_ctx.buff1, packetSize);
+        }
+    }
     else if (QUERY_SELECT == query)
     {
         if (cli_parse_select(_cmd, &err, &tableName, &key))
@@ -381,6 +513,14 @@ static void handle_cli_command(const cx_cli_cmd_t* _cmd)
             lfs_handle_req_insert((cx_net_common_t*)g_ctx.sv, NULL, g_ctx.buff1, packetSize);
         }
     }
+    else if (QUERY_DELETE == query)
+    {
+        if (cli_parse_delete(_cmd, &err, &tableName, &key, &timestamp))
+        {
+            packetSize = lfs_pack_req_delete(g_ctx.buff1, sizeof(g_ctx.buff1), 0, tableName, key, timestamp);
+            lfs_handle_req_delete((cx_net_common_t*)g_ctx.sv, NULL, g_ctx.buff1, packetSize);
+        }
+    }
     else
     {
         CX_ERR_SET(&err, 1, "Unknown command '%s'.", _cmd->header);
@@ -401,13 +541,22 @@ static bool handle_timer_tick(uint64_t _expirations, uint32_t _type, void* _user
     {
     case LFS_TIMER_DUMP:
     {
-        fs_table_dump_tryenqueue();
+        // each dump round is a checkpoint of the write-ahead log. a round is skipped if the 
+        // previous one is still pending (the log can't be truncated until all of them finish).
+        uint16_t dumpsCount = 0;
+        if (wal_checkpoint_begin())
+        {
+            bool success = fs_table_dump_tryenqueue(&dumpsCount);
+            wal_checkpoint_enqueued(dumpsCount, success);
+        }
         break;
     }
 
     case LFS_TIMER_COMPACT:
     {
-        fs_table_compact_tryenqueue(((table_t*)_userData)->meta.name);
+        table_t* table = _userData;
+        if (compaction_needed(table, true))
+            fs_table_compact_tryenqueue(table->meta.name);
         break;
     }
 
@@ -471,6 +620,22 @@ static bool task_run_wk(task_t* _task)
         worker_handle_insert(_task);
         break;
 
+    case TASK_WT_DELETE:
+        worker_handle_delete(_task);
+        break;
+
+    case TASK_WT_SELECT_BATCH:
+        worker_handle_select_batch(_task);
+        break;
+
+    case TASK_WT_INSERT_BATCH:
+        worker_handle_insert_batch(_task);
+        break;
+
+    case TASK_WT_SCAN:
+        worker_handle_scan(_task);
+        break;
+
     case TASK_WT_DUMP:
         worker_handle_dump(_task);
         break;
@@ -479,6 +644,10 @@ static bool task_run_wk(task_t* _task)
         worker_handle_compact(_task);
         break;
 
+    case TASK_WT_COMPACT_PART:
+        worker_handle_compact_part(_task);
+        break;
+
     default:
         CX_WARN(CX_ALW, "undefined <worker-thread> behaviour for task type #%d.", _task->type);
         break;
@@ -552,6 +721,30 @@ static bool task_reschedule(task_t* _task)
     return true;
 }
 
+static bool compaction_needed(table_t* _table, bool _intervalElapsed)
+{
+    // decides whether the given table must be compacted right now according to our policy.
+    // evaluated each time its compaction interval elapses and after each of its dumps.
+    uint32_t dumpsCount = 0;
+    uint64_t dumpsSize = 0;
+
+    switch (g_ctx.cfg.compactionPolicy)
+    {
+    case COMPACTION_POLICY_TIERED:
+    {
+        if (_table->compacting) return false;
+
+        fs_table_dump_stats(_table, &dumpsCount, &dumpsSize);
+        return (dumpsCount >= cx_math_max(g_ctx.cfg.compactionMinDumps, 1))
+            || (g_ctx.cfg.compactionMinBytes > 0 && dumpsSize >= g_ctx.cfg.compactionMinBytes);
+    }
+
+    case COMPACTION_POLICY_INTERVAL:
+    default:
+        return _intervalElapsed;
+    }
+}
+
 static bool task_completed(task_t* _task)
 {
     table_t* table = _task->table;
@@ -624,13 +817,58 @@ static bool task_completed(task_t* _task)
         break;
     }
 
+    case TASK_WT_DELETE:
+    {
+        if (TASK_ORIGIN_API == _task->origin)
+            api_response_delete(_task);
+        else
+            report_delete(_task, stdout);
+        break;
+    }
+
+    case TASK_WT_SELECT_BATCH:
+    {
+        if (TASK_ORIGIN_API == _task->origin)
+            api_response_select_batch(_task);
+        else
+            report_select_batch(_task, stdout);
+        break;
+    }
+
+    case TASK_WT_INSERT_BATCH:
+    {
+        if (TASK_ORIGIN_API == _task->origin)
+            api_response_insert_batch(_task);
+        else
+            report_insert_batch(_task, stdout);
+        break;
+    }
+
+    case TASK_WT_SCAN:
+    {
+        if (TASK_ORIGIN_API == _task->origin)
+            api_response_scan(_task);
+        else
+            report_scan(_task, stdout);
+        break;
+    }
+
     case TASK_WT_DUMP:
     {
+        // a table which no longer exists doesn't need its records to be persisted.
+        wal_checkpoint_dump_done(NULL == table 
+            || ERR_NONE == _task->err.code 
+            || ERR_DUMP_NOT_NEEDED == _task->err.code);
+
         if (NULL != table)
         {
             if (ERR_NONE == _task->err.code)
             {
                 CX_INFO("table '%s' dumped successfully.", table->meta.name);
+
+                // a new dump might be the one that makes the table worth compacting.
+                if (compaction_needed(table, false))
+                    fs_table_compact_tryenqueue(table->meta.name);
             }
             else if (ERR_DUMP_NOT_NEEDED != _task->err.code)
             {
@@ -664,6 +902,12 @@ static bool task_completed(task_t* _task)
         break;
     }
 
+    case TASK_WT_COMPACT_PART:
+    {
+        //noop
+        break;
+    }
+
     case TASK_MT_FREE:
     {
         //noop
@@ -738,4 +982,76 @@ static void api_response_insert(const task_t* _task)
         _task->remoteId, &_task->err);
     
     cx_net_send(g_ctx.sv, MEMP_RES_INSERT, g_ctx.buff1, payloadSize, _task->clientId);
+}
+
+static void api_response_delete(const task_t* _task)
+{
+    uint32_t payloadSize = mem_pack_res_delete(g_ctx.buff1, sizeof(g_ctx.buff1),
+        _task->remoteId, &_task->err);
+
+    cx_net_send(g_ctx.sv, MEMP_RES_DELETE, g_ctx.buff1, payloadSize, _task->clientId);
+}
+
+static void api_response_select_batch(const task_t* _task)
+{
+    data_select_batch_t* data = _task->data;
+    uint32_t pos = 0;
+    uint16_t recordsPacked = 0;
+
+    while (!mem_pack_res_select_batch(g_ctx.buff1, sizeof(g_ctx.buff1), &pos,
+        _task->remoteId, &_task->err, data->records, data->recordsCount, &recordsPacked))
+    {
+        if (!api_response_chunk(MEMP_RES_SELECT_BATCH, pos, _task)) return;
+    }
+
+    if (pos > sizeof(uint16_t))
+    {
+        api_response_chunk(MEMP_RES_SELECT_BATCH, pos, _task);
+    }
+}
+
+static void api_response_insert_batch(const task_t* _task)
+{
+    uint32_t payloadSize = mem_pack_res_insert_batch(g_ctx.buff1, sizeof(g_ctx.buff1),
+        _task->remoteId, &_task->err);
+
+    cx_net_send(g_ctx.sv, MEMP_RES_INSERT_BATCH, g_ctx.buff1, payloadSize, _task->clientId);
+}
+
+static void api_response_scan(const task_t* _task)
+{
+    data_scan_t* data = _task->data;
+    uint32_t pos = 0;
+    uint32_t recordsPacked = 0;
+
+    while (!mem_pack_res_scan(g_ctx.buff1, sizeof(g_ctx.buff1), &pos,
+        _task->remoteId, &_task->err, data->partitionsCount, data->records, data->recordsCount, &recordsPacked))
+    {
+        if (!api_response_chunk(MEMP_RES_SCAN, pos, _task)) return;
+    }
+
+    if (pos > sizeof(uint16_t))
+    {
+        api_response_chunk(MEMP_RES_SCAN, pos, _task);
+    }
+}
+
+static bool api_response_chunk(uint8_t _header, uint32_t _payloadSize, const task_t* _task)
+{
+    // sends the chunk in g_ctx.buff1. the client keeps waiting until it gets every chunk of the response,
+    // so none of them can be dropped: we wait for room in the outbound buffer when it's full and if it 
+    // doesn't make room in time we disconnect it (its pending requests fail right away that way).
+    int32_t result = cx_net_send(g_ctx.sv, _header, g_ctx.buff1, _payloadSize, _task->clientId);
+
+    while (CX_NET_SEND_BUFFER_FULL == result)
+    {
+        if (!cx_net_wait_outboundbuff(g_ctx.sv, _task->clientId, API_RESPONSE_TIMEOUT))
+        {
+            cx_net_disconnect(g_ctx.sv, _task->clientId, "outbound buffer full, the client is not reading our responses");
+            return false;
+        }
+        result = cx_net_send(g_ctx.sv, _header, g_ctx.buff1, _payloadSize, _task->clientId);
+    }
+
+    return (CX_NET_SEND_OK == result);
 }
\ No newline at end of file
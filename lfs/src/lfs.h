@@ -7,6 +7,8 @@
 #include <cx/net.h>
 #include <cx/cdict.h>
 #include <cx/reslock.h>
+#include <cx/bloom.h>
+#include <cx/arena.h>
 
 #include <commons/config.h>
 #include <commons/log.h>
@@ -23,6 +25,16 @@
 #define LFS_CFG_DELAY                   "delay"
 #define LFS_CFG_VALUE_SIZE              "valueSize"
 #define LFS_CFG_INT_DUMP                "dumpInterval"
+#define LFS_CFG_BLOCK_CACHE_SIZE        "blockCacheSize"
+#define LFS_CFG_ROW_CACHE_SIZE          "rowCacheSize"
+#define LFS_CFG_COMPACTION_PARALLELISM  "compactionParallelism"
+#define LFS_CFG_COMPACTION_POLICY       "compactionPolicy"
+#define LFS_CFG_COMPACTION_MIN_DUMPS    "compactionMinDumps"
+#define LFS_CFG_COMPACTION_MIN_BYTES    "compactionMinBytes"
+
+#define LFS_BLOCK_CACHE_SIZE_DEFAULT    4194304
+#define LFS_ROW_CACHE_SIZE_DEFAULT      1048576
+#define LFS_COMPACTION_DUMPS_DEFAULT    4
 
 #define LFS_ROOT_FILE_MARKER            ".lfs_root"
 #define LFS_MAGIC_NUMBER                "LISSANDRA"
@@ -30,9 +42,11 @@
 #define LFS_DIR_METADATA                "Metadata"
 #define LFS_DIR_TABLES                  "Tables"
 #define LFS_DIR_BLOCKS                  "Bloques"
+#define LFS_DIR_WAL                     "WAL"
 
 #define LFS_FILE_METADATA               "Metadata.bin"
 #define LFS_FILE_BITMAP                 "Bitmap.bin"
+#define LFS_FILE_BLOCKS_DATA            "Data.bin"
 
 #define LFS_PART_PREFIX                 "P"
 #define LFS_PART_EXTENSION              "bin"
@@ -48,13 +62,51 @@
 #define LFS_META_PROP_BLOCKS_COUNT      "BLOCKS"
 #define LFS_META_PROP_BLOCKS_SIZE       "BLOCK_SIZE"
 #define LFS_META_PROP_MAGIC_NUMBER      "MAGIC_NUMBER"
+#define LFS_META_PROP_RECORD_FORMAT     "RECORD_FORMAT"
+#define LFS_META_PROP_BLOCK_STORE       "BLOCK_STORE"
+#define LFS_META_PROP_COMPRESSION       "COMPRESSION"
+
+#define LFS_RECORD_FORMAT_TEXT          "TEXT"
+#define LFS_RECORD_FORMAT_BINARY        "BINARY"
+#define LFS_RECORD_FORMAT_COLUMNAR      "COLUMNAR"
+
+#define LFS_BLOCK_STORE_FILES           "FILES"
+#define LFS_BLOCK_STORE_DATAFILE        "DATAFILE"
+
+#define LFS_COMPRESSION_NONE            "NONE"
+#define LFS_COMPRESSION_LZ              "LZ"
+#define LFS_COMPRESSION_FRAME_BLOCKS    8
+
+#define LFS_COMPACTION_POLICY_INTERVAL  "INTERVAL"
+#define LFS_COMPACTION_POLICY_TIERED    "TIERED"
+
+#define LFS_RECORD_MAGIC                "LFSR"
+#define LFS_RECORD_VERSION_BINARY       1
+#define LFS_RECORD_VERSION_COLUMNAR     2
+#define LFS_RECORD_VERSION              LFS_RECORD_VERSION_COLUMNAR
+#define LFS_RECORD_HEADER_SIZE          8
+#define LFS_RECORD_FIELDS_SIZE          12
+#define LFS_RECORD_GROUP_HEADER_MAX     30
+#define LFS_RECORD_GROUP_MAX_RECORDS    256
+
+#define LFS_FILE_MAGIC                  "LFSM"
+#define LFS_FILE_VERSION                4
+#define LFS_FILE_HEADER_SIZE            20
+
+#define LFS_WAL_EXTENSION               "log"
+#define LFS_WAL_HEADER_SIZE             8
 
 #define LFS_FILE_PROP_BLOCKS            "BLOCKS"
 #define LFS_FILE_PROP_SIZE              "SIZE"
+#define LFS_FILE_PROP_RECORD_FORMAT     "RECORD_FORMAT"
+#define LFS_FILE_PROP_INDEX_KEYS        "INDEX_KEYS"
+#define LFS_FILE_PROP_INDEX_OFFSETS     "INDEX_OFFSETS"
 
 #define LFS_DELIM_VALUE                 ";"
 #define LFS_DELIM_RECORD                "\n"
 
+#define LFS_FILTER_BITS_PER_KEY         10
+
 typedef enum LFS_TIMER
 {
     LFS_TIMER_DUMP = 0,
@@ -62,6 +114,37 @@ typedef enum LFS_TIMER
     LFS_TIMER_COUNT
 } LFS_TIMER;
 
+typedef enum RECORD_FORMAT
+{
+    RECORD_FORMAT_TEXT = 0,                     // [TIMESTAMP];[KEY];[VALUE]\n records (legacy format, no header).
+    RECORD_FORMAT_BINARY,                       // LFS_RECORD_MAGIC header followed by little-endian [TIMESTAMP][KEY][VALUE_LEN][VALUE] records.
+    RECORD_FORMAT_COLUMNAR,                     // LFS_RECORD_MAGIC header followed by groups of records storing their keys, timestamps, value lengths and values as separate columns.
+} RECORD_FORMAT;
+
+typedef enum BLOCK_STORE
+{
+    BLOCK_STORE_FILES = 0,                      // one file per block in LFS_DIR_BLOCKS (legacy store).
+    BLOCK_STORE_DATAFILE,                       // single preallocated LFS_FILE_BLOCKS_DATA file. a header with the length of each block followed by the blocks data.
+} BLOCK_STORE;
+
+typedef enum COMPRESSION
+{
+    COMPRESSION_NONE = 0,                       // each block stores blockSize bytes of the file as is (legacy layout).
+    COMPRESSION_LZ,                             // each block stores a cx_lz compressed frame of up to LFS_COMPRESSION_FRAME_BLOCKS * blockSize bytes of the file.
+} COMPRESSION;
+
+typedef enum COMPACTION_POLICY
+{
+    COMPACTION_POLICY_INTERVAL = 0,             // tables are compacted every time their compactionInterval elapses.
+    COMPACTION_POLICY_TIERED,                   // tables are compacted as soon as enough dumps (or dumped bytes) pile up.
+} COMPACTION_POLICY;
+
+typedef enum TABLE_FILE_TYPE
+{
+    TABLE_FILE_TYPE_PART = 0,                   // partition file (P#.bin or P#.binc during compaction).
+    TABLE_FILE_TYPE_DUMP,                       // dump file (D#.tmp or D#.tmpc during compaction).
+} TABLE_FILE_TYPE;
+
 typedef struct cfg_t
 {
     password_t          password;               // password for authenticating MEM nodes.
@@ -74,6 +157,12 @@ typedef struct cfg_t
     uint32_t            delay;                  // artificial delay in ms for each operation performed.
     uint16_t            valueSize;              // size in bytes of a value field in a table record.
     uint32_t            dumpInterval;           // interval in ms to perform memtable dumps.
+    uint32_t            blockCacheSize;         // size in bytes of the in-memory cache of fs blocks (zero disables it).
+    uint32_t            rowCacheSize;           // size in bytes of the in-memory cache of recently selected records of each table (zero disables it).
+    uint16_t            compactionParallelism;  // maximum number of partitions of a single table merged concurrently during its compaction.
+    COMPACTION_POLICY   compactionPolicy;       // policy deciding when a table must be compacted.
+    uint16_t            compactionMinDumps;     // number of dumps which triggers a compaction (COMPACTION_POLICY_TIERED only).
+    uint32_t            compactionMinBytes;     // size in bytes of the dumps which triggers a compaction (COMPACTION_POLICY_TIERED only, zero disables it).
 } cfg_t;
 
 typedef struct fs_meta_t
@@ -81,6 +170,9 @@ typedef struct fs_meta_t
     uint32_t            blocksSize;             // size in bytes of each block in our filesystem.
     uint32_t            blocksCount;            // number of blocks in our filesystem.
     char                magicNumber[100];       // a constant text value used to identify a file format (LISSANDRA).
+    RECORD_FORMAT       recordFormat;           // format used to serialize records when writing new partitions and dumps.
+    BLOCK_STORE         blockStore;             // how the contents of our blocks are stored in the underlying filesystem.
+    COMPRESSION         compression;            // compression applied to the blocks of new partitions and dumps.
 } fs_meta_t;
 
 typedef struct fs_file_t
@@ -89,15 +181,37 @@ typedef struct fs_file_t
     uint32_t            size;                   // size in bytes of the file stored in the fs.
     uint32_t            blocks[MAX_FILE_FRAG];  // ordered array containing the number of each block that stores bytes of our partitioned file.
     uint32_t            blocksCount;            // number of elements in the blocks array.
+    RECORD_FORMAT       recordFormat;           // format used to serialize the records stored in this file.
+    COMPRESSION         compression;            // compression applied to the blocks of this file.
+    uint32_t            frames[MAX_FILE_FRAG];  // offset (in bytes) of the file where the frame stored in blocks[i] starts (COMPRESSION_LZ only).
+    uint64_t            oldestTimestamp;        // timestamp of the oldest record stored in this file (UINT64_MAX if it has none, zero if unknown).
+    uint32_t            indexKeys[MAX_FILE_FRAG];    // sparse index containing the key of the first record starting in each indexed block.
+    uint32_t            indexOffsets[MAX_FILE_FRAG]; // sparse index containing the offset (in bytes) where the record indexKeys[i] starts.
+    uint32_t            indexCount;             // number of elements in the index arrays. zero means the file is not indexed.
 } fs_file_t;
 
+typedef struct table_file_t
+{
+    TABLE_FILE_TYPE     type;                   // type of this table file.
+    uint16_t            number;                 // partition/dump number.
+    bool                duringCompaction;       // true if this file is being compacted (.binc/.tmpc extension).
+    uint32_t            size;                   // size in bytes of the file stored in the fs.
+} table_file_t;
+
 typedef struct fs_ctx_t
 {
     fs_meta_t           meta;                   // filesystem metadata.
     char                rootDir[PATH_MAX];      // initial root directory of our filesystem.
-    FILE*               blocksFile;             // pointer to the opened bitmap file for writing blocks allocations/deallocations.
-    char*               blocksMap;              // buffer for storing our bit array containing blocks status (unset bit mean the block is free to use).
+    char*               blocksMap;              // bitmap file mapped in memory containing blocks status (unset bit mean the block is free to use).
                                                 // must be large enough to hold at least meta.blocksCount amount of bits.
+    uint32_t            blocksMapSize;          // size in bytes of the blocksMap mapping.
+    bool                blocksMapDirty;         // true if blocksMap was modified since the last time it was persisted with fs_block_sync.
+    uint32_t*           blocksSummary;          // summary bitmap of blocksMap. one bit per segment (uint32) of blocksMap, set if all its blocks are in use.
+    uint32_t            blocksSegmentsCount;    // number of segments (uint32) needed to hold meta.blocksCount bits in blocksMap.
+    uint32_t            blocksHint;             // index of the segment where the next allocation should start looking for free blocks.
+    uint32_t            blocksFree;             // number of blocks available.
+    int                 blocksDataFd;           // file descriptor of the opened blocks data file (BLOCK_STORE_DATAFILE only).
+    uint32_t*           blocksLength;           // array of meta.blocksCount elements containing the amount of bytes used in each block (BLOCK_STORE_DATAFILE only).
     cx_cdict_t*         tablesMap;              // container for indexing table_t entries by table name.
     pthread_mutex_t     mtxBlocks;              // mutex for syncing blocks alloc/free operations;
     bool                mtxBlocksInit;          // true if mtxBlocks was successfully initialized and therefore needs to be destroyed.
@@ -110,16 +224,31 @@ typedef enum MEMTABLE_TYPE
     MEMTABLE_TYPE_DISK,                         // memtable loaded from disk (either from a dump or a partition).
 } MEMTABLE_TYPE;
 
+typedef struct memtable_node_t
+{
+    uint32_t            record;                 // index of the record referenced by this node in the records array of the memtable.
+    uint8_t             height;                 // number of levels (forward pointers) of this node.
+    struct memtable_node_t* next[];             // forward pointers of this node, one per level.
+} memtable_node_t;
+
 typedef struct memtable_t
 {
     MEMTABLE_TYPE       type;                   // memtable type depending on initialization. searches are performed differently on each type.
     table_name_t        name;                   // name of the table which this memtable belongs to.
+    uint16_t            partitionsCount;        // number of partitions of the table (records are ordered by partition number first).
     pthread_mutex_t     mtx;                    // mutex for syncing add/dump/find (if needed).
     bool                mtxInitialized;         // true if mtx was successfully initialized and therefore needs to be destroyed.
+    pthread_mutex_t     mtxDump;                // mutex for syncing dumps (only one memtable can be frozen at a time). initialized along with mtx.
+    struct memtable_t*  frozen;                 // immutable memtable swapped out by an ongoing dump. searches must consult it until the dump commits.
     table_record_t*     records;                // array for storing memtable entries.
+    cx_arena_t*         arena;                  // arena storing the values of our records. released all at once on clear/destroy.
     uint32_t            recordsCount;           // number of elements in our array.
     uint32_t            recordsCapacity;        // total capacity of our array.
     bool                recordsSorted;          // true if the records array is sorted and therefore supports binary searches.
+    memtable_node_t*    skiplist;               // head of the skiplist keeping the records ordered by partition, key and timestamp (desc) while 
+                                                // the records array is not sorted (MEM memtables only).
+    uint8_t             skiplistHeight;         // number of levels currently in use in the skiplist.
+    uint32_t            skiplistSeed;           // state of the pseudo-random generator used to pick the height of new nodes.
 } memtable_t;
 
 typedef struct table_t
@@ -131,8 +260,26 @@ typedef struct table_t
     t_queue*            blockedQueue;           // queue with tasks which are awaiting for this table to become unblocked.
     uint16_t            timerHandle;            // handle to the timer created with the desired compaction interval for this table.
     cx_reslock_t        reslock;                // resource lock to protect this table.
+    cx_cdict_t*         filters;                // in-memory bloom filters (cx_bloom_t*) of the keys stored in each partition/dump file indexed by file name.
+    cx_cdict_t*         files;                  // in-memory cache of the descriptors (fs_file_t*) of each partition/dump file indexed by file name.
+    cx_cdict_t*         catalog;                // in-memory catalog (table_file_t*) of the partition/dump files of this table indexed by file name.
+    struct row_cache_t* rowCache;               // in-memory cache of the latest record of recently selected keys (NULL if disabled).
 } table_t;
 
+typedef struct compact_job_t
+{
+    table_name_t        tableName;              // name of the table being compacted.
+    uint16_t*           dumpNumbers;            // numbers of the dumps (.tmpc) being merged into the partitions.
+    uint16_t            dumpsCount;             // number of elements in dumpNumbers.
+    uint16_t            partsCount;             // number of partitions to be merged.
+    uint16_t            partsNext;              // next partition number to be claimed by a worker.
+    uint16_t            partsDone;              // number of partitions claimed which are already merged.
+    uint16_t            refs;                   // number of tasks referencing this job. the last one frees it.
+    cx_err_t            err;                    // first error found merging the partitions.
+    pthread_mutex_t     mtx;                    // mutex for syncing access to this job.
+    pthread_cond_t      cond;                   // condition signaled every time a partition is merged.
+} compact_job_t;
+
 typedef struct lfs_ctx_t
 {
     cfg_t               cfg;                    // lfs node configuration data.
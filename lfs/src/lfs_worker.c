@@ -1,14 +1,18 @@
 #include "lfs_worker.h"
 #include "memtable.h"
 #include "fs.h"
+#include "wal.h"
+#include "row_cache.h"
 
 #include <cx/cx.h>
 #include <cx/mem.h>
 #include <cx/str.h>
 #include <cx/file.h>
+#include <cx/math.h>
 #include <cx/timer.h>
 
 #include <ker/defines.h>
+#include <ker/common.h>
 #include <unistd.h>
 
 /****************************************************************************************
@@ -17,6 +21,18 @@
 
 static void         _worker_parse_result(task_t* _req, table_t* _dependingTable);
 
+static bool         _worker_insert_valid(const table_record_t* _record, cx_err_t* _err);
+
+static void         _worker_select_merge(table_record_t* _record, table_record_t* _candidate);
+
+static void         _worker_select_batch_files(table_t* _table, data_select_batch_t* _data, const uint16_t* _indices, uint16_t _indicesCount);
+
+static compact_job_t* _worker_compact_job_create(table_t* _table, const uint16_t* _dumpNumbers, uint16_t _dumpsCount);
+
+static void         _worker_compact_job_run(compact_job_t* _job);
+
+static void         _worker_compact_job_release(compact_job_t* _job);
+
 /****************************************************************************************
 ***  PUBLIC FUNCTIONS
 ***************************************************************************************/
@@ -31,7 +47,11 @@ void worker_handle_create(task_t* _req)
         data->consistency, 
         data->numPartitions, 
         data->compactionInterval, 
+        data->ttl,
         &_req->err);
+
+    // persist the blocks allocated for the initial partitions
+    fs_block_sync();
     
     _worker_parse_result(_req, table);
 }
@@ -39,9 +59,15 @@ void worker_handle_create(task_t* _req)
 void worker_handle_drop(task_t* _req)
 {
     data_drop_t* data = _req->data;
-    table_t* table;
+    table_t* table = NULL;
 
-    fs_table_delete(data->tableName, &table, &_req->err);
+    // the drop must be in the log before the table is gone, otherwise the records still in the log
+    // would be replayed into a table created later with the same name.
+    if (!fs_table_exists(data->tableName, NULL) || wal_sync(wal_append_drop(data->tableName), &_req->err))
+    {
+        fs_table_delete(data->tableName, &table, &_req->err);
+        fs_block_sync();
+    }
 
     _worker_parse_result(_req, table);
 }
@@ -69,60 +95,71 @@ void worker_handle_select(task_t* _req)
 
     if (fs_table_avail_guard_begin(data->tableName, &_req->err, &table))
     {
-        memtable_t memt;
         cx_err_t err;
         table_record_t* rec = &data->record;
         table_record_t  recTmp;
+        table_record_t  recMem;
+        bool            foundMem = false;
+        bool            foundCache = false;
+        uint32_t        ticket = 0;
 
         rec->timestamp = 0;
         rec->value = NULL;
 
-        // search it in the corresponding partition
-        uint16_t partNumber = rec->key % table->meta.partitionsCount;
-        if (memtable_init_from_part(data->tableName, partNumber, false, &memt, &err))
+        // check our row cache before anything else. the ticket lets us know later on if the key was
+        // inserted while we were searching for it, in which case the record found must not be cached.
+        foundCache = row_cache_get(table->rowCache, rec->key, &recTmp, &ticket);
+
+        // search it in our memtable first. records only move from the memtable to new dumps, 
+        // so looking it up before the files guarantees we won't miss a concurrent dump.
+        foundMem = memtable_find(&table->memtable, rec->key, &recMem);
+
+        if (foundCache)
         {
-            if (memtable_find(&memt, rec->key, &recTmp) && recTmp.timestamp >= rec->timestamp)
+            // the cached record is the most recent one among our files at the moment it was cached
+            // and it's kept up to date on every insert, so there's no need to touch the filesystem.
+            _worker_select_merge(rec, &recTmp);
+        }
+        else
+        {
+            // search it in the corresponding partition (only the indexed range which may contain the key is read)
+            uint16_t partNumber = rec->key % table->meta.partitionsCount;
+            if (memtable_find_in_part(data->tableName, partNumber, false, rec->key, &recTmp, &err))
             {
-                rec->timestamp = recTmp.timestamp;
-                rec->value = cx_str_copy_d(recTmp.value);
+                _worker_select_merge(rec, &recTmp);
             }
 
-            memtable_destroy(&memt);
-        }
-
-        // search it in all the existent dumps
-        uint16_t  dumpNumber = 0;
-        bool      dumpDuringCompaction = false;
-        cx_path_t filePath;
-        cx_file_explorer_t* exp = fs_table_explorer(data->tableName, &err);
-        if (NULL != exp)
-        {
-            while (cx_file_explorer_next_file(exp, &filePath))
+            // search it in all the existent dumps
+            uint32_t      dumpsCount = 0;
+            table_file_t* dumps = fs_table_dump_list(table, &dumpsCount);
+            for (uint32_t i = 0; i < dumpsCount; i++)
             {
-                if (fs_is_dump(&filePath, &dumpNumber, &dumpDuringCompaction) 
-                    &&  memtable_init_from_dump(data->tableName, dumpNumber, dumpDuringCompaction, &memt, &err))
+                if (memtable_find_in_dump(data->tableName, dumps[i].number, dumps[i].duringCompaction, rec->key, &recTmp, &err))
                 {
-                    if (memtable_find(&memt, rec->key, &recTmp) && recTmp.timestamp >= rec->timestamp)
-                    {
-                        rec->timestamp = recTmp.timestamp;
-
-                        if (NULL != rec->value) free(rec->value);
-                        rec->value = cx_str_copy_d(recTmp.value);
-                    }
-
-                    memtable_destroy(&memt);
+                    _worker_select_merge(rec, &recTmp);
                 }
             }
-            cx_file_explorer_destroy(exp);
+            free(dumps);
         }
 
-        // search it in our current memtable
-        if (memtable_find(&table->memtable, rec->key, &recTmp) && recTmp.timestamp >= rec->timestamp)
+        // the memtable record takes precedence over the ones found in files
+        if (foundMem)
         {
-            rec->timestamp = recTmp.timestamp;
+            _worker_select_merge(rec, &recMem);
+        }
 
-            if (NULL != rec->value) free(rec->value);
-            rec->value = cx_str_copy_d(recTmp.value);
+        // keep the record in our row cache (it will be discarded if the key was inserted meanwhile)
+        if (!foundCache && NULL != rec->value)
+        {
+            row_cache_put(table->rowCache, rec, ticket);
+        }
+
+        // a tombstone means the key was deleted and an expired record is as good as deleted. 
+        // they're cached anyway (expiration is checked on every read) so we don't look for them again.
+        if (common_is_tombstone(rec) || common_is_expired(rec, table->meta.ttl, cx_time_epoch_ms()))
+        {
+            free(rec->value);
+            rec->value = NULL;
         }
 
         // check if we finally found it
@@ -147,7 +184,201 @@ void worker_handle_insert(task_t* _req)
         if (0 == data->record.timestamp)
             data->record.timestamp = cx_time_epoch_ms();
 
-        memtable_add(&table->memtable, &data->record, 1);
+        if (_worker_insert_valid(&data->record, &_req->err))
+        {
+            // the record becomes visible only once it's durable, otherwise a failed sync would leave it
+            // in the memtable (and eventually in a dump) after reporting the insert as failed.
+            // concurrent inserts share the same sync.
+            uint32_t epoch = 0;
+            uint64_t lsn = wal_append(table->meta.name, &data->record, 1, &epoch);
+            if (wal_sync(lsn, &_req->err))
+            {
+                memtable_add(&table->memtable, &data->record, 1);
+                row_cache_update(table->rowCache, &data->record);
+            }
+            wal_applied(epoch);
+        }
+
+        fs_table_avail_guard_end(table);
+    }
+
+    _worker_parse_result(_req, table);
+}
+
+void worker_handle_delete(task_t* _req)
+{
+    data_delete_t* data = _req->data;
+    table_t* table = NULL;
+
+    if (fs_table_avail_guard_begin(data->tableName, &_req->err, &table))
+    {
+        // deleting a key is just inserting a tombstone for it. the records it hides are 
+        // removed from our files (along with the tombstone itself) on the next compaction.
+        table_record_t tombstone = { data->key, data->timestamp, TOMBSTONE_VALUE };
+        if (0 == tombstone.timestamp)
+            tombstone.timestamp = cx_time_epoch_ms();
+
+        // same as worker_handle_insert, the tombstone is applied once it's durable.
+        uint32_t epoch = 0;
+        uint64_t lsn = wal_append(table->meta.name, &tombstone, 1, &epoch);
+        if (wal_sync(lsn, &_req->err))
+        {
+            memtable_add(&table->memtable, &tombstone, 1);
+            row_cache_update(table->rowCache, &tombstone);
+        }
+        wal_applied(epoch);
+
+        fs_table_avail_guard_end(table);
+    }
+
+    _worker_parse_result(_req, table);
+}
+
+void worker_handle_select_batch(task_t* _req)
+{
+    data_select_batch_t* data = _req->data;
+    table_t* table = NULL;
+
+    if (fs_table_avail_guard_begin(data->tableName, &_req->err, &table))
+    {
+        table_record_t* rec = NULL;
+        table_record_t  recTmp;
+        table_record_t* recsMem = CX_MEM_ARR_ALLOC(recsMem, cx_math_max(data->recordsCount, 1));
+        bool*           foundMem = CX_MEM_ARR_ALLOC(foundMem, cx_math_max(data->recordsCount, 1));
+        bool*           foundCache = CX_MEM_ARR_ALLOC(foundCache, cx_math_max(data->recordsCount, 1));
+        uint32_t*       tickets = CX_MEM_ARR_ALLOC(tickets, cx_math_max(data->recordsCount, 1));
+        uint16_t*       uncached = CX_MEM_ARR_ALLOC(uncached, cx_math_max(data->recordsCount, 1));
+        uint16_t        uncachedCount = 0;
+        uint64_t        now = cx_time_epoch_ms();
+
+        // same lookup order as worker_handle_select (row cache, memtable, files) but the 
+        // filesystem is only touched once for all the keys which weren't cached.
+        for (uint16_t i = 0; i < data->recordsCount; i++)
+        {
+            rec = &data->records[i];
+            rec->timestamp = 0;
+            rec->value = NULL;
+
+            foundCache[i] = row_cache_get(table->rowCache, rec->key, &recTmp, &tickets[i]);
+            foundMem[i] = memtable_find(&table->memtable, rec->key, &recsMem[i]);
+
+            if (foundCache[i])
+                _worker_select_merge(rec, &recTmp);
+            else
+                uncached[uncachedCount++] = i;
+        }
+
+        if (uncachedCount > 0)
+        {
+            _worker_select_batch_files(table, data, uncached, uncachedCount);
+        }
+
+        for (uint16_t i = 0; i < data->recordsCount; i++)
+        {
+            rec = &data->records[i];
+
+            // the memtable record takes precedence over the ones found in files
+            if (foundMem[i])
+                _worker_select_merge(rec, &recsMem[i]);
+
+            if (!foundCache[i] && NULL != rec->value)
+                row_cache_put(table->rowCache, rec, tickets[i]);
+
+            if (common_is_tombstone(rec) || common_is_expired(rec, table->meta.ttl, now))
+            {
+                free(rec->value);
+                rec->value = NULL;
+            }
+        }
+
+        free(recsMem);
+        free(foundMem);
+        free(foundCache);
+        free(tickets);
+        free(uncached);
+
+        fs_table_avail_guard_end(table);
+    }
+
+    _worker_parse_result(_req, table);
+}
+
+void worker_handle_insert_batch(task_t* _req)
+{
+    data_insert_batch_t* data = _req->data;
+    table_t* table = NULL;
+
+    if (fs_table_avail_guard_begin(data->tableName, &_req->err, &table))
+    {
+        uint64_t now = cx_time_epoch_ms();
+        bool     valid = true;
+        for (uint16_t i = 0; i < data->recordsCount && valid; i++)
+        {
+            if (0 == data->records[i].timestamp)
+                data->records[i].timestamp = now;
+
+            valid = _worker_insert_valid(&data->records[i], &_req->err);
+        }
+
+        if (valid)
+        {
+            // the whole batch goes into a single wal entry, so it's synced (and applied) all at once.
+            uint32_t epoch = 0;
+            uint64_t lsn = wal_append(table->meta.name, data->records, data->recordsCount, &epoch);
+            if (wal_sync(lsn, &_req->err))
+            {
+                memtable_add(&table->memtable, data->records, data->recordsCount);
+                for (uint16_t i = 0; i < data->recordsCount; i++)
+                {
+                    row_cache_update(table->rowCache, &data->records[i]);
+                }
+            }
+            wal_applied(epoch);
+        }
+
+        fs_table_avail_guard_end(table);
+    }
+
+    _worker_parse_result(_req, table);
+}
+
+void worker_handle_scan(task_t* _req)
+{
+    data_scan_t* data = _req->data;
+    table_t* table = NULL;
+
+    if (fs_table_avail_guard_begin(data->tableName, &_req->err, &table))
+    {
+        uint16_t        partFirst = data->partition;
+        uint16_t        partLast = data->partition;
+        table_record_t* partRecords = NULL;
+        uint32_t        partRecordsCount = 0;
+
+        data->partitionsCount = table->meta.partitionsCount;
+
+        if (SCAN_ALL_PARTITIONS == data->partition)
+        {
+            partFirst = 0;
+            partLast = table->meta.partitionsCount - 1;
+        }
+        else if (data->partition >= table->meta.partitionsCount)
+        {
+            CX_ERR_SET(&_req->err, 1, "Partition #%d does not exist in table '%s' (it has %d partitions).",
+                data->partition, data->tableName, table->meta.partitionsCount);
+        }
+
+        // partitions are scanned one at a time and in order, so the records end up sorted 
+        // by partition and key. the row cache is neither consulted nor populated.
+        for (uint32_t p = partFirst; p <= partLast && ERR_NONE == _req->err.code; p++)
+        {
+            partRecordsCount = memtable_scan_part(data->tableName, (uint16_t)p, data->keyMin, data->keyMax, &partRecords, &_req->err);
+            if (0 == partRecordsCount) continue;
+
+            data->records = CX_MEM_ARR_REALLOC(data->records, data->recordsCount + partRecordsCount);
+            memcpy(&data->records[data->recordsCount], partRecords, partRecordsCount * sizeof(partRecords[0]));
+            data->recordsCount += partRecordsCount;
+            free(partRecords);
+        }
 
         fs_table_avail_guard_end(table);
     }
@@ -162,7 +393,13 @@ void worker_handle_dump(task_t* _req)
 
     if (fs_table_avail_guard_begin(data->tableName, &_req->err, &table))
     {
-        memtable_make_dump(&table->memtable, &_req->err);
+        // the dump files are synced as they're written, the bitmap must be synced as well before
+        // reporting the dump as done (the checkpoint deletes the log segments holding its records).
+        wal_checkpoint_wait();
+        if (memtable_make_dump(&table->memtable, &_req->err) && !fs_block_sync())
+        {
+            CX_ERR_SET(&_req->err, ERR_GENERIC, "bitmap file could not be synced after dumping table '%s'.", table->meta.name);
+        }
 
         fs_table_avail_guard_end(table);
     }
@@ -175,11 +412,8 @@ void worker_handle_compact(task_t* _req)
     bool                success = true;
     table_t*            table = _req->table;
     data_compact_t*     data = _req->data;
-    cx_file_explorer_t* exp = NULL;
+    table_file_t*       dumps = NULL;
     uint16_t*           dumpNumbers = NULL;
-    memtable_t          dumpsMemt;
-    bool                dumpsMemtInitialized = false;
-    memtable_t          tempMemt;
     fs_file_t           dumpFile;
 
     // note: pointer to the table being compacted by this task is guaranteed to be valid always since
@@ -189,35 +423,29 @@ void worker_handle_compact(task_t* _req)
     // [STAGE #1] define the scope of our compaction renaming D#.tmp to D#.tmpc files 
     if (success && fs_table_block(table))
     {
-        exp = fs_table_explorer(table->meta.name, &_req->err);
-        if (NULL != exp)
-        {
-            uint16_t   dumpNumberMax = fs_table_dump_number_next(table->meta.name) - 1;
-            cx_path_t  dumpPath;
-            dumpNumbers = CX_MEM_ARR_ALLOC(dumpNumbers, dumpNumberMax);
+        // dumps left as .tmpc by an interrupted compaction are included as well.
+        uint32_t   dumpsCount = 0;
+        cx_path_t  dumpPath;
+        dumps = fs_table_dump_list(table, &dumpsCount);
+        dumpNumbers = CX_MEM_ARR_ALLOC(dumpNumbers, cx_math_max(dumpsCount, 1));
 
-            while (cx_file_explorer_next_file(exp, &dumpPath))
+        for (uint32_t i = 0; i < dumpsCount; i++)
+        {
+            dumpNumbers[data->dumpsCount++] = dumps[i].number;
+            
+            if (!dumps[i].duringCompaction && fs_table_dump_get(table->meta.name, dumps[i].number, false, &dumpFile, NULL))
             {
-                if (fs_is_dump(&dumpPath, &dumpNumbers[data->dumpsCount], NULL))
-                    data->dumpsCount++;
-            }
+                cx_file_set_extension(&dumpFile.path, LFS_DUMP_EXTENSION_COMPACTION, &dumpPath);
 
-            for (uint32_t i = 0; i < data->dumpsCount; i++)
-            {
-                if (fs_table_dump_get(table->meta.name, dumpNumbers[i], false, &dumpFile, NULL))
+                if (!fs_table_file_move(table, &dumpFile.path, &dumpPath, &_req->err))
                 {
-                    cx_file_set_extension(&dumpFile.path, LFS_DUMP_EXTENSION_COMPACTION, &dumpPath);
-
-                    if (!cx_file_move(&dumpFile.path, &dumpPath, &_req->err))
-                    {
-                        success = false;
-                        break;
-                    }
+                    success = false;
+                    break;
                 }
             }
-            cx_file_explorer_destroy(exp);
-            exp = NULL;
         }
+        free(dumps);
+        dumps = NULL;
 
         fs_table_unblock(table, &data->beginStageTime);
     }
@@ -228,60 +456,43 @@ void worker_handle_compact(task_t* _req)
     // a replacement in the next stage.
     if (success)
     {
-        // load dumps .tmpc files into a tempMemt and merge the records into the dumpsMemt
-        if (memtable_init(table->meta.name, false, &dumpsMemt, &_req->err))
+        // merge the records of each partition with the ones found in our .tmpc dumps. 
+        // partitions with no records in the dumps are left untouched.
+        // partitions are independent from each other, so we spawn helper tasks to merge them 
+        // concurrently (up to g_ctx.cfg.compactionParallelism partitions at a time).
+        compact_job_t* job = _worker_compact_job_create(table, dumpNumbers, data->dumpsCount);
+        uint16_t       helpers = cx_math_min(cx_math_max(g_ctx.cfg.compactionParallelism, 1), table->meta.partitionsCount) - 1;
+
+        for (uint16_t i = 0; i < helpers; i++)
         {
-            dumpsMemtInitialized = true;
+            task_t* task = taskman_create(TASK_ORIGIN_INTERNAL_PRIORITY, TASK_WT_COMPACT_PART, NULL, INVALID_CID);
+            if (NULL == task) break;
 
-            for (uint32_t i = 0; i < data->dumpsCount; i++)
-            {
-                if (memtable_init_from_dump(table->meta.name, dumpNumbers[i], true, &tempMemt, &_req->err))
-                {
-                    memtable_add(&dumpsMemt, tempMemt.records, tempMemt.recordsCount);
-                    memtable_clear(&tempMemt);
-                    memtable_destroy(&tempMemt);
-                }
-            }
+            data_compact_part_t* partData = CX_MEM_STRUCT_ALLOC(partData);
+            partData->job = job;
 
-            // sort the entries recovered from dumps and remove duplicates.
-            memtable_preprocess(&dumpsMemt);
+            pthread_mutex_lock(&job->mtx);
+            job->refs++;
+            pthread_mutex_unlock(&job->mtx);
 
-            // make the new partitions
-            uint32_t dumpsEntries = 0;
-            uint32_t dumpsPos = 0;
-            for (uint16_t i = 0; i < table->meta.partitionsCount; i++)
-            {
-                // figure our how many records exist in our dumps memtable that fit in the current partition number.
-                dumpsEntries = 0;
-                while ((dumpsPos + dumpsEntries) < dumpsMemt.recordsCount 
-                    && i == (dumpsMemt.records[dumpsPos + dumpsEntries].key % table->meta.partitionsCount))
-                {
-                    dumpsEntries++;
-                }
-
-                if (dumpsEntries > 0)
-                {
-                    // initialize the new partition, add records, preprocess and save it to a new temporary .binc partition file.
-                    if (memtable_init_from_part(table->meta.name, i, false, &tempMemt, &_req->err))
-                    {
-                        memtable_add(&tempMemt, &dumpsMemt.records[dumpsPos], dumpsEntries);
-                        memtable_preprocess(&tempMemt);
-
-                        // save the new partition (make_part will serialize the memtable to a .binc temporary partition file).
-                        success = memtable_make_part(&tempMemt, i, &_req->err);
-                        memtable_destroy(&tempMemt);
+            task->data = partData;
+            taskman_activate(task);
+        }
 
-                        if (!success) break;
-                    }
+        // we merge partitions ourselves as well. this way we never wait for a helper which 
+        // didn't even start (i.e. all the workers are busy), only for the ones merging.
+        _worker_compact_job_run(job);
 
-                    dumpsPos += dumpsEntries;
-                }
-            }
-        }
-        else
+        pthread_mutex_lock(&job->mtx);
+        while (job->partsDone < job->partsNext)
         {
-            success = false;
+            pthread_cond_wait(&job->cond, &job->mtx);
         }
+        success = (ERR_NONE == job->err.code);
+        if (!success) memcpy(&_req->err, &job->err, sizeof(_req->err));
+        pthread_mutex_unlock(&job->mtx);
+
+        _worker_compact_job_release(job);
     }
 
     /////////////////////////////////////////////////////////////////////////////////////
@@ -309,24 +520,33 @@ void worker_handle_compact(task_t* _req)
                 if (cx_file_exists(&tmpPath))
                 {
                     if (!fs_file_delete(&oldPartFile, &_req->err)) break;
-                    if (!cx_file_move(&tmpPath, &oldPartFile.path, &_req->err)) break;
+                    if (!fs_table_file_move(table, &tmpPath, &oldPartFile.path, &_req->err)) break;
                 }
             }
         }    
 
+        // persist the blocks allocated and freed during this compaction
+        fs_block_sync();
+
         fs_table_unblock(table, &data->endStageTime);
     }
 
     if (NULL != dumpNumbers) free(dumpNumbers);
-    if (dumpsMemtInitialized)
-    {
-        memtable_clear(&dumpsMemt);
-        memtable_destroy(&dumpsMemt);
-    }
 
     _worker_parse_result(_req, table);
 }
 
+void worker_handle_compact_part(task_t* _req)
+{
+    data_compact_part_t* data = _req->data;
+
+    _worker_compact_job_run(data->job);
+    _worker_compact_job_release(data->job);
+    data->job = NULL;
+
+    _worker_parse_result(_req, NULL);
+}
+
 /****************************************************************************************
 ***  PRIVATE FUNCTIONS
 ***************************************************************************************/
@@ -348,4 +568,171 @@ static void _worker_parse_result(task_t* _req, table_t* _affectedTable)
     cx_time_sleep(g_ctx.cfg.delay);
 #endif
 
-}
\ No newline at end of file
+}
+
+static bool _worker_insert_valid(const table_record_t* _record, cx_err_t* _err)
+{
+    // values can't be longer than our valueSize (the MEM nodes get it from us during the handshake).
+    if (strnlen(_record->value, (size_t)g_ctx.cfg.valueSize + 1) > g_ctx.cfg.valueSize)
+    {
+        CX_ERR_SET(_err, ERR_GENERIC, "Value of key %d is too long (the maximum allowed is %d characters).", 
+            _record->key, g_ctx.cfg.valueSize);
+        return false;
+    }
+
+    // tombstones are only written by DELETE, a client inserting one would delete the key instead.
+    // this goes for batches as well, the MEM nodes journal their DELETEs to us as DELETE requests.
+    if (common_is_tombstone(_record))
+    {
+        CX_ERR_SET(_err, ERR_GENERIC, "Value of key %d is reserved for deleted keys.", _record->key);
+        return false;
+    }
+    return true;
+}
+
+static void _worker_select_merge(table_record_t* _record, table_record_t* _candidate)
+{
+    // keeps the most recent value between _record and _candidate. 
+    // the value of _candidate is owned by this function and is either moved to _record or freed.
+    if (_candidate->timestamp >= _record->timestamp)
+    {
+        _record->timestamp = _candidate->timestamp;
+
+        if (NULL != _record->value) free(_record->value);
+        _record->value = _candidate->value;
+    }
+    else
+    {
+        free(_candidate->value);
+    }
+    _candidate->value = NULL;
+}
+
+static void _worker_select_batch_files(table_t* _table, data_select_batch_t* _data, const uint16_t* _indices, uint16_t _indicesCount)
+{
+    // searches the given records (_data->records[_indices[i]]) in our partitions and dumps. 
+    // each partition involved and each dump is read once for the whole batch.
+    cx_err_t        err;
+    uint16_t*       keys = CX_MEM_ARR_ALLOC(keys, _indicesCount);
+    uint16_t*       partIndices = CX_MEM_ARR_ALLOC(partIndices, _indicesCount);
+    table_record_t* found = CX_MEM_ARR_ALLOC(found, _indicesCount);
+    uint16_t        partKeysCount = 0;
+    bool*           partDone = CX_MEM_ARR_ALLOC(partDone, _indicesCount);
+    uint16_t        partNumber = 0;
+
+    // partitions: keys are grouped by the partition they belong to
+    for (uint16_t i = 0; i < _indicesCount; i++)
+    {
+        if (partDone[i]) continue;
+        partNumber = _data->records[_indices[i]].key % _table->meta.partitionsCount;
+        partKeysCount = 0;
+
+        for (uint16_t j = i; j < _indicesCount; j++)
+        {
+            if (!partDone[j] && _data->records[_indices[j]].key % _table->meta.partitionsCount == partNumber)
+            {
+                partDone[j] = true;
+                partIndices[partKeysCount] = _indices[j];
+                keys[partKeysCount++] = _data->records[_indices[j]].key;
+            }
+        }
+
+        CX_ERR_CLEAR(&err);
+        if (memtable_find_many_in_part(_data->tableName, partNumber, false, keys, partKeysCount, found, &err) > 0)
+        {
+            for (uint16_t j = 0; j < partKeysCount; j++)
+            {
+                if (NULL != found[j].value) _worker_select_merge(&_data->records[partIndices[j]], &found[j]);
+            }
+        }
+    }
+
+    // dumps: every key may be in any of them
+    for (uint16_t i = 0; i < _indicesCount; i++)
+    {
+        keys[i] = _data->records[_indices[i]].key;
+    }
+
+    uint32_t      dumpsCount = 0;
+    table_file_t* dumps = fs_table_dump_list(_table, &dumpsCount);
+    for (uint32_t i = 0; i < dumpsCount; i++)
+    {
+        CX_ERR_CLEAR(&err);
+        if (memtable_find_many_in_dump(_data->tableName, dumps[i].number, dumps[i].duringCompaction, keys, _indicesCount, found, &err) > 0)
+        {
+            for (uint16_t j = 0; j < _indicesCount; j++)
+            {
+                if (NULL != found[j].value) _worker_select_merge(&_data->records[_indices[j]], &found[j]);
+            }
+        }
+    }
+    free(dumps);
+
+    free(keys);
+    free(partIndices);
+    free(found);
+    free(partDone);
+}
+
+static compact_job_t* _worker_compact_job_create(table_t* _table, const uint16_t* _dumpNumbers, uint16_t _dumpsCount)
+{
+    compact_job_t* job = CX_MEM_STRUCT_ALLOC(job);
+
+    cx_str_copy(job->tableName, sizeof(job->tableName), _table->meta.name);
+    job->dumpNumbers = CX_MEM_ARR_ALLOC(job->dumpNumbers, cx_math_max(_dumpsCount, 1));
+    memcpy(job->dumpNumbers, _dumpNumbers, _dumpsCount * sizeof(job->dumpNumbers[0]));
+    job->dumpsCount = _dumpsCount;
+    job->partsCount = _table->meta.partitionsCount;
+    job->refs = 1;
+
+    pthread_mutex_init(&job->mtx, NULL);
+    pthread_cond_init(&job->cond, NULL);
+
+    return job;
+}
+
+static void _worker_compact_job_run(compact_job_t* _job)
+{
+    // claims partitions of the given job one at a time and merges them until there're 
+    // no partitions left (or any of them failed).
+    uint16_t partNumber = 0;
+    cx_err_t err;
+
+    while (true)
+    {
+        pthread_mutex_lock(&_job->mtx);
+        if (ERR_NONE != _job->err.code || _job->partsNext >= _job->partsCount)
+        {
+            pthread_mutex_unlock(&_job->mtx);
+            break;
+        }
+        partNumber = _job->partsNext++;
+        pthread_mutex_unlock(&_job->mtx);
+
+        CX_ERR_CLEAR(&err);
+        memtable_merge_part(_job->tableName, partNumber, _job->dumpNumbers, _job->dumpsCount, &err);
+
+        pthread_mutex_lock(&_job->mtx);
+        if (ERR_NONE != err.code && ERR_NONE == _job->err.code)
+            memcpy(&_job->err, &err, sizeof(_job->err));
+
+        _job->partsDone++;
+        pthread_cond_broadcast(&_job->cond);
+        pthread_mutex_unlock(&_job->mtx);
+    }
+}
+
+static void _worker_compact_job_release(compact_job_t* _job)
+{
+    pthread_mutex_lock(&_job->mtx);
+    bool last = (0 == --_job->refs);
+    pthread_mutex_unlock(&_job->mtx);
+
+    if (last)
+    {
+        pthread_mutex_destroy(&_job->mtx);
+        pthread_cond_destroy(&_job->cond);
+        free(_job->dumpNumbers);
+        free(_job);
+    }
+}
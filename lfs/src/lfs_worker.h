@@ -19,8 +19,18 @@ void        worker_handle_select(task_t* _req);
 
 void        worker_handle_insert(task_t* _req);
 
+void        worker_handle_delete(task_t* _req);
+
+void        worker_handle_select_batch(task_t* _req);
+
+void        worker_handle_insert_batch(task_t* _req);
+
+void        worker_handle_scan(task_t* _req);
+
 void        worker_handle_dump(task_t* _req);
 
 void        worker_handle_compact(task_t* _req);
 
+void        worker_handle_compact_part(task_t* _req);
+
 #endif // LFS_WORKER_H_
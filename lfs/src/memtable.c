@@ -5,42 +5,215 @@
 #include <cx/mem.h>
 #include <cx/sort.h>
 #include <cx/math.h>
+#include <cx/lz.h>
+#include <cx/timer.h>
+
+#include <ker/common.h>
 
 #include <string.h>
 #include <inttypes.h>
+#include <endian.h>
 
 #define MAX_TIMESTAMP_CHARS 20
 #define MAX_KEY_CHARS       5
 #define MAX_VALUE_CHARS     g_ctx.cfg.valueSize
 #define MAX_DELIM_CHARS     3
+#define MAX_RECORD_CHARS    (MAX_TIMESTAMP_CHARS + MAX_KEY_CHARS + MAX_VALUE_CHARS + MAX_DELIM_CHARS)
+
+#define SKIPLIST_LEVELS     16
+
+#define ARENA_CHUNK_SIZE    65536
+
+#define RADIX_BITS          8
+#define RADIX_BUCKETS       (1 << RADIX_BITS)
+#define RADIX_PASSES        (32 / RADIX_BITS)
+
+typedef enum MEMTABLE_COLUMN
+{
+    MEMTABLE_COLUMN_KEYS = 0,                   // varint encoded key deltas (zigzag).
+    MEMTABLE_COLUMN_TIMESTAMPS,                 // varint encoded timestamp deltas (zigzag).
+    MEMTABLE_COLUMN_LENGTHS,                    // varint encoded value lengths.
+    MEMTABLE_COLUMN_VALUES,                     // value bytes.
+    MEMTABLE_COLUMN_COUNT
+} MEMTABLE_COLUMN;
+
+typedef struct memtable_column_t
+{
+    char*               data;                   // encoded bytes of the column.
+    uint32_t            size;                   // number of bytes used in data.
+    uint32_t            capacity;               // capacity in bytes of data.
+} memtable_column_t;
+
+typedef struct memtable_group_t
+{
+    uint32_t            count;                  // number of records in the group.
+    uint16_t            keys[LFS_RECORD_GROUP_MAX_RECORDS];         // decoded keys column.
+    uint64_t            timestamps[LFS_RECORD_GROUP_MAX_RECORDS];   // decoded timestamps column.
+    uint32_t            values[LFS_RECORD_GROUP_MAX_RECORDS + 1];   // offset of each value in valuesData (plus the end of the last one).
+    const char*         valuesData;             // values column. points to the buffer the group was decoded from.
+} memtable_group_t;
+
+typedef struct memtable_writer_t
+{
+    const char*         tableName;              // name of the table which the file being written belongs to.
+    fs_file_t*          file;                   // file being written.
+    RECORD_FORMAT       format;                 // format used to serialize the records.
+    COMPRESSION         compression;            // compression applied to the blocks of the file.
+    uint32_t            blocksReserved;         // number of blocks reserved upfront in file->blocks.
+    char*               buff;                   // buffer for storing a block of data (or the bytes of a frame to compress) before writing it.
+    uint32_t            buffPos;                // number of bytes used in buff.
+    uint32_t            buffCapacity;           // capacity in bytes of buff.
+    char*               frame;                  // buffer for storing a compressed frame (compressed files only).
+    uint32_t            frameCapacity;          // capacity in bytes of frame.
+    memtable_column_t   columns[MEMTABLE_COLUMN_COUNT]; // columns of the group being built (RECORD_FORMAT_COLUMNAR only).
+    uint32_t            groupCount;             // number of records in the group being built.
+    table_record_t      groupLast;              // last record added to the group. the next one is delta encoded against it.
+    uint16_t            groupKey;               // key of the first record of the group being built.
+    char*               tmp;                    // temporary buffer for serializing a single record.
+    uint32_t            tmpSize;                // capacity in bytes of tmp.
+} memtable_writer_t;
+
+typedef struct memtable_reader_t
+{
+    fs_file_t           file;                   // file being read.
+    RECORD_FORMAT       format;                 // format of the records stored in the file.
+    uint32_t            filePos;                // offset in the file of the next byte to be read.
+    char*               buff;                   // buffer holding the bytes read from the file.
+    uint32_t            buffSize;               // number of valid bytes in buff.
+    uint32_t            buffPos;                // position in buff of the next record to be decoded.
+    uint32_t            buffCapacity;           // capacity in bytes of buff.
+    char*               value;                  // buffer holding the value of the current record.
+    uint32_t            valueCapacity;          // capacity in bytes of value.
+    table_record_t      record;                 // current record. its value is only valid until the reader moves forward.
+    bool                valid;                  // true if record holds a record. false once we reach the end of the file.
+    memtable_group_t*   group;                  // group of records being read (RECORD_FORMAT_COLUMNAR only).
+    uint32_t            groupPos;               // position in group of the next record to be returned.
+} memtable_reader_t;
+
+typedef struct memtable_sort_entry_t
+{
+    uint32_t            sortKey;                // partition number (high 16 bits) and key (low 16 bits) of the record.
+    uint32_t            index;                  // position of the record in the array being sorted.
+} memtable_sort_entry_t;
 
 /****************************************************************************************
  ***  PRIVATE DECLARATIONS
  ***************************************************************************************/
 
-static bool         _memtable_init(const char* _tableName, memtable_t* _outTable, cx_err_t* _err);
+static bool         _memtable_init(const char* _tableName, uint16_t _partitionsCount, memtable_t* _outTable, cx_err_t* _err);
+
+static table_record_t* _memtable_find(memtable_t* _table, uint16_t _key);
+
+static void         _memtable_swap(memtable_t* _a, memtable_t* _b);
+
+static bool         _memtable_flush(memtable_t* _frozen, cx_err_t* _err);
 
 static int32_t      _memtable_comp_full(const void* _a, const void* _b, void* _userData);
 
 static int32_t      _memtable_comp_basic(const void* _a, const void* _b, void* _userData);
 
+static uint32_t     _memtable_sort_unique(table_record_t* _records, uint32_t _recordsCount, table_t* _tableInfo, cx_destroyer_cb _destroyer);
+
+static void         _memtable_record_free(void* _record);
+
+static uint32_t     _memtable_scan_mem(memtable_t* _table, table_t* _tableInfo, uint16_t _partNumber, uint16_t _keyMin, uint16_t _keyMax, table_record_t** _outRecords);
+
 static bool         _memtable_save(memtable_t* _table, fs_file_t* _outFile, cx_err_t* _err);
 
+static bool         _memtable_writer_open(memtable_writer_t* _writer, const char* _tableName, fs_file_t* _outFile, uint32_t _sizeHint, cx_err_t* _err);
+
+static bool         _memtable_writer_add(memtable_writer_t* _writer, const table_record_t* _record, cx_err_t* _err);
+
+static bool         _memtable_writer_close(memtable_writer_t* _writer, cx_err_t* _err);
+
+static bool         _memtable_reader_open(memtable_reader_t* _reader, const fs_file_t* _file, uint32_t _offset, cx_err_t* _err);
+
+static bool         _memtable_reader_next(memtable_reader_t* _reader, cx_err_t* _err);
+
+static bool         _memtable_reader_fill(memtable_reader_t* _reader, cx_err_t* _err);
+
+static int32_t      _memtable_reader_decode(memtable_reader_t* _reader, cx_err_t* _err);
+
+static void         _memtable_reader_close(memtable_reader_t* _reader);
+
+static uint32_t     _memtable_save_size(memtable_t* _table, RECORD_FORMAT _format, uint32_t _recordMaxSize);
+
+static void         _memtable_save_index(fs_file_t* _file, uint16_t _key);
+
+static bool         _memtable_save_bytes(memtable_writer_t* _writer, const char* _data, uint32_t _dataSize, cx_err_t* _err);
+
+static bool         _memtable_save_block(memtable_writer_t* _writer, bool _last, cx_err_t* _err);
+
+static uint32_t     _memtable_save_frame(memtable_writer_t* _writer, uint32_t* _outFrameSize);
+
+static bool         _memtable_save_group(memtable_writer_t* _writer, cx_err_t* _err);
+
+static bool         _memtable_group_add(memtable_writer_t* _writer, const table_record_t* _record, uint16_t _valueLen, cx_err_t* _err);
+
+static int32_t      _memtable_group_decode(const char* _buff, uint32_t _buffSize, memtable_group_t* _outGroup, cx_err_t* _err);
+
+static void         _memtable_column_append(memtable_column_t* _column, const char* _data, uint32_t _dataSize);
+
+static uint32_t     _memtable_varint_encode(char* _buff, uint64_t _value);
+
+static bool         _memtable_varint_decode(const char* _buff, uint32_t _buffSize, uint32_t* _inOutPos, uint64_t* _outValue);
+
 static bool         _memtable_load(memtable_t* _table, char* _buff, uint32_t _buffSize, cx_err_t* _err);
 
-static void         _memtable_record_destroyer(void* _data);
+static bool         _memtable_load_records(memtable_t* _table, char* _buff, uint32_t _buffSize, RECORD_FORMAT _format, cx_err_t* _err);
+
+static bool         _memtable_load_text(memtable_t* _table, char* _buff, uint32_t _buffSize, cx_err_t* _err);
+
+static bool         _memtable_load_binary(memtable_t* _table, char* _buff, uint32_t _buffSize, cx_err_t* _err);
+
+static bool         _memtable_load_columnar(memtable_t* _table, char* _buff, uint32_t _buffSize, cx_err_t* _err);
+
+static bool         _memtable_ensure_capacity(memtable_t* _table, uint32_t _numRecords, cx_err_t* _err);
+
+static uint32_t     _memtable_encode_header(char* _buff, RECORD_FORMAT _format);
+
+static bool         _memtable_decode_header(const char* _buff, uint32_t _buffSize, uint16_t* _outVersion);
+
+static bool         _memtable_header_format(uint16_t _version, RECORD_FORMAT* _outFormat, cx_err_t* _err);
+
+static uint32_t     _memtable_encode_record(char* _buff, const table_record_t* _record, uint16_t _valueLen);
+
+static memtable_node_t* _memtable_node_alloc(uint32_t _record, uint8_t _height);
+
+static uint8_t      _memtable_node_height(memtable_t* _table);
+
+static void         _memtable_skiplist_clear(memtable_t* _table);
+
+static void         _memtable_skiplist_insert(memtable_t* _table, uint32_t _record);
+
+static void         _memtable_skiplist_rebuild(memtable_t* _table);
+
+static memtable_node_t* _memtable_skiplist_seek(memtable_t* _table, uint16_t _key);
+
+static void         _memtable_skiplist_flatten(memtable_t* _table);
+
+static bool         _memtable_find_in_file(const char* _tableName, fs_file_t* _file, uint16_t _key, table_record_t* _outRecord, cx_err_t* _err);
+
+static uint32_t     _memtable_find_many_in_file(table_t* _table, fs_file_t* _file, const uint16_t* _keys, const bool* _candidates, uint32_t _keysCount, table_record_t* _outRecords, cx_err_t* _err);
+
+static bool         _memtable_find_in_groups(table_t* _table, const char* _buff, uint32_t _buffSize, uint16_t _key, table_record_t* _outRecord, cx_err_t* _err);
+
+static int32_t      _memtable_index_find(fs_file_t* _file, table_t* _table, uint16_t _key);
 
 
 /****************************************************************************************
  ***  PUBLIC FUNCTIONS
  ***************************************************************************************/
 
-bool memtable_init(const char* _tableName, bool _threadSafe, memtable_t* _outTable, cx_err_t* _err)
+bool memtable_init(const char* _tableName, uint16_t _partitionsCount, bool _threadSafe, memtable_t* _outTable, cx_err_t* _err)
 {
-    if (!_memtable_init(_tableName, _outTable, _err)) return false;
+    if (!_memtable_init(_tableName, _partitionsCount, _outTable, _err)) return false;
 
     _outTable->type = MEMTABLE_TYPE_MEM;
     _outTable->recordsSorted = false;
+    _outTable->skiplist = _memtable_node_alloc(UINT32_MAX, SKIPLIST_LEVELS);
+    _outTable->skiplistHeight = 1;
+    _outTable->skiplistSeed = 0x9E3779B9;
 
     if (_threadSafe)
     {
@@ -48,7 +221,8 @@ bool memtable_init(const char* _tableName, bool _threadSafe, memtable_t* _outTab
         _outTable->mtxInitialized = true
             && (0 == pthread_mutexattr_init(&attr))
             && (0 == pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE))
-            && (0 == pthread_mutex_init(&_outTable->mtx, &attr));
+            && (0 == pthread_mutex_init(&_outTable->mtx, &attr))
+            && (0 == pthread_mutex_init(&_outTable->mtxDump, NULL));
         pthread_mutexattr_destroy(&attr);
 
         if (!_outTable->mtxInitialized)
@@ -63,7 +237,14 @@ bool memtable_init(const char* _tableName, bool _threadSafe, memtable_t* _outTab
 
 bool memtable_init_from_dump(const char* _tableName, uint16_t _dumpNumber, bool _isDuringCompaction, memtable_t* _outTable, cx_err_t* _err)
 {
-    if (!_memtable_init(_tableName, _outTable, _err)) return false;
+    table_t* table = NULL;
+    if (!fs_table_exists(_tableName, &table))
+    {
+        CX_ERR_SET(_err, 1, "Table '%s' does not exist.", _tableName);
+        return false;
+    }
+
+    if (!_memtable_init(_tableName, table->meta.partitionsCount, _outTable, _err)) return false;
     
     _outTable->type = MEMTABLE_TYPE_DISK;
     _outTable->recordsSorted = true;
@@ -85,7 +266,14 @@ bool memtable_init_from_dump(const char* _tableName, uint16_t _dumpNumber, bool
 
 bool memtable_init_from_part(const char* _tableName, uint16_t _partNumber, bool _isDuringCompaction, memtable_t* _outTable, cx_err_t* _err)
 {
-    if (!_memtable_init(_tableName, _outTable, _err)) return false;   
+    table_t* table = NULL;
+    if (!fs_table_exists(_tableName, &table))
+    {
+        CX_ERR_SET(_err, 1, "Table '%s' does not exist.", _tableName);
+        return false;
+    }
+
+    if (!_memtable_init(_tableName, table->meta.partitionsCount, _outTable, _err)) return false;
 
     _outTable->type = MEMTABLE_TYPE_DISK;
     _outTable->recordsSorted = true;
@@ -108,6 +296,98 @@ bool memtable_init_from_part(const char* _tableName, uint16_t _partNumber, bool
     return (ERR_NONE == _err->code);
 }
 
+bool memtable_find_in_dump(const char* _tableName, uint16_t _dumpNumber, bool _isDuringCompaction, uint16_t _key, table_record_t* _outRecord, cx_err_t* _err)
+{
+    // skip the file entirely if its bloom filter tells us the key is not there
+    table_t* table = NULL;
+    if (fs_table_exists(_tableName, &table) && !fs_table_dump_may_contain(table, _dumpNumber, _isDuringCompaction, _key))
+        return false;
+
+    fs_file_t dumpFile;
+    if (fs_table_dump_get(_tableName, _dumpNumber, _isDuringCompaction, &dumpFile, _err))
+    {
+        return _memtable_find_in_file(_tableName, &dumpFile, _key, _outRecord, _err);
+    }
+    return false;
+}
+
+bool memtable_find_in_part(const char* _tableName, uint16_t _partNumber, bool _isDuringCompaction, uint16_t _key, table_record_t* _outRecord, cx_err_t* _err)
+{
+    // skip the file entirely if its bloom filter tells us the key is not there
+    table_t* table = NULL;
+    if (fs_table_exists(_tableName, &table) && !fs_table_part_may_contain(table, _partNumber, _isDuringCompaction, _key))
+        return false;
+
+    fs_file_t partFile;
+    if (fs_table_part_get(_tableName, _partNumber, _isDuringCompaction, &partFile, _err))
+    {
+        return _memtable_find_in_file(_tableName, &partFile, _key, _outRecord, _err);
+    }
+    return false;
+}
+
+uint32_t memtable_find_many_in_dump(const char* _tableName, uint16_t _dumpNumber, bool _isDuringCompaction, const uint16_t* _keys, uint32_t _keysCount, table_record_t* _outRecords, cx_err_t* _err)
+{
+    // batched version of memtable_find_in_dump. _outRecords[i] gets the record found for _keys[i] 
+    // (or a NULL value if it's not there). returns the number of keys found.
+    table_t*  table = NULL;
+    fs_file_t dumpFile;
+    uint32_t  found = 0;
+    bool*     candidates = NULL;
+    
+    for (uint32_t i = 0; i < _keysCount; i++)
+        _outRecords[i].value = NULL;
+
+    if (!fs_table_exists(_tableName, &table))
+    {
+        CX_ERR_SET(_err, 1, "Table '%s' does not exist.", _tableName);
+        return 0;
+    }
+
+    if (fs_table_dump_get(_tableName, _dumpNumber, _isDuringCompaction, &dumpFile, _err))
+    {
+        // only the keys which may be in the file according to its bloom filter are searched
+        candidates = CX_MEM_ARR_ALLOC(candidates, cx_math_max(_keysCount, 1));
+        for (uint32_t i = 0; i < _keysCount; i++)
+            candidates[i] = fs_table_dump_may_contain(table, _dumpNumber, _isDuringCompaction, _keys[i]);
+
+        found = _memtable_find_many_in_file(table, &dumpFile, _keys, candidates, _keysCount, _outRecords, _err);
+        free(candidates);
+    }
+    return found;
+}
+
+uint32_t memtable_find_many_in_part(const char* _tableName, uint16_t _partNumber, bool _isDuringCompaction, const uint16_t* _keys, uint32_t _keysCount, table_record_t* _outRecords, cx_err_t* _err)
+{
+    // batched version of memtable_find_in_part. _outRecords[i] gets the record found for _keys[i] 
+    // (or a NULL value if it's not there). returns the number of keys found.
+    table_t*  table = NULL;
+    fs_file_t partFile;
+    uint32_t  found = 0;
+    bool*     candidates = NULL;
+
+    for (uint32_t i = 0; i < _keysCount; i++)
+        _outRecords[i].value = NULL;
+
+    if (!fs_table_exists(_tableName, &table))
+    {
+        CX_ERR_SET(_err, 1, "Table '%s' does not exist.", _tableName);
+        return 0;
+    }
+
+    if (fs_table_part_get(_tableName, _partNumber, _isDuringCompaction, &partFile, _err))
+    {
+        // only the keys which may be in the file according to its bloom filter are searched
+        candidates = CX_MEM_ARR_ALLOC(candidates, cx_math_max(_keysCount, 1));
+        for (uint32_t i = 0; i < _keysCount; i++)
+            candidates[i] = fs_table_part_may_contain(table, _partNumber, _isDuringCompaction, _keys[i]);
+
+        found = _memtable_find_many_in_file(table, &partFile, _keys, candidates, _keysCount, _outRecords, _err);
+        free(candidates);
+    }
+    return found;
+}
+
 void memtable_destroy(memtable_t* _table)
 {
     CX_CHECK_NOT_NULL(_table);
@@ -120,17 +400,23 @@ void memtable_destroy(memtable_t* _table)
             _table->name, _table->recordsCount);
     }
 
-    for (uint32_t i = 0; i < _table->recordsCount; i++)
-    {
-        free(_table->records[i].value);
-        _table->records[i].value = NULL;
-    }
     free(_table->records);
     _table->records = NULL;
 
+    cx_arena_destroy(_table->arena);
+    _table->arena = NULL;
+
+    if (NULL != _table->skiplist)
+    {
+        _memtable_skiplist_clear(_table);
+        free(_table->skiplist);
+        _table->skiplist = NULL;
+    }
+
     if (_table->mtxInitialized)
     {
         pthread_mutex_destroy(&_table->mtx);
+        pthread_mutex_destroy(&_table->mtxDump);
         _table->mtxInitialized = false;
     }
 }
@@ -143,6 +429,11 @@ void memtable_add(memtable_t* _table, const table_record_t* _record, uint32_t _n
 
     if (_table->mtxInitialized) pthread_mutex_lock(&_table->mtx);
 
+    // the records array was sorted by a previous memtable_preprocess call which didn't end
+    // up in a dump. our skiplist is empty at this point, index the existing records first.
+    if (NULL != _table->skiplist && _table->recordsSorted)
+        _memtable_skiplist_rebuild(_table);
+
     while (_table->recordsCount + _numRecords > _table->recordsCapacity)
     {
         // we need more extra space, reallocate our records array doubling its capacity
@@ -155,7 +446,10 @@ void memtable_add(memtable_t* _table, const table_record_t* _record, uint32_t _n
     {
         _table->records[_table->recordsCount + i].timestamp = _record[i].timestamp;
         _table->records[_table->recordsCount + i].key = _record[i].key;
-        _table->records[_table->recordsCount + i].value = cx_str_copy_d(_record[i].value);
+        _table->records[_table->recordsCount + i].value = cx_arena_str_copy(_table->arena, _record[i].value, strlen(_record[i].value));
+
+        if (NULL != _table->skiplist)
+            _memtable_skiplist_insert(_table, _table->recordsCount + i);
     }
 
     _table->recordsCount += _numRecords;
@@ -170,12 +464,12 @@ void memtable_clear(memtable_t* _table)
 
     if (_table->mtxInitialized) pthread_mutex_lock(&_table->mtx);
 
-    // clear the memtable
-    for (uint32_t i = 0; i < _table->recordsCount; i++)
-    {
-        _memtable_record_destroyer((void*)&_table->records[i]);
-    }
+    // clear the memtable. all the values are released at once with the arena.
     _table->recordsCount = 0;
+    cx_arena_reset(_table->arena);
+
+    if (NULL != _table->skiplist)
+        _memtable_skiplist_clear(_table);
 
     if (_table->mtxInitialized) pthread_mutex_unlock(&_table->mtx);
 }
@@ -188,14 +482,20 @@ void memtable_preprocess(memtable_t* _table)
     // sorted by partition number (asc), key (asc) and timestamp (desc).
     // this will allow us to do binary searches during select and compaction operations.
 
+    if (NULL != _table->skiplist)
+    {
+        // MEM memtables keep their records ordered in the skiplist as they're added.
+        // we just need to lay them out in that order, no sorting required.
+        if (!_table->recordsSorted)
+            _memtable_skiplist_flatten(_table);
+        return;
+    }
+
     table_t* table = NULL;
     if (fs_table_exists(_table->name, &table))
     {
-        cx_sort_quick(_table->records, sizeof(_table->records[0]),
-            _table->recordsCount, _memtable_comp_full, table);
-
-        _table->recordsCount = cx_sort_uniquify(_table->records, sizeof(_table->records[0]),
-            _table->recordsCount, _memtable_comp_basic, table, _memtable_record_destroyer);
+        // stale values are left in the arena until the memtable is cleared.
+        _table->recordsCount = _memtable_sort_unique(_table->records, _table->recordsCount, table, NULL);
 
         _table->recordsSorted = true;
     }
@@ -206,22 +506,27 @@ bool memtable_make_dump(memtable_t* _table, cx_err_t* _err)
     CX_CHECK_NOT_NULL(_table);
     CX_CHECK(MEMTABLE_TYPE_MEM == _table->type, "you can only dump memtables of type MEM!")
 
+    // we don't want to hold our memtable mutex while the dump is being written to disk since 
+    // every insert and select on this table would stall meanwhile. instead, we swap the current
+    // records into a frozen (immutable) memtable and keep going with an empty one. the frozen 
+    // memtable is flushed to a new dump file and it's searched by memtable_find until then.
+    memtable_t* frozen = NULL;
+
+    if (_table->mtxInitialized) pthread_mutex_lock(&_table->mtxDump);
     if (_table->mtxInitialized) pthread_mutex_lock(&_table->mtx);
 
-    table_t* table = NULL;
     if (_table->recordsCount > 0)
     {
-        memtable_preprocess(_table);
-
-        fs_file_t dumpFile;
-        CX_MEM_ZERO(dumpFile);
-        if (_memtable_save(_table, &dumpFile, _err))
+        frozen = CX_MEM_STRUCT_ALLOC(frozen);
+        if (memtable_init(_table->name, _table->partitionsCount, true, frozen, _err))
         {
-            uint16_t dumpNumber = fs_table_dump_number_next(_table->name);
-            if (fs_table_dump_set(_table->name, dumpNumber, false, &dumpFile, _err))
-            {
-                memtable_clear(_table);
-            }
+            _memtable_swap(_table, frozen);
+            _table->frozen = frozen;
+        }
+        else
+        {
+            free(frozen);
+            frozen = NULL;
         }
     }
     else
@@ -230,113 +535,483 @@ bool memtable_make_dump(memtable_t* _table, cx_err_t* _err)
     }
 
     if (_table->mtxInitialized) pthread_mutex_unlock(&_table->mtx);
+
+    if (NULL != frozen)
+    {
+        bool flushed = _memtable_flush(frozen, _err);
+
+        if (_table->mtxInitialized) pthread_mutex_lock(&_table->mtx);
+
+        // the dump failed, give the frozen records back to our memtable so that they're not lost.
+        if (!flushed)
+            memtable_add(_table, frozen->records, frozen->recordsCount);
+
+        _table->frozen = NULL;
+        if (_table->mtxInitialized) pthread_mutex_unlock(&_table->mtx);
+
+        memtable_clear(frozen);
+        memtable_destroy(frozen);
+        free(frozen);
+    }
+
+    if (_table->mtxInitialized) pthread_mutex_unlock(&_table->mtxDump);
     return (ERR_NONE == _err->code);
 }
 
-bool memtable_make_part(memtable_t* _table, uint16_t _partNumber, cx_err_t* _err)
+bool memtable_merge_part(const char* _tableName, uint16_t _partNumber, const uint16_t* _dumpNumbers, uint32_t _dumpsCount, cx_err_t* _err)
 {
-    CX_CHECK_NOT_NULL(_table);
+    // merges the records of the given partition with the ones belonging to it in the given 
+    // dumps (being compacted) into a new P#.binc partition file. nothing is written if none of 
+    // the dumps contains records of this partition.
+    //
+    // all of our files are sorted by partition, key (asc) and timestamp (desc) with no duplicated
+    // keys, so we perform a k-way merge reading them block by block and writing the resulting 
+    // records straight to the new partition. only a few blocks per file are kept in memory.
+
+    table_t*           table = NULL;
+    memtable_reader_t* readers = NULL;  // readers[0] is our partition, the rest are the dumps.
+    uint32_t           readersCount = 0;
+    memtable_writer_t  writer;
+    fs_file_t          file;
+    fs_file_t          partFile;
+    uint32_t           sizeHint = 0;
+    bool               pending = false;
+    uint16_t*          keys = NULL;
+    uint32_t           keysCount = 0;
+    uint32_t           keysCapacity = MEMTABLE_INITIAL_CAPACITY;
+    int32_t            best = -1;
+    uint16_t           key = 0;
+    int32_t            pos = -1;
+    uint64_t           now = cx_time_epoch_ms();
+
+    if (!fs_table_exists(_tableName, &table))
+    {
+        CX_ERR_SET(_err, 1, "Table '%s' does not exist.", _tableName);
+        return false;
+    }
 
-    if (_table->mtxInitialized) pthread_mutex_lock(&_table->mtx);
+    readers = CX_MEM_ARR_ALLOC(readers, _dumpsCount + 1);
 
-    table_t* table = NULL;
-    if (fs_table_exists(_table->name, &table))
+    // position each dump reader at the first record of our partition. the sparse index tells us 
+    // where to start since the lowest key that could belong to partition N is N itself.
+    for (uint32_t i = 0; i < _dumpsCount; i++)
     {
-        memtable_preprocess(_table);
+        if (!fs_table_dump_get(_tableName, _dumpNumbers[i], true, &file, _err)) goto finished;
+
+        pos = (file.indexCount > 0) ? _memtable_index_find(&file, table, _partNumber) : -1;
+        if (!_memtable_reader_open(&readers[1 + i], &file, (pos < 0) ? 0 : file.indexOffsets[pos], _err)) goto finished;
+        readersCount = 1 + i + 1;
 
-        fs_file_t partFile;
-        CX_MEM_ZERO(partFile);
-        if (_memtable_save(_table, &partFile, _err))
+        while (readers[1 + i].valid && (readers[1 + i].record.key % table->meta.partitionsCount) < _partNumber)
         {
-            fs_table_part_set(_table->name, _partNumber, true, &partFile, _err);
+            if (!_memtable_reader_next(&readers[1 + i], _err)) break;
+        }
+        if (ERR_NONE != _err->code) goto finished;
+
+        if (readers[1 + i].valid && (readers[1 + i].record.key % table->meta.partitionsCount) == _partNumber)
+        {
+            pending = true;
+            sizeHint += file.size / table->meta.partitionsCount;
         }
     }
-    else
+
+    if (!fs_table_part_get(_tableName, _partNumber, false, &partFile, _err)) goto finished;
+
+    // even if the dumps have nothing for us, the partition is rewritten once its oldest record 
+    // expires so that expired records don't stay on disk forever (zero means we don't know it).
+    if (!pending && table->meta.ttl > 0 && UINT64_MAX != partFile.oldestTimestamp
+        && partFile.oldestTimestamp + (uint64_t)table->meta.ttl * 1000 <= now)
+        pending = true;
+
+    if (!pending || !_memtable_reader_open(&readers[0], &partFile, 0, _err)) goto finished;
+    readersCount = _dumpsCount + 1;
+    sizeHint += partFile.size;
+
+    // keys written to the new partition. we need them to build its bloom filter.
+    keys = CX_MEM_ARR_ALLOC(keys, keysCapacity);
+
+    if (_memtable_writer_open(&writer, _tableName, &file, sizeHint, _err))
+    {
+        while (true)
+        {
+            // pick the lowest key among our readers. if many of them have it, the most recent 
+            // record wins (on equal timestamps, dumps win over the partition and newer dumps over older ones.
+            // _dumpNumbers follows the order of fs_table_dump_list, from the oldest to the most recent one).
+            best = -1;
+            for (uint32_t i = 0; i < readersCount; i++)
+            {
+                if (!readers[i].valid || (readers[i].record.key % table->meta.partitionsCount) != _partNumber) 
+                    continue;
+
+                if (best < 0
+                    || readers[i].record.key < readers[best].record.key
+                    || (readers[i].record.key == readers[best].record.key && readers[i].record.timestamp >= readers[best].record.timestamp))
+                {
+                    best = i;
+                }
+            }
+            if (best < 0) break;
+
+            key = readers[best].record.key;
+
+            // the partition is our oldest file, so once merged into it a tombstone has nothing 
+            // else to hide. both the tombstone and the records it hid are discarded for good.
+            // the same goes for expired records, every older record of their key is expired too.
+            if (!common_is_tombstone(&readers[best].record)
+                && !common_is_expired(&readers[best].record, table->meta.ttl, now))
+            {
+                if (!_memtable_writer_add(&writer, &readers[best].record, _err)) break;
+
+                CX_MEM_ENSURE_CAPACITY(keys, keysCount, keysCapacity);
+                keys[keysCount++] = key;
+            }
+
+            // move forward every reader positioned at the key we just wrote.
+            for (uint32_t i = 0; i < readersCount; i++)
+            {
+                if (readers[i].valid && readers[i].record.key == key)
+                    _memtable_reader_next(&readers[i], _err);
+            }
+            if (ERR_NONE != _err->code) break;
+        }
+    }
+
+    if (_memtable_writer_close(&writer, _err))
+    {
+        cx_bloom_t* filter = cx_bloom_init(keysCount, LFS_FILTER_BITS_PER_KEY);
+        for (uint32_t i = 0; i < keysCount; i++)
+        {
+            cx_bloom_add(filter, &keys[i], sizeof(keys[i]));
+        }
+
+        if (!fs_table_part_set(_tableName, _partNumber, true, &file, filter, _err))
+        {
+            fs_block_free(file.blocks, file.blocksCount);
+        }
+    }
+
+finished:
+    for (uint32_t i = 0; i < _dumpsCount + 1; i++)
     {
-        CX_ERR_SET(_err, 1, "Table '%s' does not exist.", _table->name);
+        _memtable_reader_close(&readers[i]);
     }
+    free(readers);
+    free(keys);
 
-    if (_table->mtxInitialized) pthread_mutex_unlock(&_table->mtx);
     return (ERR_NONE == _err->code);
 }
 
-bool memtable_find(memtable_t* _table, uint16_t _key, table_record_t* _outRecord)
+uint32_t memtable_scan_part(const char* _tableName, uint16_t _partNumber, uint16_t _keyMin, uint16_t _keyMax, table_record_t** _outRecords, cx_err_t* _err)
 {
-    if (_table->mtxInitialized) pthread_mutex_lock(&_table->mtx);
+    // returns the most recent record of every key of the given partition within [_keyMin, _keyMax] 
+    // sorted by key. the records are owned by the caller and must be freed (values included).
+    //
+    // just like memtable_merge_part, we perform a k-way merge of our partition and dumps reading 
+    // them block by block, starting at the sparse index entry preceding the first key of our range.
+    // the records in memory are taken before listing the dumps: they only leave the memtable once 
+    // they're in a new dump, so a concurrent dump can't hide them from us.
+
+    table_t*           table = NULL;
+    memtable_reader_t* readers = NULL;  // readers[0] is our partition, the rest are the dumps.
+    uint32_t           readersCount = 0;
+    table_file_t*      dumps = NULL;
+    uint32_t           dumpsCount = 0;
+    table_record_t*    mem = NULL;      // records in memory (sorted, only the most recent one per key).
+    uint32_t           memCount = 0;
+    uint32_t           memPos = 0;
+    table_record_t*    records = NULL;
+    uint32_t           recordsCount = 0;
+    uint32_t           recordsCapacity = MEMTABLE_INITIAL_CAPACITY;
+    table_record_t*    best = NULL;
+    table_record_t     first = { 0, 0, NULL };
+    fs_file_t          file;
+    uint32_t           keyFirst = 0;
+    uint16_t           key = 0;
+    int32_t            pos = -1;
+    uint64_t           now = cx_time_epoch_ms();
+
+    (*_outRecords) = NULL;
+
+    if (!fs_table_exists(_tableName, &table))
+    {
+        CX_ERR_SET(_err, 1, "Table '%s' does not exist.", _tableName);
+        return 0;
+    }
 
-    int32_t pos = -1;
-    bool found = false;
+    // lowest key of our range belonging to this partition.
+    keyFirst = _keyMin + (_partNumber + table->meta.partitionsCount - (_keyMin % table->meta.partitionsCount)) % table->meta.partitionsCount;
+    if (keyFirst > _keyMax) return 0;
+    first.key = (uint16_t)keyFirst;
 
-    if (MEMTABLE_TYPE_DISK == _table->type || _table->recordsSorted)
+    memCount = _memtable_scan_mem(&table->memtable, table, _partNumber, first.key, _keyMax, &mem);
+
+    dumps = fs_table_dump_list(table, &dumpsCount);
+    readers = CX_MEM_ARR_ALLOC(readers, dumpsCount + 1);
+
+    for (uint32_t i = 0; i < dumpsCount + 1; i++)
     {
-        // binary search. (assume the entries in our files are sorted and contain no duplicates)
-        table_t* table = NULL;
-        if (fs_table_exists(_table->name, &table))
+        if (0 == i)
+        {
+            if (!fs_table_part_get(_tableName, _partNumber, false, &file, _err)) goto finished;
+        }
+        else
+        {
+            if (!fs_table_dump_get(_tableName, dumps[i - 1].number, dumps[i - 1].duringCompaction, &file, _err)) goto finished;
+        }
+
+        pos = (file.indexCount > 0) ? _memtable_index_find(&file, table, first.key) : -1;
+        readersCount = i + 1;
+        if (!_memtable_reader_open(&readers[i], &file, (pos < 0) ? 0 : file.indexOffsets[pos], _err)) goto finished;
+
+        while (readers[i].valid && _memtable_comp_basic(&readers[i].record, &first, &table->meta.partitionsCount) < 0)
         {
-            table_record_t keyRecord = { _key, 0, "" };
-            pos = cx_sort_find(_table->records, sizeof(table_record_t),
-                _table->recordsCount, &keyRecord, false, _memtable_comp_basic, table);
+            if (!_memtable_reader_next(&readers[i], _err)) break;
         }
+        if (ERR_NONE != _err->code) goto finished;
     }
-    else if (MEMTABLE_TYPE_MEM == _table->type)
-    {
-        // linear search ( we don't have our records sorted yet :'c )
 
-        uint64_t highestTimestamp = 0;
-        for (uint32_t i = 0; i < _table->recordsCount; i++)
+    records = CX_MEM_ARR_ALLOC(records, recordsCapacity);
+
+    while (true)
+    {
+        // pick the lowest key among our readers and the records in memory. if many of them have it, 
+        // the most recent record wins (on equal timestamps, memory wins over dumps, dumps over the partition and
+        // newer dumps over older ones, since fs_table_dump_list hands them from the oldest to the most recent one).
+        best = NULL;
+        for (uint32_t i = 0; i < readersCount; i++)
         {
-            if (_table->records[i].key == _key
-                && _table->records[i].timestamp > highestTimestamp)
+            if (!readers[i].valid
+                || (readers[i].record.key % table->meta.partitionsCount) != _partNumber
+                || readers[i].record.key > _keyMax)
+                continue;
+
+            if (NULL == best
+                || readers[i].record.key < best->key
+                || (readers[i].record.key == best->key && readers[i].record.timestamp >= best->timestamp))
             {
-                pos = i;
-                highestTimestamp = _table->records[i].timestamp;
+                best = &readers[i].record;
             }
         }
+
+        if (memPos < memCount
+            && (NULL == best
+                || mem[memPos].key < best->key
+                || (mem[memPos].key == best->key && mem[memPos].timestamp >= best->timestamp)))
+        {
+            best = &mem[memPos];
+        }
+        if (NULL == best) break;
+
+        // deleted and expired keys are skipped (along with the older records hidden by them)
+        if (!common_is_tombstone(best) && !common_is_expired(best, table->meta.ttl, now))
+        {
+            CX_MEM_ENSURE_CAPACITY(records, recordsCount, recordsCapacity);
+            records[recordsCount].key = best->key;
+            records[recordsCount].timestamp = best->timestamp;
+            records[recordsCount].value = cx_str_copy_d(best->value);
+            recordsCount++;
+        }
+
+        // move forward every source positioned at the key we just took.
+        key = best->key;
+        for (uint32_t i = 0; i < readersCount; i++)
+        {
+            if (readers[i].valid && readers[i].record.key == key)
+                _memtable_reader_next(&readers[i], _err);
+        }
+        if (memPos < memCount && mem[memPos].key == key)
+            memPos++;
+
+        if (ERR_NONE != _err->code) break;
     }
-    else
+
+finished:
+    for (uint32_t i = 0; i < readersCount; i++)
     {
-        CX_WARN(CX_ALW, "undefined memtable find behaviour for type #%d", _table->type);
+        _memtable_reader_close(&readers[i]);
     }
+    free(readers);
+    free(dumps);
 
-    if (pos >= 0)
+    for (uint32_t i = 0; i < memCount; i++)
     {
-        found = true;
-        memcpy(_outRecord, &_table->records[pos], sizeof(*_outRecord));
+        free(mem[i].value);
     }
+    free(mem);
 
-    if (_table->mtxInitialized) pthread_mutex_unlock(&_table->mtx);
-    return found;
-}
-
-/****************************************************************************************
- ***  PRIVATE FUNCTIONS
- ***************************************************************************************/
-
-static bool _memtable_init(const char* _tableName, memtable_t* _outTable, cx_err_t* _err)
-{
-    CX_CHECK_NOT_NULL(_outTable);
-    int32_t tableNameLen = strlen(_tableName);
-    CX_WARN(tableNameLen <= TABLE_NAME_LEN_MAX, "table name truncated. maximum table name length is %d characters.", TABLE_NAME_LEN_MAX);
-    CX_WARN(tableNameLen >= TABLE_NAME_LEN_MIN, "memtable_create ignored. the table name must have at least %d characters", TABLE_NAME_LEN_MIN);
-    if (tableNameLen < TABLE_NAME_LEN_MIN)
+    if (ERR_NONE != _err->code)
     {
-        CX_ERR_SET(_err, 1, "Invalid table name '%s'.", _tableName);
-        return false;
+        for (uint32_t i = 0; i < recordsCount; i++)
+        {
+            free(records[i].value);
+        }
+        free(records);
+        return 0;
     }
 
-    CX_MEM_ZERO(*_outTable);
-    cx_str_copy(_outTable->name, sizeof(_outTable->name), _tableName);
-    _outTable->recordsCount = 0;
-    _outTable->recordsCapacity = MEMTABLE_INITIAL_CAPACITY;
-    _outTable->records = CX_MEM_ARR_ALLOC(_outTable->records, _outTable->recordsCapacity);
-
-    return true;
+    (*_outRecords) = records;
+    return recordsCount;
 }
 
-static int32_t _memtable_comp_full(const void* _a, const void* _b, void* _userData)
+cx_bloom_t* memtable_make_filter(memtable_t* _table)
 {
-    // compare and determine the position of _a relative to _b
-    //
+    CX_CHECK_NOT_NULL(_table);
+
+    // builds a bloom filter containing all the keys stored in this memtable.
+    if (_table->mtxInitialized) pthread_mutex_lock(&_table->mtx);
+
+    cx_bloom_t* filter = cx_bloom_init(_table->recordsCount, LFS_FILTER_BITS_PER_KEY);
+    for (uint32_t i = 0; i < _table->recordsCount; i++)
+    {
+        cx_bloom_add(filter, &_table->records[i].key, sizeof(_table->records[i].key));
+    }
+
+    if (_table->mtxInitialized) pthread_mutex_unlock(&_table->mtx);
+    return filter;
+}
+
+bool memtable_find(memtable_t* _table, uint16_t _key, table_record_t* _outRecord)
+{
+    // if found, _outRecord gets a copy of the most recent record with the given key. 
+    // its value is owned by the caller and must be freed.
+    table_record_t* record = NULL;
+    table_record_t* frozenRecord = NULL;
+
+    if (_table->mtxInitialized) pthread_mutex_lock(&_table->mtx);
+
+    record = _memtable_find(_table, _key);
+
+    if (NULL != _table->frozen)
+    {
+        // records still being dumped. the frozen memtable can't go away while we hold our mutex.
+        if (_table->frozen->mtxInitialized) pthread_mutex_lock(&_table->frozen->mtx);
+
+        frozenRecord = _memtable_find(_table->frozen, _key);
+        if (NULL != frozenRecord && (NULL == record || frozenRecord->timestamp > record->timestamp))
+            record = frozenRecord;
+
+        if (NULL != record)
+        {
+            _outRecord->key = record->key;
+            _outRecord->timestamp = record->timestamp;
+            _outRecord->value = cx_str_copy_d(record->value);
+        }
+
+        if (_table->frozen->mtxInitialized) pthread_mutex_unlock(&_table->frozen->mtx);
+    }
+    else if (NULL != record)
+    {
+        _outRecord->key = record->key;
+        _outRecord->timestamp = record->timestamp;
+        _outRecord->value = cx_str_copy_d(record->value);
+    }
+
+    if (_table->mtxInitialized) pthread_mutex_unlock(&_table->mtx);
+    return (NULL != record);
+}
+
+/****************************************************************************************
+ ***  PRIVATE FUNCTIONS
+ ***************************************************************************************/
+
+static bool _memtable_init(const char* _tableName, uint16_t _partitionsCount, memtable_t* _outTable, cx_err_t* _err)
+{
+    CX_CHECK_NOT_NULL(_outTable);
+    int32_t tableNameLen = strlen(_tableName);
+    CX_WARN(tableNameLen <= TABLE_NAME_LEN_MAX, "table name truncated. maximum table name length is %d characters.", TABLE_NAME_LEN_MAX);
+    CX_WARN(tableNameLen >= TABLE_NAME_LEN_MIN, "memtable_create ignored. the table name must have at least %d characters", TABLE_NAME_LEN_MIN);
+    if (tableNameLen < TABLE_NAME_LEN_MIN)
+    {
+        CX_ERR_SET(_err, 1, "Invalid table name '%s'.", _tableName);
+        return false;
+    }
+
+    CX_MEM_ZERO(*_outTable);
+    cx_str_copy(_outTable->name, sizeof(_outTable->name), _tableName);
+    _outTable->partitionsCount = _partitionsCount;
+    _outTable->recordsCount = 0;
+    _outTable->recordsCapacity = MEMTABLE_INITIAL_CAPACITY;
+    _outTable->records = CX_MEM_ARR_ALLOC(_outTable->records, _outTable->recordsCapacity);
+    _outTable->arena = cx_arena_init(ARENA_CHUNK_SIZE);
+
+    return true;
+}
+
+static table_record_t* _memtable_find(memtable_t* _table, uint16_t _key)
+{
+    int32_t pos = -1;
+
+    if (MEMTABLE_TYPE_DISK == _table->type || _table->recordsSorted)
+    {
+        // binary search. (assume the entries in our files are sorted and contain no duplicates)
+        table_record_t keyRecord = { _key, 0, "" };
+        pos = cx_sort_find(_table->records, sizeof(table_record_t),
+            _table->recordsCount, &keyRecord, false, _memtable_comp_basic, &_table->partitionsCount);
+    }
+    else if (MEMTABLE_TYPE_MEM == _table->type)
+    {
+        // skiplist search. the first node matching our key holds the most recent value.
+        memtable_node_t* node = _memtable_skiplist_seek(_table, _key);
+        if (NULL != node) pos = (int32_t)node->record;
+    }
+    else
+    {
+        CX_WARN(CX_ALW, "undefined memtable find behaviour for type #%d", _table->type);
+    }
+
+    return (pos >= 0) ? &_table->records[pos] : NULL;
+}
+
+static void _memtable_swap(memtable_t* _a, memtable_t* _b)
+{
+    // swaps the contents (records, values and skiplist) of both memtables.
+    memtable_t tmp;
+    memcpy(&tmp, _a, sizeof(tmp));
+
+    _a->records = _b->records;
+    _a->arena = _b->arena;
+    _a->recordsCount = _b->recordsCount;
+    _a->recordsCapacity = _b->recordsCapacity;
+    _a->recordsSorted = _b->recordsSorted;
+    _a->skiplist = _b->skiplist;
+    _a->skiplistHeight = _b->skiplistHeight;
+    _a->skiplistSeed = _b->skiplistSeed;
+
+    _b->records = tmp.records;
+    _b->arena = tmp.arena;
+    _b->recordsCount = tmp.recordsCount;
+    _b->recordsCapacity = tmp.recordsCapacity;
+    _b->recordsSorted = tmp.recordsSorted;
+    _b->skiplist = tmp.skiplist;
+    _b->skiplistHeight = tmp.skiplistHeight;
+    _b->skiplistSeed = tmp.skiplistSeed;
+}
+
+static bool _memtable_flush(memtable_t* _frozen, cx_err_t* _err)
+{
+    // writes the records of the given frozen memtable to a new dump file.
+    // nobody else modifies a frozen memtable, concurrent selects only read it.
+    fs_file_t dumpFile;
+    CX_MEM_ZERO(dumpFile);
+
+    memtable_preprocess(_frozen);
+
+    if (_memtable_save(_frozen, &dumpFile, _err))
+    {
+        uint16_t dumpNumber = fs_table_dump_number_next(_frozen->name);
+        if (!fs_table_dump_set(_frozen->name, dumpNumber, false, &dumpFile, memtable_make_filter(_frozen), _err))
+        {
+            fs_block_free(dumpFile.blocks, dumpFile.blocksCount);
+        }
+    }
+
+    return (ERR_NONE == _err->code);
+}
+
+static int32_t _memtable_comp_full(const void* _a, const void* _b, void* _userData)
+{
+    // compare and determine the position of _a relative to _b
+    //
     // returning a negative number means _a must be placed to the left of _b.
     // returning a positive number means _a must be placed to the right of _b.
     // returning zero means _a and _b are considered equal to each other even 
@@ -360,11 +1035,11 @@ static int32_t _memtable_comp_full(const void* _a, const void* _b, void* _userDa
 
     table_record_t* a = ((table_record_t*)_a);
     table_record_t* b = ((table_record_t*)_b);
-    table_t* table = (table_t*)_userData;
+    uint16_t partitionsCount = *((uint16_t*)_userData); // number of partitions of the table.
     int64_t result = 0;
 
     // 1) compare partition numbers
-    result = (a->key % table->meta.partitionsCount) - (b->key % table->meta.partitionsCount);
+    result = (a->key % partitionsCount) - (b->key % partitionsCount);
     if (result > 0) return  1;  // _a has a partition number greater than _b.
     if (result < 0) return -1;  // _a has a partition number lower   than _b.
 
@@ -386,11 +1061,11 @@ static int32_t _memtable_comp_basic(const void* _a, const void* _b, void* _userD
 {
     table_record_t* a = ((table_record_t*)_a);
     table_record_t* b = ((table_record_t*)_b);
-    table_t* table = (table_t*)_userData;
+    uint16_t partitionsCount = *((uint16_t*)_userData); // number of partitions of the table.
     int64_t result = 0;
 
     // 1) compare partition numbers
-    result = (a->key % table->meta.partitionsCount) - (b->key % table->meta.partitionsCount);
+    result = (a->key % partitionsCount) - (b->key % partitionsCount);
     if (result > 0) return  1;  // _a has a partition number greater than _b.
     if (result < 0) return -1;  // _a has a partition number lower   than _b.
 
@@ -403,197 +1078,1547 @@ static int32_t _memtable_comp_basic(const void* _a, const void* _b, void* _userD
     return 0; 
 }
 
-static void _memtable_record_destroyer(void* _data)
+static uint32_t _memtable_sort_unique(table_record_t* _records, uint32_t _recordsCount, table_t* _tableInfo, cx_destroyer_cb _destroyer)
 {
-    table_record_t* record = (table_record_t*)_data;
-    free(record->value);
-    record->value = NULL;
-}
+    // sorts the given records by partition number (asc) and key (asc) keeping only the most recent 
+    // one of each key (the last one in the array on equal timestamps). that's the same result we'd 
+    // get sorting with _memtable_comp_full and removing duplicates with _memtable_comp_basic, 
+    // without the comparator calls nor computing the partition number on every comparison.
+    //
+    // the partition number and key of each record are packed once into a 32 bits sort key which 
+    // is sorted by a stable LSD radix sort (one byte per pass). passes where every record falls 
+    // into the same bucket (i.e. the upper bits of the partition number) are skipped. duplicates 
+    // are discarded while the records are moved to their final position.
+    if (_recordsCount < 2) return _recordsCount;
+
+    memtable_sort_entry_t*  entries = CX_MEM_ARR_ALLOC(entries, _recordsCount);
+    memtable_sort_entry_t*  temp = CX_MEM_ARR_ALLOC(temp, _recordsCount);
+    memtable_sort_entry_t*  swap = NULL;
+    table_record_t*         sorted = CX_MEM_ARR_ALLOC(sorted, _recordsCount);
+    table_record_t*         record = NULL;
+    uint32_t                sortedCount = 0;
+    uint32_t                counts[RADIX_PASSES][RADIX_BUCKETS];
+    uint32_t                offsets[RADIX_BUCKETS];
+    uint32_t                offset = 0;
+    uint32_t                bucket = 0;
+
+    CX_MEM_ZERO(counts);
+
+    // build the sort keys and the histograms of all the passes at once.
+    for (uint32_t i = 0; i < _recordsCount; i++)
+    {
+        entries[i].sortKey = ((uint32_t)(_records[i].key % _tableInfo->meta.partitionsCount) << 16) | _records[i].key;
+        entries[i].index = i;
 
-static bool _memtable_save(memtable_t* _table, fs_file_t* _outFile, cx_err_t* _err)
-{
-    // stores in the FS the serialized representation of the given memtable 
-    // with each record formated as [TIMESTAMP];[KEY];[VALUE] and a trailing 
-    // new line character (\n) as the delimiter between records.
-    
-    // if this function returns true, _outFile is the resulting filesystem file 
-    // with all the blocks allocated and written with the serialized memtable.
-       
-    if (_table->recordsCount <= 0) return false;
+        for (uint32_t p = 0; p < RADIX_PASSES; p++)
+            counts[p][(entries[i].sortKey >> (p * RADIX_BITS)) & (RADIX_BUCKETS - 1)]++;
+    }
 
-    CX_MEM_ZERO(*_outFile);
-   
-    // temporary buffer for storing a serialized table record 
-    uint32_t tmpSize = MAX_TIMESTAMP_CHARS + MAX_KEY_CHARS + MAX_VALUE_CHARS + MAX_DELIM_CHARS + 1;
-    uint32_t tmpLen = 0;
-    char*    tmp = malloc(tmpSize);
+    for (uint32_t p = 0; p < RADIX_PASSES; p++)
+    {
+        bucket = (entries[0].sortKey >> (p * RADIX_BITS)) & (RADIX_BUCKETS - 1);
+        if (counts[p][bucket] == _recordsCount) continue;
 
-    // buffer for storing a block of data
-    uint32_t buffSize = fs_block_size();
-    uint32_t buffPos = 0;
-    char*    buff = malloc(buffSize);
+        offset = 0;
+        for (uint32_t b = 0; b < RADIX_BUCKETS; b++)
+        {
+            offsets[b] = offset;
+            offset += counts[p][b];
+        }
 
-    uint32_t writableBytes = 0;
-    uint32_t remainingBytes = 0;
+        for (uint32_t i = 0; i < _recordsCount; i++)
+        {
+            bucket = (entries[i].sortKey >> (p * RADIX_BITS)) & (RADIX_BUCKETS - 1);
+            temp[offsets[bucket]++] = entries[i];
+        }
 
-    // allocate an initial block
-    if (1 == fs_block_alloc(1, &_outFile->blocks[_outFile->blocksCount]))
+        swap = entries;
+        entries = temp;
+        temp = swap;
+    }
+
+    // records of the same key are next to each other (in their original order), keep the most recent one.
+    // the array is in insertion order, so on equal timestamps the newest insertion wins.
+    for (uint32_t i = 0; i < _recordsCount; i++)
     {
-        _outFile->blocksCount++;
+        record = &_records[entries[i].index];
 
-        for (uint32_t i = 0; i < _table->recordsCount; i++)
+        if (0 == sortedCount || entries[i].sortKey != entries[i - 1].sortKey)
         {
-            
-            tmpLen = snprintf(tmp, tmpSize, "%" PRIu64 LFS_DELIM_VALUE 
-                                            "%" PRIu16 LFS_DELIM_VALUE 
-                                            "%s" LFS_DELIM_RECORD,
-                _table->records[i].timestamp,
-                _table->records[i].key,
-                _table->records[i].value);
-            
-            if (tmpLen >= tmpSize)
-            {
-                // ensure the records always terminate LFS_DELIM_RECORD, even if our temp 
-                // buffer is not enough and the value is truncated. (it's not really our 
-                // fault, the value has a length greater than the allowed one - specified
-                // in the config file)
-                CX_CHECK(CX_ALW, "temp buffer for table '%s' is not enough! the length of the value is %d but the maximum allowed is %d",
-                    _table->name, strlen(_table->records[i].value), g_ctx.cfg.valueSize);
-                tmpLen = tmpSize - 1;
-                tmp[tmpLen - 1] = LFS_DELIM_RECORD[0]; // ensure trailing LFS_DELIM_RECORD
-            }
+            sorted[sortedCount++] = *record;
+        }
+        else if (record->timestamp >= sorted[sortedCount - 1].timestamp)
+        {
+            if (NULL != _destroyer) _destroyer(&sorted[sortedCount - 1]);
+            sorted[sortedCount - 1] = *record;
+        }
+        else
+        {
+            if (NULL != _destroyer) _destroyer(record);
+        }
+    }
 
-            // increment the total file size
-            _outFile->size += tmpLen;
+    memcpy(_records, sorted, sortedCount * sizeof(_records[0]));
 
-            // write as many bytes as possible into our buffer (depending on capacity remaining)
-            writableBytes = cx_math_min(buffSize - buffPos, tmpLen);
-            remainingBytes = tmpLen - writableBytes;
+    free(entries);
+    free(temp);
+    free(sorted);
 
-            // copy the serialized record from temp to our buffer
-            memcpy(&buff[buffPos], tmp, writableBytes);
-            buffPos += writableBytes;
+    return sortedCount;
+}
 
-            // if we reached the end of the current block, flush it to disk and grab a new one
-            if (buffPos == buffSize)
-            {
-                if (!fs_block_write(_outFile->blocks[_outFile->blocksCount - 1], buff, buffSize, _err))
-                    goto failed;
+static void _memtable_record_free(void* _record)
+{
+    free(((table_record_t*)_record)->value);
+}
 
-                if (1 == fs_block_alloc(1, &_outFile->blocks[_outFile->blocksCount]))
-                {
-                    _outFile->blocksCount++;
-
-                    if (remainingBytes > 0)
-                    {
-                        // we didnt't have enough space to write our whole record serialized
-                        // let's recover those remaining bytes and put them at the begining of our buffer
-                        memmove(buff, &tmp[writableBytes], remainingBytes);
-                        buffPos = remainingBytes;
-                    }
-                    else
-                    {
-                        buffPos = 0;
-                    }
-                }
-                else
-                {
-                    CX_ERR_SET(_err, 1, "lfs block allocation failed!");
-                    goto failed;
-                }
-            }
-        }
+static uint32_t _memtable_scan_mem(memtable_t* _table, table_t* _tableInfo, uint16_t _partNumber, uint16_t _keyMin, uint16_t _keyMax, table_record_t** _outRecords)
+{
+    // copies the records of the given partition within [_keyMin, _keyMax] found in the memtable 
+    // (and the frozen one being dumped, if any) keeping only the most recent one per key.
+    memtable_t*     sources[2] = { _table, NULL };
+    table_record_t* records = NULL;
+    uint32_t        count = 0;
+    uint32_t        capacity = MEMTABLE_INITIAL_CAPACITY;
+    table_record_t* record = NULL;
 
-        if (buffPos > 0)
-        {
-            // flush our incomplete buffer to disk
-            if (!fs_block_write(_outFile->blocks[_outFile->blocksCount - 1], buff, buffPos, _err))
-                goto failed;
-        }
-        else
+    records = CX_MEM_ARR_ALLOC(records, capacity);
+
+    if (_table->mtxInitialized) pthread_mutex_lock(&_table->mtx);
+
+    // the frozen memtable can't go away while we hold our mutex.
+    sources[1] = _table->frozen;
+    if (NULL != sources[1] && sources[1]->mtxInitialized) pthread_mutex_lock(&sources[1]->mtx);
+
+    // the frozen memtable goes first since its records are older than ours (see _memtable_sort_unique).
+    for (int32_t s = 1; s >= 0; s--)
+    {
+        if (NULL == sources[s]) continue;
+
+        for (uint32_t i = 0; i < sources[s]->recordsCount; i++)
         {
-            // free the latest allocated block (we don't really need it, since our buff is empty!)
-            _outFile->blocksCount--;
-            fs_block_free(&_outFile->blocks[_outFile->blocksCount], 1);
+            record = &sources[s]->records[i];
+            if (record->key < _keyMin || record->key > _keyMax
+                || (record->key % _tableInfo->meta.partitionsCount) != _partNumber)
+                continue;
+
+            CX_MEM_ENSURE_CAPACITY(records, count, capacity);
+            records[count].key = record->key;
+            records[count].timestamp = record->timestamp;
+            records[count].value = cx_str_copy_d(record->value);
+            count++;
         }
     }
-    else
+
+    if (NULL != sources[1] && sources[1]->mtxInitialized) pthread_mutex_unlock(&sources[1]->mtx);
+    if (_table->mtxInitialized) pthread_mutex_unlock(&_table->mtx);
+
+    count = _memtable_sort_unique(records, count, _tableInfo, _memtable_record_free);
+
+    (*_outRecords) = records;
+    return count;
+}
+
+static memtable_node_t* _memtable_node_alloc(uint32_t _record, uint8_t _height)
+{
+    memtable_node_t* node = malloc(sizeof(*node) + _height * sizeof(node->next[0]));
+    CX_CHECK_NOT_NULL(node);
+
+    node->record = _record;
+    node->height = _height;
+    memset(node->next, 0, _height * sizeof(node->next[0]));
+
+    return node;
+}
+
+static uint8_t _memtable_node_height(memtable_t* _table)
+{
+    // picks a random height for a new node. each level is 4 times less likely than the
+    // previous one, which is enough for SKIPLIST_LEVELS levels to hold 4^SKIPLIST_LEVELS records.
+    uint32_t x = _table->skiplistSeed;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    _table->skiplistSeed = x;
+
+    uint8_t height = 1;
+    while (height < SKIPLIST_LEVELS && 0 == (x & 3))
     {
-        CX_ERR_SET(_err, 1, "lfs block allocation failed!");
+        height++;
+        x >>= 2;
     }
+    return height;
+}
 
-failed:
-    if (ERR_NONE != _err->code)
+static void _memtable_skiplist_clear(memtable_t* _table)
+{
+    memtable_node_t* node = _table->skiplist->next[0];
+    memtable_node_t* next = NULL;
+
+    while (NULL != node)
     {
-        // the serialization failed, free the blocks allocated (if any)
-        fs_block_free(_outFile->blocks, _outFile->blocksCount);
+        next = node->next[0];
+        free(node);
+        node = next;
     }
-    
-    free(buff);
-    free(tmp);
-    return (ERR_NONE == _err->code);
+
+    memset(_table->skiplist->next, 0, SKIPLIST_LEVELS * sizeof(_table->skiplist->next[0]));
+    _table->skiplistHeight = 1;
 }
 
-static bool _memtable_load(memtable_t* _table, char* _buff, uint32_t _buffSize, cx_err_t* _err)
+static void _memtable_skiplist_insert(memtable_t* _table, uint32_t _record)
 {
-    CX_CHECK(MEMTABLE_TYPE_DISK == _table->type, "you can only parse buffers from memtables of type DISK!");
-      
-    uint8_t  dataStage = 0;
-    uint32_t dataMaxSize = cx_math_max(MAX_VALUE_CHARS, MAX_TIMESTAMP_CHARS) + 1;
-    uint32_t dataPos = 0;
-    char*    data = malloc(dataMaxSize);
-    
-    for (uint32_t i = 0; i < _buffSize; i++)
+    // inserts the record after the ones comparing lower than it and before the ones comparing equal
+    // to it (_memtable_comp_full), therefore among records with the same key and timestamp the newest
+    // insertion wins.
+    memtable_node_t* update[SKIPLIST_LEVELS];
+    memtable_node_t* node = _table->skiplist;
+    table_record_t*  record = &_table->records[_record];
+
+    for (int32_t lvl = _table->skiplistHeight - 1; lvl >= 0; lvl--)
     {
-        if (LFS_DELIM_VALUE[0] == _buff[i])
+        while (NULL != node->next[lvl] 
+            && _memtable_comp_full(&_table->records[node->next[lvl]->record], record, &_table->partitionsCount) < 0)
         {
-            dataStage++;
+            node = node->next[lvl];
+        }
+        update[lvl] = node;
+    }
 
-            if (1 == dataStage)
-            {
-                // a new record just started.
-                // if our container is full, make some extra space.
-                if (_table->recordsCount == _table->recordsCapacity)
-                {
-                    _table->recordsCapacity *= 2;
-                    _table->records = CX_MEM_ARR_REALLOC(_table->records, _table->recordsCapacity);
-                    if (NULL == _table->records)
-                    {
-                        CX_ERR_SET(_err, 1, "oom. records array reallocation with %d elements failed!", _table->recordsCapacity);
-                        break; // we're in trouble.
-                    }
-                }
+    uint8_t height = _memtable_node_height(_table);
+    for (uint8_t lvl = _table->skiplistHeight; lvl < height; lvl++)
+    {
+        update[lvl] = _table->skiplist;
+    }
+    _table->skiplistHeight = cx_math_max(_table->skiplistHeight, height);
 
-                // initialize and parse the timestamp.
-                data[dataPos] = '\0';
-                cx_str_to_uint64(data, &_table->records[_table->recordsCount].timestamp);
-                _table->records[_table->recordsCount].value = NULL;
-            }
-            else if (2 == dataStage)
-            {
-                // second part of the record (the key).
-                data[dataPos] = '\0';
-                cx_str_to_uint16(data, &_table->records[_table->recordsCount].key);
-            }
+    node = _memtable_node_alloc(_record, height);
+    for (uint8_t lvl = 0; lvl < height; lvl++)
+    {
+        node->next[lvl] = update[lvl]->next[lvl];
+        update[lvl]->next[lvl] = node;
+    }
+}
 
-            dataPos = 0; // reset record data position
-        }
-        else if (LFS_DELIM_RECORD[0] == _buff[i])
-        {
-            // third and last part of the record (the value).
-            data[dataPos] = '\0';
-            _table->records[_table->recordsCount].value = cx_str_copy_d(data);
+static void _memtable_skiplist_rebuild(memtable_t* _table)
+{
+    // indexes the records array (already sorted and uniquified) in the skiplist.
+    // since the records come in order we can just keep appending them in O(n).
+    memtable_node_t* tail[SKIPLIST_LEVELS];
+    memtable_node_t* node = NULL;
+    uint8_t          height = 0;
+
+    _memtable_skiplist_clear(_table);
+    for (uint32_t lvl = 0; lvl < SKIPLIST_LEVELS; lvl++)
+    {
+        tail[lvl] = _table->skiplist;
+    }
 
-            _table->recordsCount++;
-            dataStage = 0;      // reset record data stage
-            dataPos = 0;        // reset record data position
+    for (uint32_t i = 0; i < _table->recordsCount; i++)
+    {
+        height = _memtable_node_height(_table);
+        node = _memtable_node_alloc(i, height);
+        for (uint8_t lvl = 0; lvl < height; lvl++)
+        {
+            tail[lvl]->next[lvl] = node;
+            tail[lvl] = node;
         }
-        else
+        _table->skiplistHeight = cx_math_max(_table->skiplistHeight, height);
+    }
+
+    _table->recordsSorted = false;
+}
+
+static memtable_node_t* _memtable_skiplist_seek(memtable_t* _table, uint16_t _key)
+{
+    // returns the first node with the given key (the one with the highest timestamp) or NULL.
+    table_record_t   keyRecord = { _key, 0, NULL };
+    memtable_node_t* node = _table->skiplist;
+
+    for (int32_t lvl = _table->skiplistHeight - 1; lvl >= 0; lvl--)
+    {
+        while (NULL != node->next[lvl] 
+            && _memtable_comp_basic(&_table->records[node->next[lvl]->record], &keyRecord, &_table->partitionsCount) < 0)
         {
-            data[dataPos++] = _buff[i];
+            node = node->next[lvl];
         }
     }
 
-    free(data);
-    return (ERR_NONE == _err->code);
-}
\ No newline at end of file
+    node = node->next[0];
+    if (NULL != node && _table->records[node->record].key == _key)
+        return node;
+
+    return NULL;
+}
+
+static void _memtable_skiplist_flatten(memtable_t* _table)
+{
+    // rewrites the records array following the order of the skiplist, keeping only the first
+    // (most recent) record of each key. the skiplist is emptied since the array is now sorted.
+    table_record_t*  sorted = CX_MEM_ARR_ALLOC(sorted, _table->recordsCapacity);
+    table_record_t*  record = NULL;
+    uint32_t         sortedCount = 0;
+
+    for (memtable_node_t* node = _table->skiplist->next[0]; NULL != node; node = node->next[0])
+    {
+        record = &_table->records[node->record];
+
+        // stale values are left in the arena until the memtable is cleared.
+        if (0 == sortedCount || sorted[sortedCount - 1].key != record->key)
+            memcpy(&sorted[sortedCount++], record, sizeof(*record));
+    }
+
+    // the skiplist is only read above, we just need the mutex to replace the records
+    // since frozen memtables are being searched concurrently while they're dumped.
+    if (_table->mtxInitialized) pthread_mutex_lock(&_table->mtx);
+
+    free(_table->records);
+    _table->records = sorted;
+    _table->recordsCount = sortedCount;
+    _table->recordsSorted = true;
+
+    _memtable_skiplist_clear(_table);
+
+    if (_table->mtxInitialized) pthread_mutex_unlock(&_table->mtx);
+}
+
+static bool _memtable_save(memtable_t* _table, fs_file_t* _outFile, cx_err_t* _err)
+{
+    // stores in the FS the serialized representation of the given memtable 
+    // using the record format of our filesystem (see fs_record_format):
+    //
+    // RECORD_FORMAT_TEXT: each record formated as [TIMESTAMP];[KEY];[VALUE] and a 
+    // trailing new line character (\n) as the delimiter between records.
+    //
+    // RECORD_FORMAT_BINARY: a LFS_RECORD_HEADER_SIZE bytes header (magic + version) 
+    // followed by each record encoded as [TIMESTAMP][KEY][VALUE_LEN][VALUE] with
+    // all the integers stored in little-endian byte order.
+    //
+    // RECORD_FORMAT_COLUMNAR: the same header followed by groups of up to a block worth of 
+    // records (see _memtable_save_group). each group stores the keys, timestamps and value 
+    // lengths of its records as separate delta/varint encoded columns followed by the values.
+    
+    // if this function returns true, _outFile is the resulting filesystem file 
+    // with all the blocks allocated and written with the serialized memtable.
+       
+    if (_table->recordsCount <= 0) return false;
+
+    memtable_writer_t writer;
+    uint32_t size = _memtable_save_size(_table, fs_record_format(), MAX_RECORD_CHARS);
+
+    if (_memtable_writer_open(&writer, _table->name, _outFile, size, _err))
+    {
+        for (uint32_t i = 0; i < _table->recordsCount; i++)
+        {
+            if (!_memtable_writer_add(&writer, &_table->records[i], _err))
+                break;
+        }
+    }
+
+    return _memtable_writer_close(&writer, _err);
+}
+
+static bool _memtable_writer_open(memtable_writer_t* _writer, const char* _tableName, fs_file_t* _outFile, uint32_t _sizeHint, cx_err_t* _err)
+{
+    // starts writing a new file. _sizeHint is the expected size of the file, we'll try to 
+    // lay it out in contiguous blocks (an extent) so that it can be read sequentially later on.
+    // if there's no free run long enough, we just allocate an initial block and keep grabbing 
+    // new blocks (wherever they are) as we need them.
+    // _memtable_writer_close must be called afterwards even if this function fails.
+    
+    CX_MEM_ZERO(*_writer);
+    CX_MEM_ZERO(*_outFile);
+
+    _writer->tableName = _tableName;
+    _writer->file = _outFile;
+    _writer->format = fs_record_format();
+    _outFile->recordFormat = _writer->format;
+    _writer->compression = fs_compression();
+    _outFile->compression = _writer->compression;
+    _outFile->oldestTimestamp = UINT64_MAX;
+
+    // temporary buffer for storing a serialized table record (or only its fixed-size fields in binary format)
+    _writer->tmpSize = MAX_RECORD_CHARS + 1;
+    _writer->tmp = malloc(cx_math_max(_writer->tmpSize, LFS_RECORD_HEADER_SIZE + LFS_RECORD_FIELDS_SIZE));
+
+    // buffer for storing a block of data
+    uint32_t buffSize = fs_block_size();
+    _writer->buffCapacity = buffSize;
+
+    if (COMPRESSION_NONE != _writer->compression)
+    {
+        // compressed files buffer several blocks worth of data and then pack as much of it 
+        // as possible into each block (see _memtable_save_block)
+        _writer->buffCapacity = buffSize * LFS_COMPRESSION_FRAME_BLOCKS;
+        _writer->frameCapacity = cx_lz_bound(_writer->buffCapacity);
+        _writer->frame = malloc(_writer->frameCapacity);
+    }
+    _writer->buff = malloc(_writer->buffCapacity);
+
+    _writer->blocksReserved = (cx_math_max(_sizeHint, 1) + buffSize - 1) / buffSize;
+    _writer->blocksReserved = cx_math_min(_writer->blocksReserved, CX_ARR_SIZE(_outFile->blocks));
+
+    if (_writer->blocksReserved != fs_block_alloc_extent(_writer->blocksReserved, _outFile->blocks))
+        _writer->blocksReserved = fs_block_alloc(1, _outFile->blocks);
+
+    if (0 == _writer->blocksReserved)
+    {
+        CX_ERR_SET(_err, 1, "lfs block allocation failed!");
+        return false;
+    }
+    _outFile->blocksCount++;
+
+    if (RECORD_FORMAT_TEXT != _writer->format)
+    {
+        uint32_t tmpLen = _memtable_encode_header(_writer->tmp, _writer->format);
+        if (!_memtable_save_bytes(_writer, _writer->tmp, tmpLen, _err))
+            return false;
+    }
+
+    return true;
+}
+
+static bool _memtable_writer_add(memtable_writer_t* _writer, const table_record_t* _record, cx_err_t* _err)
+{
+    uint32_t tmpLen = 0;
+    uint32_t valueLen = 0;
+
+    if (_record->timestamp < _writer->file->oldestTimestamp)
+        _writer->file->oldestTimestamp = _record->timestamp;
+
+    if (RECORD_FORMAT_TEXT != _writer->format)
+    {
+        // inserts never take values longer than our valueSize, but whatever gets here can't be truncated silently.
+        valueLen = strlen(_record->value);
+        if (valueLen > UINT16_MAX)
+        {
+            CX_ERR_SET(_err, ERR_GENERIC, "value of key %d from table '%s' is too long (%d bytes).", 
+                _record->key, _writer->tableName, valueLen);
+            return false;
+        }
+    }
+
+    if (RECORD_FORMAT_COLUMNAR == _writer->format)
+    {
+        // the group takes care of indexing the file since our records only start at group boundaries.
+        return _memtable_group_add(_writer, _record, (uint16_t)valueLen, _err);
+    }
+
+    _memtable_save_index(_writer->file, _record->key);
+
+    if (RECORD_FORMAT_BINARY == _writer->format)
+    {
+        tmpLen = _memtable_encode_record(_writer->tmp, _record, (uint16_t)valueLen);
+
+        return _memtable_save_bytes(_writer, _writer->tmp, tmpLen, _err)
+            && _memtable_save_bytes(_writer, _record->value, valueLen, _err);
+    }
+
+    tmpLen = snprintf(_writer->tmp, _writer->tmpSize, "%" PRIu64 LFS_DELIM_VALUE 
+                                                      "%" PRIu16 LFS_DELIM_VALUE 
+                                                      "%s" LFS_DELIM_RECORD,
+        _record->timestamp,
+        _record->key,
+        _record->value);
+    
+    if (tmpLen >= _writer->tmpSize)
+    {
+        // ensure the records always terminate LFS_DELIM_RECORD, even if our temp 
+        // buffer is not enough and the value is truncated. (it's not really our 
+        // fault, the value has a length greater than the allowed one - specified
+        // in the config file)
+        CX_CHECK(CX_ALW, "temp buffer for table '%s' is not enough! the length of the value is %d but the maximum allowed is %d",
+            _writer->tableName, strlen(_record->value), g_ctx.cfg.valueSize);
+        tmpLen = _writer->tmpSize - 1;
+        _writer->tmp[tmpLen - 1] = LFS_DELIM_RECORD[0]; // ensure trailing LFS_DELIM_RECORD
+    }
+
+    return _memtable_save_bytes(_writer, _writer->tmp, tmpLen, _err);
+}
+
+static bool _memtable_writer_close(memtable_writer_t* _writer, cx_err_t* _err)
+{
+    fs_file_t* file = _writer->file;
+
+    // flush our last (incomplete) buffer to disk. it's never empty since 
+    // _memtable_save_bytes only grabs a new block when there's data to write in it.
+    // (compressed files may still need a few more blocks to store it)
+    if (ERR_NONE == _err->code && RECORD_FORMAT_COLUMNAR == _writer->format)
+        _memtable_save_group(_writer, _err);
+
+    if (ERR_NONE == _err->code && file->blocksCount > 0)
+    {
+        while (_memtable_save_block(_writer, true, _err) && _writer->buffPos > 0);
+    }
+
+    if (ERR_NONE != _err->code)
+    {
+        // the serialization failed, free the blocks allocated (if any)
+        fs_block_free(file->blocks, cx_math_max(file->blocksCount, _writer->blocksReserved));
+    }
+    else if (file->blocksCount < _writer->blocksReserved)
+    {
+        // we reserved more blocks than needed, give them back
+        fs_block_free(&file->blocks[file->blocksCount], _writer->blocksReserved - file->blocksCount);
+    }
+    
+    free(_writer->buff);
+    _writer->buff = NULL;
+    free(_writer->frame);
+    _writer->frame = NULL;
+    for (uint32_t i = 0; i < MEMTABLE_COLUMN_COUNT; i++)
+    {
+        free(_writer->columns[i].data);
+        _writer->columns[i].data = NULL;
+    }
+    free(_writer->tmp);
+    _writer->tmp = NULL;
+
+    return (ERR_NONE == _err->code);
+}
+
+static bool _memtable_reader_open(memtable_reader_t* _reader, const fs_file_t* _file, uint32_t _offset, cx_err_t* _err)
+{
+    // starts reading the records of the given file at _offset, which must be either zero 
+    // or the offset where a record starts (see the sparse index of our files).
+    // _memtable_reader_close must be called afterwards even if this function fails.
+    uint16_t version = 0;
+
+    CX_MEM_ZERO(*_reader);
+    memcpy(&_reader->file, _file, sizeof(_reader->file));
+    _reader->format = _file->recordFormat;
+    _reader->filePos = _offset;
+
+    if (!_memtable_reader_fill(_reader, _err)) return false;
+
+    if (0 == _offset)
+    {
+        // just like _memtable_load, files starting with our magic number are in binary (or columnar) 
+        // format and anything else is considered to be a legacy text file.
+        _reader->format = RECORD_FORMAT_TEXT;
+
+        while (_reader->buffSize < LFS_RECORD_HEADER_SIZE && _reader->filePos < _reader->file.size)
+        {
+            if (!_memtable_reader_fill(_reader, _err)) return false;
+        }
+
+        if (_memtable_decode_header(_reader->buff, _reader->buffSize, &version))
+        {
+            if (!_memtable_header_format(version, &_reader->format, _err)) return false;
+            _reader->buffPos = LFS_RECORD_HEADER_SIZE;
+        }
+    }
+
+    _memtable_reader_next(_reader, _err);
+    return (ERR_NONE == _err->code);
+}
+
+static bool _memtable_reader_next(memtable_reader_t* _reader, cx_err_t* _err)
+{
+    // decodes the next record of the file (reading more blocks as needed). 
+    // returns false once there're no more records or if the file is corrupt.
+    int32_t decoded = 0;
+
+    _reader->valid = false;
+
+    while (0 == (decoded = _memtable_reader_decode(_reader, _err)))
+    {
+        // the record is incomplete, we need more bytes.
+        if (_reader->filePos >= _reader->file.size) return false;
+        if (!_memtable_reader_fill(_reader, _err)) return false;
+    }
+
+    _reader->valid = (decoded > 0);
+    return _reader->valid;
+}
+
+static bool _memtable_reader_fill(memtable_reader_t* _reader, cx_err_t* _err)
+{
+    // reads the next block or compressed frame (or whatever is left of it) of the file, 
+    // keeping the bytes pending to be decoded at the beginning of our buffer.
+    uint32_t readSize = fs_file_chunk_end(&_reader->file, _reader->filePos) - _reader->filePos;
+    uint32_t pending = _reader->buffSize - _reader->buffPos;
+
+    if (0 == readSize) return true;
+
+    memmove(_reader->buff, &_reader->buff[_reader->buffPos], pending);
+    _reader->buffSize = pending;
+    _reader->buffPos = 0;
+
+    if (_reader->buffSize + readSize > _reader->buffCapacity)
+    {
+        _reader->buffCapacity = _reader->buffSize + readSize;
+        _reader->buff = CX_MEM_ARR_REALLOC(_reader->buff, _reader->buffCapacity);
+    }
+
+    if (!fs_file_read_range(&_reader->file, _reader->filePos, readSize, &_reader->buff[_reader->buffSize], _err))
+        return false;
+
+    _reader->buffSize += readSize;
+    _reader->filePos += readSize;
+    return true;
+}
+
+static int32_t _memtable_reader_decode(memtable_reader_t* _reader, cx_err_t* _err)
+{
+    // returns 1 if a record was decoded, 0 if we need more bytes to decode it and -1 on errors.
+    char*    data = &_reader->buff[_reader->buffPos];
+    uint32_t dataSize = _reader->buffSize - _reader->buffPos;
+    uint32_t valueLen = 0;
+    uint32_t recordSize = 0;
+    uint64_t u64 = 0;
+    uint16_t u16 = 0;
+
+    if (RECORD_FORMAT_COLUMNAR == _reader->format)
+    {
+        if (NULL == _reader->group || _reader->groupPos >= _reader->group->count)
+        {
+            // decode the next group. its values stay in our buffer, which is not refilled 
+            // until we need more bytes (once we're done with every record of the group).
+            if (NULL == _reader->group) _reader->group = malloc(sizeof(*_reader->group));
+
+            int32_t groupSize = _memtable_group_decode(data, dataSize, _reader->group, _err);
+            if (groupSize <= 0)
+            {
+                _reader->group->count = 0;
+                return groupSize;
+            }
+
+            _reader->buffPos += groupSize;
+            _reader->groupPos = 0;
+        }
+
+        _reader->record.key = _reader->group->keys[_reader->groupPos];
+        _reader->record.timestamp = _reader->group->timestamps[_reader->groupPos];
+        data = (char*)&_reader->group->valuesData[_reader->group->values[_reader->groupPos]];
+        valueLen = _reader->group->values[_reader->groupPos + 1] - _reader->group->values[_reader->groupPos];
+        _reader->groupPos++;
+    }
+    else if (0 == dataSize)
+    {
+        return 0;
+    }
+    else if (RECORD_FORMAT_BINARY == _reader->format)
+    {
+        if (dataSize < LFS_RECORD_FIELDS_SIZE) return 0;
+
+        memcpy(&u64, &data[0], sizeof(u64));
+        _reader->record.timestamp = le64toh(u64);
+
+        memcpy(&u16, &data[8], sizeof(u16));
+        _reader->record.key = le16toh(u16);
+
+        memcpy(&u16, &data[10], sizeof(u16));
+        valueLen = le16toh(u16);
+
+        recordSize = LFS_RECORD_FIELDS_SIZE + valueLen;
+        if (dataSize < recordSize) return 0;
+
+        data += LFS_RECORD_FIELDS_SIZE;
+    }
+    else
+    {
+        // [TIMESTAMP];[KEY];[VALUE]\n
+        char* recordEnd = memchr(data, LFS_DELIM_RECORD[0], dataSize);
+        if (NULL == recordEnd) return 0;
+        recordSize = (recordEnd - data) + 1;
+
+        char* keyBegin = memchr(data, LFS_DELIM_VALUE[0], recordSize);
+        char* valueBegin = (NULL != keyBegin) ? memchr(keyBegin + 1, LFS_DELIM_VALUE[0], recordEnd - keyBegin) : NULL;
+        if (NULL == valueBegin)
+        {
+            CX_ERR_SET(_err, 1, "corrupt record found at position %d.", _reader->filePos - dataSize);
+            return -1;
+        }
+
+        (*keyBegin) = '\0';
+        (*valueBegin) = '\0';
+        cx_str_to_uint64(data, &_reader->record.timestamp);
+        cx_str_to_uint16(keyBegin + 1, &_reader->record.key);
+
+        valueLen = recordEnd - (valueBegin + 1);
+        data = valueBegin + 1;
+    }
+
+    if (valueLen + 1 > _reader->valueCapacity)
+    {
+        _reader->valueCapacity = valueLen + 1;
+        _reader->value = CX_MEM_ARR_REALLOC(_reader->value, _reader->valueCapacity);
+    }
+    memcpy(_reader->value, data, valueLen);
+    _reader->value[valueLen] = '\0';
+    _reader->record.value = _reader->value;
+
+    _reader->buffPos += recordSize;
+    return 1;
+}
+
+static void _memtable_reader_close(memtable_reader_t* _reader)
+{
+    free(_reader->buff);
+    _reader->buff = NULL;
+    free(_reader->value);
+    _reader->value = NULL;
+    free(_reader->group);
+    _reader->group = NULL;
+    _reader->valid = false;
+}
+
+static uint32_t _memtable_save_size(memtable_t* _table, RECORD_FORMAT _format, uint32_t _recordMaxSize)
+{
+    // returns the amount of bytes _memtable_save needs to serialize the given memtable.
+    uint32_t size = 0;
+    uint32_t valueLen = 0;
+
+    if (RECORD_FORMAT_TEXT != _format)
+    {
+        // (an upper bound for columnar files, their fields usually take less space once encoded)
+        size = LFS_RECORD_HEADER_SIZE;
+        for (uint32_t i = 0; i < _table->recordsCount; i++)
+        {
+            valueLen = strlen(_table->records[i].value);
+            size += LFS_RECORD_FIELDS_SIZE + cx_math_min(valueLen, UINT16_MAX);
+        }
+    }
+    else
+    {
+        for (uint32_t i = 0; i < _table->recordsCount; i++)
+        {
+            valueLen = snprintf(NULL, 0, "%" PRIu64 LFS_DELIM_VALUE "%" PRIu16 LFS_DELIM_VALUE, 
+                _table->records[i].timestamp, _table->records[i].key);
+            valueLen += strlen(_table->records[i].value) + sizeof(LFS_DELIM_RECORD) - 1;
+            size += cx_math_min(valueLen, _recordMaxSize);
+        }
+    }
+
+    return size;
+}
+
+static void _memtable_save_index(fs_file_t* _file, uint16_t _key)
+{
+    // builds a sparse index of the file being saved, storing the key and the offset of the
+    // first record that starts in each block. point lookups can then binary search this index
+    // and only read the range of the file which may contain the key they're looking for.
+    // this must be called right before a record starts being written.
+
+    uint32_t blockSize = fs_block_size();
+
+    if (_file->indexCount < CX_ARR_SIZE(_file->indexKeys)
+        && (0 == _file->indexCount || (_file->indexOffsets[_file->indexCount - 1] / blockSize) != (_file->size / blockSize)))
+    {
+        _file->indexKeys[_file->indexCount] = _key;
+        _file->indexOffsets[_file->indexCount] = _file->size;
+        _file->indexCount++;
+    }
+}
+
+static bool _memtable_save_bytes(memtable_writer_t* _writer, const char* _data, uint32_t _dataSize, cx_err_t* _err)
+{
+    // appends _dataSize bytes to the buffer of the writer. everytime the buffer gets full 
+    // (and there're still bytes pending to be written) it's flushed to the current 
+    // block of the file and we continue writing in the next one.
+
+    uint32_t writableBytes = 0;
+
+    while (_dataSize > 0)
+    {
+        if (_writer->buffPos == _writer->buffCapacity)
+        {
+            // we reached the end of the current block, flush it to disk and grab a new one
+            if (!_memtable_save_block(_writer, false, _err))
+                return false;
+        }
+
+        // write as many bytes as possible into our buffer (depending on capacity remaining)
+        writableBytes = cx_math_min(_writer->buffCapacity - _writer->buffPos, _dataSize);
+        memcpy(&_writer->buff[_writer->buffPos], _data, writableBytes);
+
+        _writer->buffPos += writableBytes;
+        _writer->file->size += writableBytes;
+        _data += writableBytes;
+        _dataSize -= writableBytes;
+    }
+
+    return true;
+}
+
+static bool _memtable_save_block(memtable_writer_t* _writer, bool _last, cx_err_t* _err)
+{
+    // writes the buffer of the writer to the current block of the file and continues in the
+    // next one of the blocks reserved (or a newly allocated one once we run out of them).
+    // compressed files only store in each block the frame of the longest prefix of the buffer 
+    // that fits in it, the remaining bytes are kept buffered. on the _last block of the file 
+    // we only grab a new block if there're bytes left.
+
+    fs_file_t* file = _writer->file;
+    uint32_t   bytesSaved = _writer->buffPos;
+    uint32_t   frameSize = 0;
+
+    if (COMPRESSION_NONE == _writer->compression)
+    {
+        if (!fs_block_write(file->blocks[file->blocksCount - 1], _writer->buff, _writer->buffPos, _err))
+            return false;
+    }
+    else
+    {
+        bytesSaved = _memtable_save_frame(_writer, &frameSize);
+        if (0 == bytesSaved && _writer->buffPos > 0)
+        {
+            CX_ERR_SET(_err, 1, "lfs block size is too small to store a compressed frame!");
+            return false;
+        }
+
+        file->frames[file->blocksCount - 1] = file->size - _writer->buffPos;
+        if (!fs_block_write(file->blocks[file->blocksCount - 1], _writer->frame, frameSize, _err))
+            return false;
+
+        memmove(_writer->buff, &_writer->buff[bytesSaved], _writer->buffPos - bytesSaved);
+    }
+
+    _writer->buffPos -= bytesSaved;
+    if (_last && 0 == _writer->buffPos) return true;
+
+    if (file->blocksCount >= _writer->blocksReserved
+        && (file->blocksCount == CX_ARR_SIZE(file->blocks)
+        || 1 != fs_block_alloc(1, &file->blocks[file->blocksCount])))
+    {
+        CX_ERR_SET(_err, 1, "lfs block allocation failed!");
+        return false;
+    }
+
+    file->blocksCount++;
+    return true;
+}
+
+static uint32_t _memtable_save_frame(memtable_writer_t* _writer, uint32_t* _outFrameSize)
+{
+    // compresses into the frame buffer the longest prefix of the buffer which fits in a block.
+    // returns the amount of bytes compressed (zero if not even a single byte fits).
+
+    uint32_t blockSize = fs_block_size();
+    uint32_t bytes = _writer->buffPos;
+    uint32_t frameSize = 0;
+
+    while (bytes > 0)
+    {
+        frameSize = cx_lz_compress(_writer->buff, bytes, _writer->frame, _writer->frameCapacity);
+        if (frameSize <= blockSize) break;
+
+        // the frame is too big, shrink the prefix based on the compression ratio we got (with a 5% margin).
+        bytes = cx_math_min((uint32_t)((uint64_t)bytes * blockSize * 95 / ((uint64_t)frameSize * 100)), bytes - 1);
+        frameSize = 0;
+    }
+
+    (*_outFrameSize) = frameSize;
+    return bytes;
+}
+
+static bool _memtable_save_group(memtable_writer_t* _writer, cx_err_t* _err)
+{
+    // writes the group being built as a [COUNT][KEYS_SIZE][TIMESTAMPS_SIZE][LENGTHS_SIZE][VALUES_SIZE]
+    // header (varints) followed by its columns. the sparse index of the file points to the beginning 
+    // of the groups since it's the only place where we can start decoding records.
+
+    char     header[LFS_RECORD_GROUP_HEADER_MAX];
+    uint32_t headerSize = 0;
+
+    if (0 == _writer->groupCount) return true;
+
+    headerSize += _memtable_varint_encode(&header[headerSize], _writer->groupCount);
+    for (uint32_t i = 0; i < MEMTABLE_COLUMN_COUNT; i++)
+        headerSize += _memtable_varint_encode(&header[headerSize], _writer->columns[i].size);
+
+    _memtable_save_index(_writer->file, _writer->groupKey);
+
+    if (!_memtable_save_bytes(_writer, header, headerSize, _err)) return false;
+
+    for (uint32_t i = 0; i < MEMTABLE_COLUMN_COUNT; i++)
+    {
+        if (!_memtable_save_bytes(_writer, _writer->columns[i].data, _writer->columns[i].size, _err)) return false;
+        _writer->columns[i].size = 0;
+    }
+
+    _writer->groupCount = 0;
+    CX_MEM_ZERO(_writer->groupLast);
+    return true;
+}
+
+static bool _memtable_group_add(memtable_writer_t* _writer, const table_record_t* _record, uint16_t _valueLen, cx_err_t* _err)
+{
+    // adds the record to the group being built. the group is saved right before it outgrows 
+    // a block (unless it's empty) so that we can still read the file one block at a time.
+    // keys and timestamps are stored as the (zigzag) difference with the previous record of the group.
+
+    char     fields[3 * 10];
+    uint32_t fieldsSize[3];
+    uint32_t groupSize = 0;
+    int64_t  delta = 0;
+    bool     retry = false;
+
+    do
+    {
+        delta = (int64_t)_record->key - (int64_t)_writer->groupLast.key;
+        fieldsSize[0] = _memtable_varint_encode(&fields[0], (uint64_t)((delta << 1) ^ (delta >> 63)));
+
+        delta = (int64_t)(_record->timestamp - _writer->groupLast.timestamp);
+        fieldsSize[1] = _memtable_varint_encode(&fields[10], (uint64_t)((delta << 1) ^ (delta >> 63)));
+
+        fieldsSize[2] = _memtable_varint_encode(&fields[20], _valueLen);
+
+        groupSize = fieldsSize[0] + fieldsSize[1] + fieldsSize[2] + _valueLen;
+        for (uint32_t i = 0; i < MEMTABLE_COLUMN_COUNT; i++)
+            groupSize += _writer->columns[i].size;
+
+        retry = _writer->groupCount > 0
+            && (_writer->groupCount == LFS_RECORD_GROUP_MAX_RECORDS || groupSize > fs_block_size());
+
+        // the group is full. save it and encode our record again as the first one of a new group.
+        if (retry && !_memtable_save_group(_writer, _err)) return false;
+    } while (retry);
+
+    if (0 == _writer->groupCount) _writer->groupKey = _record->key;
+
+    _memtable_column_append(&_writer->columns[MEMTABLE_COLUMN_KEYS], &fields[0], fieldsSize[0]);
+    _memtable_column_append(&_writer->columns[MEMTABLE_COLUMN_TIMESTAMPS], &fields[10], fieldsSize[1]);
+    _memtable_column_append(&_writer->columns[MEMTABLE_COLUMN_LENGTHS], &fields[20], fieldsSize[2]);
+    _memtable_column_append(&_writer->columns[MEMTABLE_COLUMN_VALUES], _record->value, _valueLen);
+
+    _writer->groupLast.key = _record->key;
+    _writer->groupLast.timestamp = _record->timestamp;
+    _writer->groupCount++;
+    return true;
+}
+
+static bool _memtable_load(memtable_t* _table, char* _buff, uint32_t _buffSize, cx_err_t* _err)
+{
+    CX_CHECK(MEMTABLE_TYPE_DISK == _table->type, "you can only parse buffers from memtables of type DISK!");
+
+    // files written in binary (or columnar) format always start with our magic number. anything else 
+    // is considered to be a legacy text file. this allows us to read files from every format
+    // regardless of the format currently configured in the filesystem metadata.
+    uint16_t      version = 0;
+    RECORD_FORMAT format = RECORD_FORMAT_TEXT;
+    if (_memtable_decode_header(_buff, _buffSize, &version))
+    {
+        if (!_memtable_header_format(version, &format, _err)) return false;
+
+        return _memtable_load_records(_table, &_buff[LFS_RECORD_HEADER_SIZE], _buffSize - LFS_RECORD_HEADER_SIZE, format, _err);
+    }
+
+    return _memtable_load_text(_table, _buff, _buffSize, _err);
+}
+
+static bool _memtable_load_records(memtable_t* _table, char* _buff, uint32_t _buffSize, RECORD_FORMAT _format, cx_err_t* _err)
+{
+    // parses a buffer containing only complete records (no header) in the given format.
+    if (RECORD_FORMAT_BINARY == _format)
+        return _memtable_load_binary(_table, _buff, _buffSize, _err);
+
+    if (RECORD_FORMAT_COLUMNAR == _format)
+        return _memtable_load_columnar(_table, _buff, _buffSize, _err);
+    
+    return _memtable_load_text(_table, _buff, _buffSize, _err);
+}
+
+static bool _memtable_load_text(memtable_t* _table, char* _buff, uint32_t _buffSize, cx_err_t* _err)
+{
+    uint8_t  dataStage = 0;
+    uint32_t dataMaxSize = cx_math_max(MAX_VALUE_CHARS, MAX_TIMESTAMP_CHARS) + 1;
+    uint32_t dataPos = 0;
+    char*    data = malloc(dataMaxSize);
+    
+    for (uint32_t i = 0; i < _buffSize; i++)
+    {
+        if (LFS_DELIM_VALUE[0] == _buff[i])
+        {
+            dataStage++;
+
+            if (1 == dataStage)
+            {
+                // a new record just started.
+                // if our container is full, make some extra space.
+                if (!_memtable_ensure_capacity(_table, 1, _err))
+                    break; // we're in trouble.
+
+                // initialize and parse the timestamp.
+                data[dataPos] = '\0';
+                cx_str_to_uint64(data, &_table->records[_table->recordsCount].timestamp);
+                _table->records[_table->recordsCount].value = NULL;
+            }
+            else if (2 == dataStage)
+            {
+                // second part of the record (the key).
+                data[dataPos] = '\0';
+                cx_str_to_uint16(data, &_table->records[_table->recordsCount].key);
+            }
+
+            dataPos = 0; // reset record data position
+        }
+        else if (LFS_DELIM_RECORD[0] == _buff[i])
+        {
+            // third and last part of the record (the value).
+            data[dataPos] = '\0';
+            _table->records[_table->recordsCount].value = cx_arena_str_copy(_table->arena, data, dataPos);
+
+            _table->recordsCount++;
+            dataStage = 0;      // reset record data stage
+            dataPos = 0;        // reset record data position
+        }
+        else
+        {
+            data[dataPos++] = _buff[i];
+        }
+    }
+
+    free(data);
+    return (ERR_NONE == _err->code);
+}
+
+static bool _memtable_load_binary(memtable_t* _table, char* _buff, uint32_t _buffSize, cx_err_t* _err)
+{
+    uint32_t        pos = 0;
+    uint16_t        valueLen = 0;
+    uint64_t        u64 = 0;
+    uint16_t        u16 = 0;
+    table_record_t* record = NULL;
+
+    while (pos < _buffSize)
+    {
+        if (pos + LFS_RECORD_FIELDS_SIZE > _buffSize)
+        {
+            CX_ERR_SET(_err, 1, "corrupt record found at position %d (truncated fields).", pos);
+            break;
+        }
+
+        if (!_memtable_ensure_capacity(_table, 1, _err))
+            break; // we're in trouble.
+
+        record = &_table->records[_table->recordsCount];
+
+        memcpy(&u64, &_buff[pos], sizeof(u64));
+        record->timestamp = le64toh(u64);
+        pos += sizeof(u64);
+
+        memcpy(&u16, &_buff[pos], sizeof(u16));
+        record->key = le16toh(u16);
+        pos += sizeof(u16);
+
+        memcpy(&u16, &_buff[pos], sizeof(u16));
+        valueLen = le16toh(u16);
+        pos += sizeof(u16);
+
+        if (pos + valueLen > _buffSize)
+        {
+            CX_ERR_SET(_err, 1, "corrupt record found at position %d (truncated value).", pos);
+            break;
+        }
+
+        record->value = cx_arena_str_copy(_table->arena, &_buff[pos], valueLen);
+        pos += valueLen;
+
+        _table->recordsCount++;
+    }
+
+    return (ERR_NONE == _err->code);
+}
+
+static bool _memtable_load_columnar(memtable_t* _table, char* _buff, uint32_t _buffSize, cx_err_t* _err)
+{
+    uint32_t          pos = 0;
+    int32_t           groupSize = 0;
+    table_record_t*   record = NULL;
+    memtable_group_t* group = malloc(sizeof(*group));
+
+    while (pos < _buffSize)
+    {
+        groupSize = _memtable_group_decode(&_buff[pos], _buffSize - pos, group, _err);
+        if (groupSize <= 0)
+        {
+            if (0 == groupSize) CX_ERR_SET(_err, 1, "corrupt group found at position %d (truncated).", pos);
+            break;
+        }
+
+        if (!_memtable_ensure_capacity(_table, group->count, _err))
+            break; // we're in trouble.
+
+        for (uint32_t i = 0; i < group->count; i++)
+        {
+            record = &_table->records[_table->recordsCount++];
+            record->key = group->keys[i];
+            record->timestamp = group->timestamps[i];
+            record->value = cx_arena_str_copy(_table->arena, &group->valuesData[group->values[i]], 
+                group->values[i + 1] - group->values[i]);
+        }
+
+        pos += groupSize;
+    }
+
+    free(group);
+    return (ERR_NONE == _err->code);
+}
+
+static bool _memtable_ensure_capacity(memtable_t* _table, uint32_t _numRecords, cx_err_t* _err)
+{
+    while (_table->recordsCount + _numRecords > _table->recordsCapacity)
+    {
+        // we need more extra space, reallocate our records array doubling its capacity
+        _table->recordsCapacity *= 2;
+        _table->records = CX_MEM_ARR_REALLOC(_table->records, _table->recordsCapacity);
+        if (NULL == _table->records)
+        {
+            CX_ERR_SET(_err, 1, "oom. records array reallocation with %d elements failed!", _table->recordsCapacity);
+            return false;
+        }
+    }
+    return true;
+}
+
+static uint32_t _memtable_encode_header(char* _buff, RECORD_FORMAT _format)
+{
+    // the version of the header tells the layout of the records that follow it.
+    uint16_t u16 = 0;
+
+    memcpy(&_buff[0], LFS_RECORD_MAGIC, sizeof(LFS_RECORD_MAGIC) - 1);
+    
+    u16 = htole16((RECORD_FORMAT_COLUMNAR == _format) ? LFS_RECORD_VERSION_COLUMNAR : LFS_RECORD_VERSION_BINARY);
+    memcpy(&_buff[4], &u16, sizeof(u16));
+
+    u16 = 0; // reserved
+    memcpy(&_buff[6], &u16, sizeof(u16));
+    
+    return LFS_RECORD_HEADER_SIZE;
+}
+
+static bool _memtable_decode_header(const char* _buff, uint32_t _buffSize, uint16_t* _outVersion)
+{
+    uint16_t u16 = 0;
+
+    if (_buffSize < LFS_RECORD_HEADER_SIZE
+        || 0 != memcmp(_buff, LFS_RECORD_MAGIC, sizeof(LFS_RECORD_MAGIC) - 1))
+        return false;
+
+    memcpy(&u16, &_buff[4], sizeof(u16));
+    (*_outVersion) = le16toh(u16);
+    return true;
+}
+
+static bool _memtable_header_format(uint16_t _version, RECORD_FORMAT* _outFormat, cx_err_t* _err)
+{
+    if (_version > LFS_RECORD_VERSION)
+    {
+        CX_ERR_SET(_err, 1, "unsupported record format version %d (latest supported version is %d).", 
+            _version, LFS_RECORD_VERSION);
+        return false;
+    }
+
+    (*_outFormat) = (LFS_RECORD_VERSION_COLUMNAR == _version) ? RECORD_FORMAT_COLUMNAR : RECORD_FORMAT_BINARY;
+    return true;
+}
+
+static uint32_t _memtable_encode_record(char* _buff, const table_record_t* _record, uint16_t _valueLen)
+{
+    // encodes the fixed-size fields of the given record. the value bytes must be written 
+    // right after these LFS_RECORD_FIELDS_SIZE bytes.
+    uint32_t pos = 0;
+    uint64_t u64 = 0;
+    uint16_t u16 = 0;
+
+    u64 = htole64(_record->timestamp);
+    memcpy(&_buff[pos], &u64, sizeof(u64));
+    pos += sizeof(u64);
+
+    u16 = htole16(_record->key);
+    memcpy(&_buff[pos], &u16, sizeof(u16));
+    pos += sizeof(u16);
+
+    u16 = htole16(_valueLen);
+    memcpy(&_buff[pos], &u16, sizeof(u16));
+    pos += sizeof(u16);
+
+    return pos;
+}
+
+static int32_t _memtable_group_decode(const char* _buff, uint32_t _buffSize, memtable_group_t* _outGroup, cx_err_t* _err)
+{
+    // decodes the keys, timestamps and value lengths of the group stored at the beginning of _buff
+    // (see _memtable_save_group). values are not copied, _outGroup->valuesData points to them.
+    // returns the size in bytes of the group, 0 if _buff doesn't contain the whole group yet and -1 on errors.
+
+    uint64_t    header[1 + MEMTABLE_COLUMN_COUNT];
+    uint32_t    groupSize = 0;
+    uint32_t    columnBegin = 0;
+    uint32_t    pos = 0;
+    uint64_t    value = 0;
+    uint64_t    last = 0;
+
+    for (uint32_t i = 0; i < CX_ARR_SIZE(header); i++)
+    {
+        if (!_memtable_varint_decode(_buff, _buffSize, &columnBegin, &header[i]))
+        {
+            if (_buffSize < LFS_RECORD_GROUP_HEADER_MAX) return 0;
+
+            CX_ERR_SET(_err, 1, "corrupt group found (invalid header).");
+            return -1;
+        }
+    }
+
+    // a group can't hold more than LFS_RECORD_GROUP_MAX_RECORDS records of up to UINT16_MAX bytes each.
+    bool valid = (header[0] > 0 && header[0] <= LFS_RECORD_GROUP_MAX_RECORDS);
+    groupSize = columnBegin;
+    for (uint32_t i = 0; valid && i < MEMTABLE_COLUMN_COUNT; i++)
+    {
+        valid = (header[1 + i] <= (uint64_t)UINT16_MAX * LFS_RECORD_GROUP_MAX_RECORDS);
+        groupSize += (uint32_t)header[1 + i];
+    }
+
+    if (!valid)
+    {
+        CX_ERR_SET(_err, 1, "corrupt group found (invalid header).");
+        return -1;
+    }
+    _outGroup->count = (uint32_t)header[0];
+    if (_buffSize < groupSize) return 0;
+
+    _outGroup->values[0] = 0;
+    for (uint32_t col = 0; col < MEMTABLE_COLUMN_VALUES; col++)
+    {
+        pos = columnBegin;
+        last = 0;
+        
+        for (uint32_t i = 0; i < _outGroup->count; i++)
+        {
+            if (!_memtable_varint_decode(_buff, columnBegin + (uint32_t)header[1 + col], &pos, &value))
+            {
+                CX_ERR_SET(_err, 1, "corrupt group found (column #%d is truncated).", col);
+                return -1;
+            }
+
+            if (MEMTABLE_COLUMN_LENGTHS == col)
+            {
+                _outGroup->values[i + 1] = _outGroup->values[i] + (uint32_t)value;
+                continue;
+            }
+
+            // undo the zigzag encoding and add the delta to the previous value of the column.
+            last += (value >> 1) ^ (~(value & 1) + 1);
+            if (MEMTABLE_COLUMN_KEYS == col)
+                _outGroup->keys[i] = (uint16_t)last;
+            else
+                _outGroup->timestamps[i] = last;
+        }
+
+        columnBegin += (uint32_t)header[1 + col];
+    }
+
+    if (_outGroup->values[_outGroup->count] != header[1 + MEMTABLE_COLUMN_VALUES])
+    {
+        CX_ERR_SET(_err, 1, "corrupt group found (values column is %d bytes but we need %d).",
+            (uint32_t)header[1 + MEMTABLE_COLUMN_VALUES], _outGroup->values[_outGroup->count]);
+        return -1;
+    }
+
+    _outGroup->valuesData = &_buff[columnBegin];
+    return (int32_t)groupSize;
+}
+
+static void _memtable_column_append(memtable_column_t* _column, const char* _data, uint32_t _dataSize)
+{
+    if (_column->size + _dataSize > _column->capacity)
+    {
+        _column->capacity = cx_math_max(_column->size + _dataSize, _column->capacity * 2);
+        _column->data = CX_MEM_ARR_REALLOC(_column->data, _column->capacity);
+    }
+
+    memcpy(&_column->data[_column->size], _data, _dataSize);
+    _column->size += _dataSize;
+}
+
+static uint32_t _memtable_varint_encode(char* _buff, uint64_t _value)
+{
+    // LEB128. 7 bits per byte (least significant group first), the highest bit tells 
+    // whether there're more bytes to come. it takes up to 10 bytes.
+    uint32_t pos = 0;
+
+    while (_value >= 0x80)
+    {
+        _buff[pos++] = (char)((_value & 0x7F) | 0x80);
+        _value >>= 7;
+    }
+    _buff[pos++] = (char)_value;
+
+    return pos;
+}
+
+static bool _memtable_varint_decode(const char* _buff, uint32_t _buffSize, uint32_t* _inOutPos, uint64_t* _outValue)
+{
+    uint64_t value = 0;
+    uint8_t  byte = 0;
+
+    for (uint32_t shift = 0; shift < 64 && (*_inOutPos) < _buffSize; shift += 7)
+    {
+        byte = (uint8_t)_buff[(*_inOutPos)++];
+        value |= (uint64_t)(byte & 0x7F) << shift;
+
+        if (0 == (byte & 0x80))
+        {
+            (*_outValue) = value;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+static bool _memtable_find_in_file(const char* _tableName, fs_file_t* _file, uint16_t _key, table_record_t* _outRecord, cx_err_t* _err)
+{
+    table_t*        table = NULL;
+    memtable_t      memt;
+    table_record_t  rec;
+    bool            found = false;
+    bool            loaded = false;
+    uint32_t        rangeBegin = 0;
+    uint32_t        rangeEnd = _file->size;
+    int32_t         pos = -1;
+
+    if (!fs_table_exists(_tableName, &table))
+    {
+        CX_ERR_SET(_err, 1, "Table '%s' does not exist.", _tableName);
+        return false;
+    }
+
+    if (0 == _file->size) return false;
+
+    if (_file->indexCount > 0)
+    {
+        // figure out the range of records which may contain our key
+        pos = _memtable_index_find(_file, table, _key);
+        if (pos < 0) return false; // our key precedes the first key in the file.
+
+        rangeBegin = _file->indexOffsets[pos];
+        rangeEnd = ((uint32_t)pos + 1 < _file->indexCount) ? _file->indexOffsets[pos + 1] : _file->size;
+    }
+
+    if (RECORD_FORMAT_COLUMNAR == _file->recordFormat)
+    {
+        // no need to parse the whole range into a memtable, we just search the key columns.
+        char* buff = malloc(rangeEnd - rangeBegin);
+        uint32_t headerSize = (0 == rangeBegin) ? LFS_RECORD_HEADER_SIZE : 0;
+
+        if (fs_file_read_range(_file, rangeBegin, rangeEnd - rangeBegin, buff, _err)
+            && rangeEnd - rangeBegin >= headerSize)
+        {
+            found = _memtable_find_in_groups(table, &buff[headerSize], rangeEnd - rangeBegin - headerSize, _key, _outRecord, _err);
+        }
+        free(buff);
+
+        return found;
+    }
+
+    if (!_memtable_init(_tableName, table->meta.partitionsCount, &memt, _err)) return false;
+    memt.type = MEMTABLE_TYPE_DISK;
+    memt.recordsSorted = true;
+
+    char* buff = malloc(rangeEnd - rangeBegin);
+    if (fs_file_read_range(_file, rangeBegin, rangeEnd - rangeBegin, buff, _err))
+    {
+        loaded = (_file->indexCount > 0)
+            ? _memtable_load_records(&memt, buff, rangeEnd - rangeBegin, _file->recordFormat, _err)
+            : _memtable_load(&memt, buff, rangeEnd - rangeBegin, _err);
+
+        if (loaded && memtable_find(&memt, _key, &rec))
+        {
+            found = true;
+            memcpy(_outRecord, &rec, sizeof(*_outRecord));
+        }
+    }
+    free(buff);
+
+    memtable_destroy(&memt);
+    return found;
+}
+
+static uint32_t _memtable_find_many_in_file(table_t* _table, fs_file_t* _file, const uint16_t* _keys, const bool* _candidates, uint32_t _keysCount, table_record_t* _outRecords, cx_err_t* _err)
+{
+    // same as _memtable_find_in_file but for several keys at once. each indexed range is read 
+    // (and parsed) only once no matter how many of our keys fall into it.
+
+    int32_t*        positions = NULL;
+    bool*           pending = NULL;
+    memtable_t      memt;
+    table_record_t  rec;
+    uint32_t        found = 0;
+    uint32_t        rangeBegin = 0;
+    uint32_t        rangeEnd = 0;
+    uint32_t        headerSize = 0;
+    int32_t         pos = -1;
+    bool            loaded = false;
+    char*           buff = NULL;
+
+    if (0 == _file->size || 0 == _keysCount) return 0;
+
+    positions = CX_MEM_ARR_ALLOC(positions, _keysCount);
+    pending = CX_MEM_ARR_ALLOC(pending, _keysCount);
+
+    for (uint32_t i = 0; i < _keysCount; i++)
+    {
+        // figure out the range of records which may contain each key (the whole file if there's no index)
+        positions[i] = (_file->indexCount > 0) ? _memtable_index_find(_file, _table, _keys[i]) : 0;
+        pending[i] = _candidates[i] && positions[i] >= 0;
+    }
+
+    for (uint32_t i = 0; i < _keysCount; i++)
+    {
+        if (!pending[i]) continue;
+        pos = positions[i];
+
+        if (_file->indexCount > 0)
+        {
+            rangeBegin = _file->indexOffsets[pos];
+            rangeEnd = ((uint32_t)pos + 1 < _file->indexCount) ? _file->indexOffsets[pos + 1] : _file->size;
+        }
+        else
+        {
+            rangeBegin = 0;
+            rangeEnd = _file->size;
+        }
+
+        buff = malloc(rangeEnd - rangeBegin);
+        if (!fs_file_read_range(_file, rangeBegin, rangeEnd - rangeBegin, buff, _err))
+        {
+            free(buff);
+            break;
+        }
+
+        if (RECORD_FORMAT_COLUMNAR == _file->recordFormat)
+        {
+            headerSize = (0 == rangeBegin) ? LFS_RECORD_HEADER_SIZE : 0;
+
+            for (uint32_t j = i; j < _keysCount; j++)
+            {
+                if (!pending[j] || positions[j] != pos) continue;
+                pending[j] = false;
+
+                if (rangeEnd - rangeBegin >= headerSize 
+                    && _memtable_find_in_groups(_table, &buff[headerSize], rangeEnd - rangeBegin - headerSize, _keys[j], &_outRecords[j], _err))
+                {
+                    found++;
+                }
+            }
+        }
+        else if (_memtable_init(_table->meta.name, _table->meta.partitionsCount, &memt, _err))
+        {
+            memt.type = MEMTABLE_TYPE_DISK;
+            memt.recordsSorted = true;
+
+            loaded = (_file->indexCount > 0)
+                ? _memtable_load_records(&memt, buff, rangeEnd - rangeBegin, _file->recordFormat, _err)
+                : _memtable_load(&memt, buff, rangeEnd - rangeBegin, _err);
+
+            for (uint32_t j = i; j < _keysCount; j++)
+            {
+                if (!pending[j] || positions[j] != pos) continue;
+                pending[j] = false;
+
+                if (loaded && memtable_find(&memt, _keys[j], &rec))
+                {
+                    memcpy(&_outRecords[j], &rec, sizeof(rec));
+                    found++;
+                }
+            }
+
+            memtable_destroy(&memt);
+        }
+        free(buff);
+    }
+
+    free(positions);
+    free(pending);
+    return found;
+}
+
+static bool _memtable_find_in_groups(table_t* _table, const char* _buff, uint32_t _buffSize, uint16_t _key, table_record_t* _outRecord, cx_err_t* _err)
+{
+    // binary searches our key in the key column of each group. only the value of the
+    // record found (the most recent one with our key) is copied to _outRecord.
+
+    table_record_t    keyRecord = { _key, 0, NULL };
+    table_record_t    groupRecord = { 0, 0, NULL };
+    memtable_group_t* group = malloc(sizeof(*group));
+    uint32_t          pos = 0;
+    uint32_t          low = 0;
+    uint32_t          high = 0;
+    uint32_t          mid = 0;
+    uint32_t          valueLen = 0;
+    int32_t           groupSize = 0;
+    bool              found = false;
+
+    while (pos < _buffSize)
+    {
+        groupSize = _memtable_group_decode(&_buff[pos], _buffSize - pos, group, _err);
+        if (groupSize <= 0) break;
+        pos += groupSize;
+
+        // first record of the group which doesn't precede our key
+        low = 0;
+        high = group->count;
+        while (low < high)
+        {
+            mid = low + (high - low) / 2;
+            groupRecord.key = group->keys[mid];
+
+            if (_memtable_comp_basic(&groupRecord, &keyRecord, &_table->meta.partitionsCount) < 0)
+                low = mid + 1;
+            else
+                high = mid;
+        }
+
+        if (low == group->count) continue; // every record of this group precedes our key.
+
+        if (group->keys[low] == _key)
+        {
+            valueLen = group->values[low + 1] - group->values[low];
+
+            _outRecord->key = _key;
+            _outRecord->timestamp = group->timestamps[low];
+            _outRecord->value = malloc(valueLen + 1);
+            memcpy(_outRecord->value, &group->valuesData[group->values[low]], valueLen);
+            _outRecord->value[valueLen] = '\0';
+            found = true;
+        }
+        break;
+    }
+
+    free(group);
+    return found;
+}
+
+static int32_t _memtable_index_find(fs_file_t* _file, table_t* _table, uint16_t _key)
+{
+    // returns the position of the last index entry with a key lower than or equal to _key 
+    // (following the order of our records) or -1 if _key precedes all of them.
+
+    table_record_t keyRecord = { _key, 0, NULL };
+    table_record_t indexRecord = { 0, 0, NULL };
+    int32_t        low = 0;
+    int32_t        high = (int32_t)_file->indexCount - 1;
+    int32_t        mid = 0;
+    int32_t        pos = -1;
+
+    while (low <= high)
+    {
+        mid = low + (high - low) / 2;
+        indexRecord.key = (uint16_t)_file->indexKeys[mid];
+
+        if (_memtable_comp_basic(&indexRecord, &keyRecord, &_table->meta.partitionsCount) <= 0)
+        {
+            pos = mid;
+            low = mid + 1;
+        }
+        else
+        {
+            high = mid - 1;
+        }
+    }
+
+    return pos;
+}
@@ -14,12 +14,20 @@
  ***  PUBLIC FUNCTIONS
  ***************************************************************************************/
 
-bool                memtable_init(const char* _tableName, bool _threadSafe, memtable_t* _outTable, cx_err_t* _err);
+bool                memtable_init(const char* _tableName, uint16_t _partitionsCount, bool _threadSafe, memtable_t* _outTable, cx_err_t* _err);
 
 bool                memtable_init_from_dump(const char* _tableName, uint16_t _dumpNumber, bool _isDuringCompaction, memtable_t* _outTable, cx_err_t* _err);
 
 bool                memtable_init_from_part(const char* _tableName, uint16_t _partNumber, bool _isDuringCompaction, memtable_t* _outTable, cx_err_t* _err);
 
+bool                memtable_find_in_dump(const char* _tableName, uint16_t _dumpNumber, bool _isDuringCompaction, uint16_t _key, table_record_t* _outRecord, cx_err_t* _err);
+
+bool                memtable_find_in_part(const char* _tableName, uint16_t _partNumber, bool _isDuringCompaction, uint16_t _key, table_record_t* _outRecord, cx_err_t* _err);
+
+uint32_t            memtable_find_many_in_dump(const char* _tableName, uint16_t _dumpNumber, bool _isDuringCompaction, const uint16_t* _keys, uint32_t _keysCount, table_record_t* _outRecords, cx_err_t* _err);
+
+uint32_t            memtable_find_many_in_part(const char* _tableName, uint16_t _partNumber, bool _isDuringCompaction, const uint16_t* _keys, uint32_t _keysCount, table_record_t* _outRecords, cx_err_t* _err);
+
 void                memtable_destroy(memtable_t* _table);
 
 void                memtable_add(memtable_t* _table, const table_record_t* _record, uint32_t _numRecords);
@@ -28,10 +36,14 @@ void                memtable_clear(memtable_t* _table);
 
 void                memtable_preprocess(memtable_t* _table);
 
+cx_bloom_t*         memtable_make_filter(memtable_t* _table);
+
 bool                memtable_find(memtable_t* _table, uint16_t _key, table_record_t* _outRecord);
 
 bool                memtable_make_dump(memtable_t* _table, cx_err_t* _err);
 
-bool                memtable_make_part(memtable_t* _table, uint16_t _partNumber, cx_err_t* _err);
+bool                memtable_merge_part(const char* _tableName, uint16_t _partNumber, const uint16_t* _dumpNumbers, uint32_t _dumpsCount, cx_err_t* _err);
+
+uint32_t            memtable_scan_part(const char* _tableName, uint16_t _partNumber, uint16_t _keyMin, uint16_t _keyMax, table_record_t** _outRecords, cx_err_t* _err);
 
 #endif // LFS_MEMTABLE_H_
\ No newline at end of file
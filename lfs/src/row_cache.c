@@ -0,0 +1,264 @@
+#include "row_cache.h"
+
+#include <cx/mem.h>
+#include <cx/str.h>
+#include <cx/math.h>
+
+#include <string.h>
+#include <pthread.h>
+
+#define ROW_CACHE_NONE      -1      // invalid slot index.
+
+typedef struct row_cache_slot_t
+{
+    uint16_t            key;                    // key of the record cached in this slot.
+    uint64_t            timestamp;              // timestamp of the record cached in this slot.
+    int32_t             next;                   // index of the next slot in the same hash bucket chain.
+    bool                used;                   // true if this slot is holding a record.
+    bool                referenced;             // CLOCK reference bit. set on every hit, cleared when the hand passes by.
+} row_cache_slot_t;
+
+struct row_cache_t
+{
+    pthread_mutex_t     mtx;                    // mutex for syncing operations on this cache.
+    row_cache_slot_t*   slots;                  // array of slotsCount slots.
+    uint32_t            slotsCount;             // number of slots (records) this cache can hold.
+    uint32_t            valueCapacity;          // capacity in bytes of the value of each slot (including the null terminator).
+    char*               values;                 // buffer of slotsCount * valueCapacity bytes holding the value of each slot.
+    int32_t*            buckets;                // hash table mapping keys to chains of slots.
+    uint32_t*           tickets;                // number of updates performed on the keys of each bucket. used to discard stale puts.
+    uint32_t            bucketsCount;           // number of buckets in our hash table (power of two).
+    uint32_t            hand;                   // CLOCK hand. next slot candidate to be evicted.
+    uint64_t            hits;                   // number of lookups found in this cache.
+    uint64_t            misses;                 // number of lookups not found in this cache.
+};
+
+/****************************************************************************************
+ ***  PRIVATE DECLARATIONS
+ ***************************************************************************************/
+
+static int32_t      _row_cache_find(row_cache_t* _cache, uint16_t _key, int32_t* _outPrev);
+
+static void         _row_cache_unlink(row_cache_t* _cache, int32_t _slot);
+
+static uint32_t     _row_cache_evict(row_cache_t* _cache);
+
+static void         _row_cache_set(row_cache_t* _cache, int32_t _slot, const table_record_t* _record);
+
+/****************************************************************************************
+ ***  PUBLIC FUNCTIONS
+ ***************************************************************************************/
+
+row_cache_t* row_cache_init(uint32_t _cacheSize, uint16_t _valueSize)
+{
+    // returns a cache holding the most recent record of up to _cacheSize bytes worth of keys 
+    // or NULL if the cache is disabled (or could not be created). every function of this 
+    // module accepts a NULL cache and behaves as if it was always empty.
+
+    uint32_t valueCapacity = (uint32_t)_valueSize + 1;
+    uint32_t slotsCount = _cacheSize / (valueCapacity + sizeof(row_cache_slot_t));
+    if (0 == slotsCount) return NULL;
+
+    row_cache_t* cache = CX_MEM_STRUCT_ALLOC(cache);
+    cache->slotsCount = slotsCount;
+    cache->valueCapacity = valueCapacity;
+
+    cache->bucketsCount = 1;
+    while (cache->bucketsCount < slotsCount * 2) cache->bucketsCount <<= 1;
+
+    cache->slots = CX_MEM_ARR_ALLOC(cache->slots, cache->slotsCount);
+    cache->values = malloc((size_t)cache->slotsCount * valueCapacity);
+    cache->buckets = malloc(cache->bucketsCount * sizeof(*cache->buckets));
+    cache->tickets = CX_MEM_ARR_ALLOC(cache->tickets, cache->bucketsCount);
+
+    if (NULL == cache->slots || NULL == cache->values || NULL == cache->buckets || NULL == cache->tickets
+        || 0 != pthread_mutex_init(&cache->mtx, NULL))
+    {
+        CX_WARN(CX_ALW, "row cache initialization failed! it will be disabled.");
+        free(cache->slots);
+        free(cache->values);
+        free(cache->buckets);
+        free(cache->tickets);
+        free(cache);
+        return NULL;
+    }
+
+    memset(cache->buckets, 0xFF, cache->bucketsCount * sizeof(*cache->buckets)); // ROW_CACHE_NONE
+    return cache;
+}
+
+void row_cache_destroy(row_cache_t* _cache)
+{
+    if (NULL == _cache) return;
+
+    pthread_mutex_destroy(&_cache->mtx);
+    free(_cache->slots);
+    free(_cache->values);
+    free(_cache->buckets);
+    free(_cache->tickets);
+    free(_cache);
+}
+
+bool row_cache_get(row_cache_t* _cache, uint16_t _key, table_record_t* _outRecord, uint32_t* _outTicket)
+{
+    // if found, _outRecord gets a copy of the cached record. its value is owned by the caller 
+    // and must be freed. on a miss, _outTicket must be given back to row_cache_put along with 
+    // the record found in the filesystem so that we never cache it if the key was updated meanwhile.
+
+    if (NULL == _cache) return false;
+
+    bool found = false;
+
+    pthread_mutex_lock(&_cache->mtx);
+    int32_t slot = _row_cache_find(_cache, _key, NULL);
+    if (ROW_CACHE_NONE != slot)
+    {
+        _cache->slots[slot].referenced = true;
+        _outRecord->key = _key;
+        _outRecord->timestamp = _cache->slots[slot].timestamp;
+        _outRecord->value = cx_str_copy_d(&_cache->values[(size_t)slot * _cache->valueCapacity]);
+        _cache->hits++;
+        found = true;
+    }
+    else
+    {
+        _cache->misses++;
+    }
+
+    if (NULL != _outTicket) (*_outTicket) = _cache->tickets[_key & (_cache->bucketsCount - 1)];
+    pthread_mutex_unlock(&_cache->mtx);
+
+    return found;
+}
+
+void row_cache_put(row_cache_t* _cache, const table_record_t* _record, uint32_t _ticket)
+{
+    if (NULL == _cache) return;
+
+    uint32_t bucket = _record->key & (_cache->bucketsCount - 1);
+
+    pthread_mutex_lock(&_cache->mtx);
+    if (_ticket == _cache->tickets[bucket] && ROW_CACHE_NONE == _row_cache_find(_cache, _record->key, NULL))
+    {
+        int32_t slot = (int32_t)_row_cache_evict(_cache);
+
+        _cache->slots[slot].key = _record->key;
+        _cache->slots[slot].used = true;
+        _cache->slots[slot].referenced = false;
+        _cache->slots[slot].next = _cache->buckets[bucket];
+        _cache->buckets[bucket] = slot;
+        _row_cache_set(_cache, slot, _record);
+    }
+    pthread_mutex_unlock(&_cache->mtx);
+}
+
+void row_cache_update(row_cache_t* _cache, const table_record_t* _record)
+{
+    // must be called every time a record is inserted in the table. if the key is cached 
+    // it keeps the most recent record between the cached one and the inserted one.
+
+    if (NULL == _cache) return;
+
+    pthread_mutex_lock(&_cache->mtx);
+    int32_t slot = _row_cache_find(_cache, _record->key, NULL);
+    if (ROW_CACHE_NONE != slot && _record->timestamp >= _cache->slots[slot].timestamp)
+    {
+        _row_cache_set(_cache, slot, _record);
+    }
+    _cache->tickets[_record->key & (_cache->bucketsCount - 1)]++;
+    pthread_mutex_unlock(&_cache->mtx);
+}
+
+void row_cache_stats(row_cache_t* _cache, uint64_t* _outHits, uint64_t* _outMisses, uint32_t* _outCapacity)
+{
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+
+    if (NULL != _cache)
+    {
+        pthread_mutex_lock(&_cache->mtx);
+        hits = _cache->hits;
+        misses = _cache->misses;
+        pthread_mutex_unlock(&_cache->mtx);
+    }
+
+    if (NULL != _outHits) (*_outHits) = hits;
+    if (NULL != _outMisses) (*_outMisses) = misses;
+    if (NULL != _outCapacity) (*_outCapacity) = (NULL != _cache) ? _cache->slotsCount : 0;
+}
+
+/****************************************************************************************
+ ***  PRIVATE FUNCTIONS
+ ***************************************************************************************/
+
+static int32_t _row_cache_find(row_cache_t* _cache, uint16_t _key, int32_t* _outPrev)
+{
+    int32_t prev = ROW_CACHE_NONE;
+    int32_t slot = _cache->buckets[_key & (_cache->bucketsCount - 1)];
+
+    while (ROW_CACHE_NONE != slot && _cache->slots[slot].key != _key)
+    {
+        prev = slot;
+        slot = _cache->slots[slot].next;
+    }
+
+    if (NULL != _outPrev) (*_outPrev) = prev;
+    return slot;
+}
+
+static void _row_cache_unlink(row_cache_t* _cache, int32_t _slot)
+{
+    // removes the given slot from its hash bucket chain and marks it as free.
+    int32_t prev = ROW_CACHE_NONE;
+    _row_cache_find(_cache, _cache->slots[_slot].key, &prev);
+
+    if (ROW_CACHE_NONE == prev)
+    {
+        _cache->buckets[_cache->slots[_slot].key & (_cache->bucketsCount - 1)] = _cache->slots[_slot].next;
+    }
+    else
+    {
+        _cache->slots[prev].next = _cache->slots[_slot].next;
+    }
+
+    _cache->slots[_slot].used = false;
+    _cache->slots[_slot].referenced = false;
+    _cache->slots[_slot].next = ROW_CACHE_NONE;
+}
+
+static uint32_t _row_cache_evict(row_cache_t* _cache)
+{
+    // CLOCK eviction: advance the hand giving a second chance to every referenced slot
+    // until we find a free slot or one which was not referenced since the last pass.
+    uint32_t slot = 0;
+
+    while (true)
+    {
+        slot = _cache->hand;
+        _cache->hand = (_cache->hand + 1) % _cache->slotsCount;
+
+        if (!_cache->slots[slot].used)
+            return slot;
+
+        if (_cache->slots[slot].referenced)
+        {
+            _cache->slots[slot].referenced = false;
+        }
+        else
+        {
+            _row_cache_unlink(_cache, (int32_t)slot);
+            return slot;
+        }
+    }
+}
+
+static void _row_cache_set(row_cache_t* _cache, int32_t _slot, const table_record_t* _record)
+{
+    // values longer than the configured valueSize are truncated (just like in our files).
+    char*    value = &_cache->values[(size_t)_slot * _cache->valueCapacity];
+    uint32_t valueLen = cx_math_min(strlen(_record->value), _cache->valueCapacity - 1);
+
+    memcpy(value, _record->value, valueLen);
+    value[valueLen] = '\0';
+    _cache->slots[_slot].timestamp = _record->timestamp;
+}
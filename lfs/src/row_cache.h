@@ -0,0 +1,28 @@
+#ifndef LFS_ROW_CACHE_H_
+#define LFS_ROW_CACHE_H_
+
+#include <ker/defines.h>
+#include <cx/cx.h>
+
+#include <stdint.h>
+#include <stdbool.h>
+
+typedef struct row_cache_t row_cache_t;
+
+/****************************************************************************************
+ ***  PUBLIC FUNCTIONS
+ ***************************************************************************************/
+
+row_cache_t*        row_cache_init(uint32_t _cacheSize, uint16_t _valueSize);
+
+void                row_cache_destroy(row_cache_t* _cache);
+
+bool                row_cache_get(row_cache_t* _cache, uint16_t _key, table_record_t* _outRecord, uint32_t* _outTicket);
+
+void                row_cache_put(row_cache_t* _cache, const table_record_t* _record, uint32_t _ticket);
+
+void                row_cache_update(row_cache_t* _cache, const table_record_t* _record);
+
+void                row_cache_stats(row_cache_t* _cache, uint64_t* _outHits, uint64_t* _outMisses, uint32_t* _outCapacity);
+
+#endif // LFS_ROW_CACHE_H_
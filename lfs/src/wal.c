@@ -0,0 +1,622 @@
+#include "wal.h"
+#include "lfs.h"
+#include "fs.h"
+#include "memtable.h"
+
+#include <cx/mem.h>
+#include <cx/file.h>
+#include <cx/str.h>
+#include <cx/math.h>
+
+#include <string.h>
+#include <stdlib.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <endian.h>
+#include <pthread.h>
+
+#define WAL_BUFFER_SIZE     4096        // initial capacity in bytes of the append buffers.
+#define WAL_DROP_MARKER     UINT32_MAX  // records count of the entries logged by wal_append_drop.
+
+typedef struct wal_ctx_t
+{
+    cx_path_t           dirPath;                // directory holding the log segments.
+    pthread_mutex_t     mtx;                    // mutex for syncing every operation on the log.
+    pthread_cond_t      cond;                   // condition signaled when a group is synced or the retired records are applied.
+    bool                mtxInitialized;         // true if mtx and cond were successfully initialized and therefore need to be destroyed.
+    int                 fd;                     // file descriptor of the segment being written.
+    uint32_t            segment;                // number of the segment being written.
+    uint32_t            segmentOffset;          // number of bytes successfully written to the current segment.
+    uint32_t            segmentOldest;          // number of the oldest segment which might still exist on disk.
+    uint32_t            segmentRetired;         // number of the last segment retired by a checkpoint.
+    char*               buffer;                 // entries appended but not yet written to the segment.
+    uint32_t            bufferSize;             // number of bytes used in buffer.
+    uint32_t            bufferCapacity;         // capacity in bytes of buffer.
+    char*               spare;                  // second buffer. swapped with buffer by the thread writing a group.
+    uint32_t            spareCapacity;          // capacity in bytes of spare.
+    uint64_t            lsnAppended;            // sequence number of the last entry appended.
+    uint64_t            lsnSynced;              // sequence number of the last entry whose group was written (successfully or not).
+    uint64_t            lsnLost;                // sequence number of the last entry whose group could not be written.
+    bool                syncing;                // true while a thread is writing a group of entries.
+    uint32_t            inflight;               // entries appended in the current epoch which are not applied to their memtables yet.
+    uint32_t            inflightRetired;        // entries appended in a retired epoch which are not applied to their memtables yet.
+    bool                checkpointing;          // true while the dumps of a checkpoint are pending.
+    bool                checkpointFailed;       // true if any dump of the current checkpoint failed.
+    uint16_t            checkpointDumps;        // number of dumps of the current checkpoint still pending.
+} wal_ctx_t;
+
+static wal_ctx_t*       m_walCtx = NULL;        // private write-ahead log context
+
+/****************************************************************************************
+ ***  PRIVATE DECLARATIONS
+ ***************************************************************************************/
+
+static void         _wal_get_segment_path(cx_path_t* _outFilePath, uint32_t _segment);
+
+static bool         _wal_parse_segment(const cx_path_t* _filePath, uint32_t* _outSegment);
+
+static bool         _wal_open(uint32_t _segment, cx_err_t* _err);
+
+static uint32_t     _wal_replay(uint32_t _segment);
+
+static uint32_t     _wal_checksum(const char* _buffer, uint32_t _size);
+
+static void         _wal_reserve(uint32_t _size);
+
+static void         _wal_checkpoint_end();
+
+/****************************************************************************************
+ ***  PUBLIC FUNCTIONS
+ ***************************************************************************************/
+
+bool wal_init(const char* _rootDir, cx_err_t* _err)
+{
+    CX_CHECK(NULL == m_walCtx, "wal is already initialized!");
+
+    m_walCtx = CX_MEM_STRUCT_ALLOC(m_walCtx);
+    m_walCtx->fd = -1;
+    cx_file_path(&m_walCtx->dirPath, "%s/%s", _rootDir, LFS_DIR_WAL);
+
+    m_walCtx->mtxInitialized = (0 == pthread_mutex_init(&m_walCtx->mtx, NULL));
+    if (m_walCtx->mtxInitialized && 0 != pthread_cond_init(&m_walCtx->cond, NULL))
+    {
+        pthread_mutex_destroy(&m_walCtx->mtx);
+        m_walCtx->mtxInitialized = false;
+    }
+    if (!m_walCtx->mtxInitialized)
+    {
+        CX_ERR_SET(_err, ERR_INIT_MTX, "wal mutex initialization failed!");
+        return false;
+    }
+
+    // filesystems bootstrapped before the log existed don't have this folder.
+    if (!cx_file_mkdir(&m_walCtx->dirPath, _err))
+    {
+        CX_ERR_SET(_err, ERR_INIT_FS_WAL, "wal directory '%s' could not be created.", m_walCtx->dirPath);
+        return false;
+    }
+
+    cx_file_explorer_t* explorer = cx_file_explorer_init(&m_walCtx->dirPath, _err);
+    cx_path_t           filePath;
+    uint32_t            segment = 0;
+    uint32_t            segmentMin = UINT32_MAX;
+    uint32_t            segmentMax = 0;
+    uint32_t            count = 0;
+
+    if (NULL == explorer)
+    {
+        CX_ERR_SET(_err, ERR_INIT_FS_WAL, "wal directory '%s' is not accessible.", m_walCtx->dirPath);
+        return false;
+    }
+
+    while (cx_file_explorer_next_file(explorer, &filePath))
+    {
+        if (_wal_parse_segment(&filePath, &segment))
+        {
+            segmentMin = cx_math_min(segmentMin, segment);
+            segmentMax = cx_math_max(segmentMax, segment);
+        }
+    }
+    cx_file_explorer_destroy(explorer);
+
+    // every record found in the log was lost along with the memtables of the previous run,
+    // so we put them back. these segments will be deleted once the next checkpoint succeeds.
+    for (segment = segmentMin; segment <= segmentMax; segment++)
+    {
+        count += _wal_replay(segment);
+    }
+    if (count > 0)
+        CX_INFO("%d records recovered from the write-ahead log.", count);
+
+    m_walCtx->segment = segmentMax + 1;
+    m_walCtx->segmentOldest = cx_math_min(segmentMin, m_walCtx->segment);
+    m_walCtx->segmentRetired = segmentMax;
+
+    m_walCtx->bufferCapacity = WAL_BUFFER_SIZE;
+    m_walCtx->buffer = malloc(m_walCtx->bufferCapacity);
+    m_walCtx->spareCapacity = WAL_BUFFER_SIZE;
+    m_walCtx->spare = malloc(m_walCtx->spareCapacity);
+
+    return _wal_open(m_walCtx->segment, _err);
+}
+
+void wal_destroy()
+{
+    if (NULL == m_walCtx) return;
+
+    if (-1 != m_walCtx->fd)
+    {
+        // last chance to persist the entries of the last group (if any).
+        if (m_walCtx->bufferSize > 0
+            && (ssize_t)m_walCtx->bufferSize == pwrite(m_walCtx->fd, m_walCtx->buffer, m_walCtx->bufferSize, m_walCtx->segmentOffset))
+        {
+            fdatasync(m_walCtx->fd);
+        }
+        close(m_walCtx->fd);
+        m_walCtx->fd = -1;
+    }
+
+    if (m_walCtx->mtxInitialized)
+    {
+        pthread_cond_destroy(&m_walCtx->cond);
+        pthread_mutex_destroy(&m_walCtx->mtx);
+        m_walCtx->mtxInitialized = false;
+    }
+
+    free(m_walCtx->buffer);
+    free(m_walCtx->spare);
+    free(m_walCtx);
+    m_walCtx = NULL;
+}
+
+uint64_t wal_append(const char* _tableName, const table_record_t* _records, uint32_t _recordsCount, uint32_t* _outEpoch)
+{
+    // appends a single entry with the given records to the log and returns its sequence number.
+    // entry: [PAYLOAD_SIZE][CHECKSUM] + [NAME_LEN][NAME][RECORDS_COUNT] + N * [TIMESTAMP][KEY][VALUE_LEN][VALUE]
+    // the records are not durable until a wal_sync call with the returned number succeeds, and the
+    // caller must call wal_applied with the given epoch right after adding them to the memtable.
+    uint8_t  nameLen = (uint8_t)strlen(_tableName);
+    uint32_t payloadSize = sizeof(nameLen) + nameLen + sizeof(uint32_t);
+    uint16_t valueLen = 0;
+    uint16_t u16 = 0;
+    uint32_t u32 = 0;
+    uint64_t u64 = 0;
+    uint64_t lsn = 0;
+
+    // values can't be longer than what VALUE_LEN holds. the same clamped length is used below
+    // when writing them, so the payload size always matches the bytes actually written.
+    for (uint32_t i = 0; i < _recordsCount; i++)
+        payloadSize += LFS_RECORD_FIELDS_SIZE + (uint32_t)strnlen(_records[i].value, UINT16_MAX);
+
+    pthread_mutex_lock(&m_walCtx->mtx);
+
+    _wal_reserve(LFS_WAL_HEADER_SIZE + payloadSize);
+    char* header = m_walCtx->buffer + m_walCtx->bufferSize;
+    char* pos = header + LFS_WAL_HEADER_SIZE;
+
+    memcpy(pos, &nameLen, sizeof(nameLen));
+    pos += sizeof(nameLen);
+    memcpy(pos, _tableName, nameLen);
+    pos += nameLen;
+    u32 = htole32(_recordsCount);
+    memcpy(pos, &u32, sizeof(u32));
+    pos += sizeof(u32);
+
+    for (uint32_t i = 0; i < _recordsCount; i++)
+    {
+        valueLen = (uint16_t)strnlen(_records[i].value, UINT16_MAX);
+
+        u64 = htole64(_records[i].timestamp);
+        memcpy(pos, &u64, sizeof(u64));
+        pos += sizeof(u64);
+        u16 = htole16(_records[i].key);
+        memcpy(pos, &u16, sizeof(u16));
+        pos += sizeof(u16);
+        u16 = htole16(valueLen);
+        memcpy(pos, &u16, sizeof(u16));
+        pos += sizeof(u16);
+        memcpy(pos, _records[i].value, valueLen);
+        pos += valueLen;
+    }
+    CX_CHECK((uint32_t)(pos - header) == LFS_WAL_HEADER_SIZE + payloadSize, "wal entry size mismatch!");
+
+    u32 = htole32(payloadSize);
+    memcpy(header, &u32, sizeof(u32));
+    u32 = htole32(_wal_checksum(header + LFS_WAL_HEADER_SIZE, payloadSize));
+    memcpy(header + sizeof(u32), &u32, sizeof(u32));
+
+    m_walCtx->bufferSize += LFS_WAL_HEADER_SIZE + payloadSize;
+    m_walCtx->inflight++;
+    lsn = ++m_walCtx->lsnAppended;
+    (*_outEpoch) = m_walCtx->segment;
+
+    pthread_mutex_unlock(&m_walCtx->mtx);
+
+    return lsn;
+}
+
+uint64_t wal_append_drop(const char* _tableName)
+{
+    // appends an entry with no records marking the given table as dropped and returns its sequence number.
+    // entry: [PAYLOAD_SIZE][CHECKSUM] + [NAME_LEN][NAME][WAL_DROP_MARKER]
+    // on replay, it discards whatever was replayed for the table so far, so a table created later with the 
+    // same name doesn't get the records of the dropped one. it must be synced before deleting the table.
+    uint8_t  nameLen = (uint8_t)strlen(_tableName);
+    uint32_t payloadSize = sizeof(nameLen) + nameLen + sizeof(uint32_t);
+    uint32_t u32 = 0;
+    uint64_t lsn = 0;
+
+    pthread_mutex_lock(&m_walCtx->mtx);
+
+    _wal_reserve(LFS_WAL_HEADER_SIZE + payloadSize);
+    char* header = m_walCtx->buffer + m_walCtx->bufferSize;
+    char* pos = header + LFS_WAL_HEADER_SIZE;
+
+    memcpy(pos, &nameLen, sizeof(nameLen));
+    pos += sizeof(nameLen);
+    memcpy(pos, _tableName, nameLen);
+    pos += nameLen;
+    u32 = htole32(WAL_DROP_MARKER);
+    memcpy(pos, &u32, sizeof(u32));
+
+    u32 = htole32(payloadSize);
+    memcpy(header, &u32, sizeof(u32));
+    u32 = htole32(_wal_checksum(header + LFS_WAL_HEADER_SIZE, payloadSize));
+    memcpy(header + sizeof(u32), &u32, sizeof(u32));
+
+    m_walCtx->bufferSize += LFS_WAL_HEADER_SIZE + payloadSize;
+    lsn = ++m_walCtx->lsnAppended;
+
+    pthread_mutex_unlock(&m_walCtx->mtx);
+
+    return lsn;
+}
+
+void wal_applied(uint32_t _epoch)
+{
+    pthread_mutex_lock(&m_walCtx->mtx);
+    if (_epoch == m_walCtx->segment)
+    {
+        m_walCtx->inflight--;
+    }
+    else if (0 == --m_walCtx->inflightRetired)
+    {
+        pthread_cond_broadcast(&m_walCtx->cond);
+    }
+    pthread_mutex_unlock(&m_walCtx->mtx);
+}
+
+bool wal_sync(uint64_t _lsn, cx_err_t* _err)
+{
+    // group commit. the first thread in need of a sync becomes the leader of the group and writes
+    // every entry appended so far with a single write + fdatasync. threads arriving meanwhile
+    // wait for it and the first one of them to find its entry still pending leads the next group.
+    bool     success = true;
+    char*    group = NULL;
+    uint32_t groupSize = 0;
+    uint32_t groupCapacity = 0;
+    uint64_t groupLsn = 0;
+    int      fd = -1;
+    off_t    offset = 0;
+
+    pthread_mutex_lock(&m_walCtx->mtx);
+    while (m_walCtx->lsnSynced < _lsn)
+    {
+        if (m_walCtx->syncing)
+        {
+            pthread_cond_wait(&m_walCtx->cond, &m_walCtx->mtx);
+            continue;
+        }
+
+        m_walCtx->syncing = true;
+        group = m_walCtx->buffer;
+        groupSize = m_walCtx->bufferSize;
+        groupCapacity = m_walCtx->bufferCapacity;
+        groupLsn = m_walCtx->lsnAppended;
+        fd = m_walCtx->fd;
+        offset = m_walCtx->segmentOffset;
+
+        m_walCtx->buffer = m_walCtx->spare;
+        m_walCtx->bufferCapacity = m_walCtx->spareCapacity;
+        m_walCtx->bufferSize = 0;
+        pthread_mutex_unlock(&m_walCtx->mtx);
+
+        success = (ssize_t)groupSize == pwrite(fd, group, groupSize, offset)
+            && 0 == fdatasync(fd);
+
+        pthread_mutex_lock(&m_walCtx->mtx);
+        m_walCtx->spare = group;
+        m_walCtx->spareCapacity = groupCapacity;
+        m_walCtx->lsnSynced = groupLsn;
+        if (success)
+        {
+            m_walCtx->segmentOffset += groupSize;
+        }
+        else
+        {
+            // the offset stays as it is, so the next group overwrites whatever was partially written.
+            m_walCtx->lsnLost = groupLsn;
+            CX_WARN(CX_ALW, "write-ahead log segment #%d could not be written. %s", m_walCtx->segment, strerror(errno));
+        }
+        m_walCtx->syncing = false;
+        pthread_cond_broadcast(&m_walCtx->cond);
+    }
+
+    // conservative. a failed group might have been written right after ours.
+    success = (_lsn > m_walCtx->lsnLost);
+    pthread_mutex_unlock(&m_walCtx->mtx);
+
+    if (!success)
+        CX_ERR_SET(_err, ERR_GENERIC, "the record could not be persisted to the write-ahead log.");
+
+    return success;
+}
+
+bool wal_checkpoint_begin()
+{
+    // starts a new checkpoint retiring the current epoch. entries appended from now on go to a new
+    // segment, and the older segments can be deleted as soon as every table dumps its memtable.
+    // only one checkpoint is allowed at a time, false is returned while the previous one is pending.
+    cx_err_t err;
+
+    pthread_mutex_lock(&m_walCtx->mtx);
+    if (m_walCtx->checkpointing)
+    {
+        pthread_mutex_unlock(&m_walCtx->mtx);
+        return false;
+    }
+
+    while (m_walCtx->syncing)
+    {
+        pthread_cond_wait(&m_walCtx->cond, &m_walCtx->mtx);
+    }
+
+    // entries still in our buffer will be written to the new segment which is fine, they're
+    // either dumped by this checkpoint or replayed from there.
+    if (_wal_open(m_walCtx->segment + 1, &err))
+    {
+        m_walCtx->segmentRetired = m_walCtx->segment - 1;
+        m_walCtx->inflightRetired += m_walCtx->inflight;
+        m_walCtx->inflight = 0;
+    }
+    else
+    {
+        CX_WARN(CX_ALW, "checkpoint skipped. %s", err.desc);
+        pthread_mutex_unlock(&m_walCtx->mtx);
+        return false;
+    }
+
+    m_walCtx->checkpointing = true;
+    m_walCtx->checkpointFailed = false;
+    m_walCtx->checkpointDumps = 0;
+    pthread_mutex_unlock(&m_walCtx->mtx);
+
+    return true;
+}
+
+void wal_checkpoint_enqueued(uint16_t _dumpsCount, bool _success)
+{
+    pthread_mutex_lock(&m_walCtx->mtx);
+    m_walCtx->checkpointDumps += _dumpsCount;
+    m_walCtx->checkpointFailed |= !_success;
+    pthread_mutex_unlock(&m_walCtx->mtx);
+
+    if (0 == _dumpsCount)
+        _wal_checkpoint_end();
+}
+
+void wal_checkpoint_wait()
+{
+    // must be called by each dump of the checkpoint before swapping its memtable. records appended
+    // to the retired segments must be in their memtables by then or we could lose them.
+    pthread_mutex_lock(&m_walCtx->mtx);
+    while (m_walCtx->inflightRetired > 0)
+    {
+        pthread_cond_wait(&m_walCtx->cond, &m_walCtx->mtx);
+    }
+    pthread_mutex_unlock(&m_walCtx->mtx);
+}
+
+void wal_checkpoint_dump_done(bool _success)
+{
+    bool finished = false;
+
+    pthread_mutex_lock(&m_walCtx->mtx);
+    if (m_walCtx->checkpointing && m_walCtx->checkpointDumps > 0)
+    {
+        m_walCtx->checkpointFailed |= !_success;
+        finished = (0 == --m_walCtx->checkpointDumps);
+    }
+    pthread_mutex_unlock(&m_walCtx->mtx);
+
+    if (finished)
+        _wal_checkpoint_end();
+}
+
+/****************************************************************************************
+ ***  PRIVATE FUNCTIONS
+ ***************************************************************************************/
+
+static void _wal_get_segment_path(cx_path_t* _outFilePath, uint32_t _segment)
+{
+    cx_file_path(_outFilePath, "%s/%u.%s", m_walCtx->dirPath, _segment, LFS_WAL_EXTENSION);
+}
+
+static bool _wal_parse_segment(const cx_path_t* _filePath, uint32_t* _outSegment)
+{
+    cx_path_t fileName;
+    char*     end = NULL;
+    cx_file_get_name(_filePath, false, &fileName);
+
+    (*_outSegment) = (uint32_t)strtoul(fileName, &end, 10);
+    return end != fileName
+        && '.' == end[0]
+        && 0 == strcmp(&end[1], LFS_WAL_EXTENSION);
+}
+
+static bool _wal_open(uint32_t _segment, cx_err_t* _err)
+{
+    cx_path_t filePath;
+    _wal_get_segment_path(&filePath, _segment);
+
+    int fd = open(filePath, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (-1 == fd)
+    {
+        CX_ERR_SET(_err, ERR_INIT_FS_WAL, "wal segment '%s' could not be created. %s", filePath, strerror(errno));
+        return false;
+    }
+
+    if (-1 != m_walCtx->fd)
+        close(m_walCtx->fd);
+
+    m_walCtx->fd = fd;
+    m_walCtx->segment = _segment;
+    m_walCtx->segmentOffset = 0;
+    return true;
+}
+
+static uint32_t _wal_replay(uint32_t _segment)
+{
+    // adds the records found in the given segment to the memtables of their tables.
+    // we stop at the first entry which is incomplete or corrupt (a write torn by a crash).
+    cx_err_t       err;
+    cx_path_t      filePath;
+    uint32_t       count = 0;
+    uint32_t       pos = 0;
+    uint32_t       payloadSize = 0;
+    uint32_t       checksum = 0;
+    uint32_t       recordsCount = 0;
+    uint8_t        nameLen = 0;
+    uint16_t       valueLen = 0;
+    uint16_t       u16 = 0;
+    uint32_t       u32 = 0;
+    uint64_t       u64 = 0;
+    table_name_t   tableName;
+    table_t*       table = NULL;
+    table_record_t record;
+    char           value[UINT16_MAX + 1];
+
+    _wal_get_segment_path(&filePath, _segment);
+    if (!cx_file_exists(&filePath)) return 0;
+
+    uint32_t size = cx_file_get_size(&filePath);
+    if (0 == size) return 0;
+
+    char* buffer = malloc(size);
+    int32_t bytesRead = cx_file_read(&filePath, buffer, size, &err);
+    if (bytesRead < 0) bytesRead = 0;
+
+    while (pos + LFS_WAL_HEADER_SIZE <= (uint32_t)bytesRead)
+    {
+        memcpy(&u32, &buffer[pos], sizeof(u32));
+        payloadSize = le32toh(u32);
+        memcpy(&u32, &buffer[pos + sizeof(u32)], sizeof(u32));
+        checksum = le32toh(u32);
+
+        if (pos + LFS_WAL_HEADER_SIZE + payloadSize > (uint32_t)bytesRead
+            || checksum != _wal_checksum(&buffer[pos + LFS_WAL_HEADER_SIZE], payloadSize))
+        {
+            CX_WARN(CX_ALW, "wal segment '%s' is truncated at offset %d. the rest of it is ignored.", filePath, pos);
+            break;
+        }
+        pos += LFS_WAL_HEADER_SIZE;
+
+        memcpy(&nameLen, &buffer[pos], sizeof(nameLen));
+        pos += sizeof(nameLen);
+        // names aren't null-terminated in the log.
+        u32 = cx_math_min((uint32_t)nameLen, (uint32_t)sizeof(tableName) - 1);
+        memcpy(tableName, &buffer[pos], u32);
+        tableName[u32] = '\0';
+        pos += nameLen;
+        memcpy(&u32, &buffer[pos], sizeof(u32));
+        recordsCount = le32toh(u32);
+        pos += sizeof(u32);
+
+        // tables dropped after the entry was written are skipped.
+        table = NULL;
+        fs_table_exists(tableName, &table);
+
+        if (WAL_DROP_MARKER == recordsCount)
+        {
+            // the table was dropped here. if it exists it was created again afterwards (or the drop
+            // didn't make it to disk), either way the records replayed so far belong to the old one.
+            if (NULL != table)
+                memtable_clear(&table->memtable);
+            continue;
+        }
+
+        for (uint32_t i = 0; i < recordsCount; i++)
+        {
+            memcpy(&u64, &buffer[pos], sizeof(u64));
+            record.timestamp = le64toh(u64);
+            pos += sizeof(u64);
+            memcpy(&u16, &buffer[pos], sizeof(u16));
+            record.key = le16toh(u16);
+            pos += sizeof(u16);
+            memcpy(&u16, &buffer[pos], sizeof(u16));
+            valueLen = le16toh(u16);
+            pos += sizeof(u16);
+            memcpy(value, &buffer[pos], valueLen);
+            value[valueLen] = '\0';
+            pos += valueLen;
+
+            if (NULL != table)
+            {
+                record.value = value;
+                memtable_add(&table->memtable, &record, 1);
+                count++;
+            }
+        }
+    }
+
+    free(buffer);
+    return count;
+}
+
+static uint32_t _wal_checksum(const char* _buffer, uint32_t _size)
+{
+    // FNV-1a
+    uint32_t hash = 2166136261u;
+    for (uint32_t i = 0; i < _size; i++)
+    {
+        hash ^= (uint8_t)_buffer[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+static void _wal_reserve(uint32_t _size)
+{
+    while (m_walCtx->bufferSize + _size > m_walCtx->bufferCapacity)
+    {
+        m_walCtx->bufferCapacity *= 2;
+        m_walCtx->buffer = CX_MEM_ARR_REALLOC(m_walCtx->buffer, m_walCtx->bufferCapacity);
+    }
+}
+
+static void _wal_checkpoint_end()
+{
+    // every record of the retired segments is in a dump by now (unless a dump failed, in that case
+    // its records went back to the memtable and the segments are kept until a checkpoint succeeds).
+    cx_err_t  err;
+    cx_path_t filePath;
+    bool      failed = false;
+    uint32_t  segmentRetired = 0;
+
+    pthread_mutex_lock(&m_walCtx->mtx);
+    failed = m_walCtx->checkpointFailed;
+    segmentRetired = m_walCtx->segmentRetired;
+    m_walCtx->checkpointing = false;
+    pthread_mutex_unlock(&m_walCtx->mtx);
+
+    if (failed) return;
+
+    for (uint32_t segment = m_walCtx->segmentOldest; segment <= segmentRetired; segment++)
+    {
+        _wal_get_segment_path(&filePath, segment);
+        if (cx_file_exists(&filePath))
+            cx_file_remove(&filePath, &err);
+    }
+    m_walCtx->segmentOldest = segmentRetired + 1;
+}
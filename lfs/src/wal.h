@@ -0,0 +1,34 @@
+#ifndef LFS_WAL_H_
+#define LFS_WAL_H_
+
+#include <ker/defines.h>
+#include <cx/cx.h>
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/****************************************************************************************
+ ***  PUBLIC FUNCTIONS
+ ***************************************************************************************/
+
+bool                wal_init(const char* _rootDir, cx_err_t* _err);
+
+void                wal_destroy();
+
+uint64_t            wal_append(const char* _tableName, const table_record_t* _records, uint32_t _recordsCount, uint32_t* _outEpoch);
+
+uint64_t            wal_append_drop(const char* _tableName);
+
+void                wal_applied(uint32_t _epoch);
+
+bool                wal_sync(uint64_t _lsn, cx_err_t* _err);
+
+bool                wal_checkpoint_begin();
+
+void                wal_checkpoint_enqueued(uint16_t _dumpsCount, bool _success);
+
+void                wal_checkpoint_wait();
+
+void                wal_checkpoint_dump_done(bool _success);
+
+#endif // LFS_WAL_H_
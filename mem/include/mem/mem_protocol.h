@@ -26,6 +26,14 @@ typedef enum
     MEMP_RES_SELECT,
     MEMP_RES_INSERT,
     MEMP_RES_GOSSIP,
+    MEMP_REQ_SELECT_BATCH,
+    MEMP_REQ_INSERT_BATCH,
+    MEMP_RES_SELECT_BATCH,
+    MEMP_RES_INSERT_BATCH,
+    MEMP_REQ_SCAN,
+    MEMP_RES_SCAN,
+    MEMP_REQ_DELETE,
+    MEMP_RES_DELETE,
 } MEM_PACKET_HEADERS;
 
 /****************************************************************************************
@@ -52,6 +60,14 @@ void mem_handle_req_select(const cx_net_common_t* _common, void* _userData, cons
 
 void mem_handle_req_insert(const cx_net_common_t* _common, void* _userData, const char* _buffer, uint16_t _bufferSize);
 
+void mem_handle_req_select_batch(const cx_net_common_t* _common, void* _userData, const char* _buffer, uint16_t _bufferSize);
+
+void mem_handle_req_insert_batch(const cx_net_common_t* _common, void* _userData, const char* _buffer, uint16_t _bufferSize);
+
+void mem_handle_req_delete(const cx_net_common_t* _common, void* _userData, const char* _buffer, uint16_t _bufferSize);
+
+void mem_handle_req_scan(const cx_net_common_t* _common, void* _userData, const char* _buffer, uint16_t _bufferSize);
+
 void mem_handle_req_gossip(const cx_net_common_t* _common, void* _userData, const char* _buffer, uint16_t _bufferSize);
 
 void mem_handle_res_create(const cx_net_common_t* _common, void* _userData, const char* _buffer, uint16_t _bufferSize);
@@ -64,6 +80,14 @@ void mem_handle_res_select(const cx_net_common_t* _common, void* _userData, cons
 
 void mem_handle_res_insert(const cx_net_common_t* _common, void* _userData, const char* _buffer, uint16_t _bufferSize);
 
+void mem_handle_res_select_batch(const cx_net_common_t* _common, void* _userData, const char* _buffer, uint16_t _bufferSize);
+
+void mem_handle_res_insert_batch(const cx_net_common_t* _common, void* _userData, const char* _buffer, uint16_t _bufferSize);
+
+void mem_handle_res_delete(const cx_net_common_t* _common, void* _userData, const char* _buffer, uint16_t _bufferSize);
+
+void mem_handle_res_scan(const cx_net_common_t* _common, void* _userData, const char* _buffer, uint16_t _bufferSize);
+
 void mem_handle_res_gossip(const cx_net_common_t* _common, void* _userData, const char* _buffer, uint16_t _bufferSize);
 
 #endif // MEM
@@ -78,7 +102,7 @@ uint32_t mem_pack_ack(char* _buffer, uint16_t _size, bool _isGossip, uint16_t _m
 
 uint32_t mem_pack_journal(char* _buffer, uint16_t _size);
 
-uint32_t mem_pack_req_create(char* _buffer, uint16_t _size, uint16_t _remoteId, const char* _tableName, uint8_t _consistency, uint16_t _numPartitions, uint32_t _compactionInterval);
+uint32_t mem_pack_req_create(char* _buffer, uint16_t _size, uint16_t _remoteId, const char* _tableName, uint8_t _consistency, uint16_t _numPartitions, uint32_t _compactionInterval, uint32_t _ttl);
 
 uint32_t mem_pack_req_drop(char* _buffer, uint16_t _size, uint16_t _remoteId, const char* _tableName);
 
@@ -88,6 +112,14 @@ uint32_t mem_pack_req_select(char* _buffer, uint16_t _size, uint16_t _remoteId,
 
 uint32_t mem_pack_req_insert(char* _buffer, uint16_t _size, uint16_t _remoteId, const char* _tableName, uint16_t _key, const char* _value, uint64_t _timestamp);
 
+uint32_t mem_pack_req_select_batch(char* _buffer, uint16_t _size, uint16_t _remoteId, const char* _tableName, const table_record_t* _records, uint16_t _recordsCount);
+
+bool mem_pack_req_insert_batch(char* _buffer, uint16_t _size, uint32_t* _pos, uint16_t _remoteId, const char* _tableName, const table_record_t* _records, uint16_t _recordsCount, uint16_t* _recordsPacked);
+
+uint32_t mem_pack_req_delete(char* _buffer, uint16_t _size, uint16_t _remoteId, const char* _tableName, uint16_t _key, uint64_t _timestamp);
+
+uint32_t mem_pack_req_scan(char* _buffer, uint16_t _size, uint16_t _remoteId, const char* _tableName, uint16_t _partition, uint16_t _keyMin, uint16_t _keyMax);
+
 uint32_t mem_pack_res_create(char* _buffer, uint16_t _size, uint16_t _remoteId, const cx_err_t* _err);
 
 uint32_t mem_pack_res_drop(char* _buffer, uint16_t _size, uint16_t _remoteId, const cx_err_t* _err);
@@ -96,4 +128,12 @@ uint32_t mem_pack_res_select(char* _buffer, uint16_t _size, uint16_t _remoteId,
 
 uint32_t mem_pack_res_insert(char* _buffer, uint16_t _size, uint16_t _remoteId, const cx_err_t* _err);
 
+bool mem_pack_res_select_batch(char* _buffer, uint16_t _size, uint32_t* _pos, uint16_t _remoteId, const cx_err_t* _err, const table_record_t* _records, uint16_t _recordsCount, uint16_t* _recordsPacked);
+
+uint32_t mem_pack_res_insert_batch(char* _buffer, uint16_t _size, uint16_t _remoteId, const cx_err_t* _err);
+
+uint32_t mem_pack_res_delete(char* _buffer, uint16_t _size, uint16_t _remoteId, const cx_err_t* _err);
+
+bool mem_pack_res_scan(char* _buffer, uint16_t _size, uint32_t* _pos, uint16_t _remoteId, const cx_err_t* _err, uint16_t _partitionsCount, const table_record_t* _records, uint32_t _recordsCount, uint32_t* _recordsPacked);
+
 #endif // MEM_PROTOCOL_H_
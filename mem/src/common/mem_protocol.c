@@ -150,6 +150,42 @@ void mem_handle_req_insert(const cx_net_common_t* _common, void* _userData, cons
     REQ_END;
 }
 
+void mem_handle_req_select_batch(const cx_net_common_t* _common, void* _userData, const char* _buffer, uint16_t _bufferSize)
+{
+    REQ_BEGIN(TASK_WT_SELECT_BATCH);
+    {
+        task->data = common_unpack_req_select_batch(_buffer, _bufferSize, &bufferPos, NULL);
+    }
+    REQ_END;
+}
+
+void mem_handle_req_insert_batch(const cx_net_common_t* _common, void* _userData, const char* _buffer, uint16_t _bufferSize)
+{
+    REQ_BEGIN(TASK_WT_INSERT_BATCH);
+    {
+        task->data = common_unpack_req_insert_batch(_buffer, _bufferSize, &bufferPos, NULL);
+    }
+    REQ_END;
+}
+
+void mem_handle_req_delete(const cx_net_common_t* _common, void* _userData, const char* _buffer, uint16_t _bufferSize)
+{
+    REQ_BEGIN(TASK_WT_DELETE);
+    {
+        task->data = common_unpack_req_delete(_buffer, _bufferSize, &bufferPos, NULL);
+    }
+    REQ_END;
+}
+
+void mem_handle_req_scan(const cx_net_common_t* _common, void* _userData, const char* _buffer, uint16_t _bufferSize)
+{
+    REQ_BEGIN(TASK_WT_SCAN);
+    {
+        task->data = common_unpack_req_scan(_buffer, _bufferSize, &bufferPos, NULL);
+    }
+    REQ_END;
+}
+
 void mem_handle_req_gossip(const cx_net_common_t* _common, void* _userData, const char* _buffer, uint16_t _bufferSize)
 {
     // KER or MEM node clients requesting our gossip table 
@@ -221,6 +257,46 @@ void mem_handle_res_insert(const cx_net_common_t* _common, void* _userData, cons
     CX_WARN(ERR_NONE == err.code, "memory journal: %s", err.desc);
 }
 
+void mem_handle_res_select_batch(const cx_net_common_t* _common, void* _userData, const char* _buffer, uint16_t _bufferSize)
+{
+    RES_BEGIN;
+    {
+        data_select_batch_t* data = task->data;
+        common_unpack_res_select_batch(_buffer, _bufferSize, &bufferPos, NULL, data, &task->err);
+        complete = (0 == data->recordsRemaining);
+    }
+    RES_END;
+}
+
+void mem_handle_res_insert_batch(const cx_net_common_t* _common, void* _userData, const char* _buffer, uint16_t _bufferSize)
+{
+    RES_BEGIN;
+    {
+        common_unpack_res_insert_batch(_buffer, _bufferSize, &bufferPos, NULL, &task->err);
+    }
+    RES_END;
+}
+
+void mem_handle_res_delete(const cx_net_common_t* _common, void* _userData, const char* _buffer, uint16_t _bufferSize)
+{
+    RES_BEGIN;
+    {
+        common_unpack_res_delete(_buffer, _bufferSize, &bufferPos, NULL, &task->err);
+    }
+    RES_END;
+}
+
+void mem_handle_res_scan(const cx_net_common_t* _common, void* _userData, const char* _buffer, uint16_t _bufferSize)
+{
+    RES_BEGIN;
+    {
+        data_scan_t* data = task->data;
+        common_unpack_res_scan(_buffer, _bufferSize, &bufferPos, NULL, data, &task->err);
+        complete = (0 == data->recordsRemaining);
+    }
+    RES_END;
+}
+
 void mem_handle_res_gossip(const cx_net_common_t* _common, void* _userData, const char* _buffer, uint16_t _bufferSize)
 {
     // gossip table arrived from MEM node server
@@ -277,9 +353,9 @@ uint32_t mem_pack_journal(char* _buffer, uint16_t _size)
     return pos;
 }
 
-uint32_t mem_pack_req_create(char* _buffer, uint16_t _size, uint16_t _remoteId, const char* _tableName, uint8_t _consistency, uint16_t _numPartitions, uint32_t _compactionInterval)
+uint32_t mem_pack_req_create(char* _buffer, uint16_t _size, uint16_t _remoteId, const char* _tableName, uint8_t _consistency, uint16_t _numPartitions, uint32_t _compactionInterval, uint32_t _ttl)
 {
-    return common_pack_req_create(_buffer, _size, _remoteId, _tableName, _consistency, _numPartitions, _compactionInterval);
+    return common_pack_req_create(_buffer, _size, _remoteId, _tableName, _consistency, _numPartitions, _compactionInterval, _ttl);
 }
 
 uint32_t mem_pack_req_drop(char* _buffer, uint16_t _size, uint16_t _remoteId, const char* _tableName)
@@ -302,6 +378,26 @@ uint32_t mem_pack_req_insert(char* _buffer, uint16_t _size, uint16_t _remoteId,
     return common_pack_req_insert(_buffer, _size, _remoteId, _tableName, _key, _value, _timestamp);
 }
 
+uint32_t mem_pack_req_select_batch(char* _buffer, uint16_t _size, uint16_t _remoteId, const char* _tableName, const table_record_t* _records, uint16_t _recordsCount)
+{
+    return common_pack_req_select_batch(_buffer, _size, _remoteId, _tableName, _records, _recordsCount);
+}
+
+bool mem_pack_req_insert_batch(char* _buffer, uint16_t _size, uint32_t* _pos, uint16_t _remoteId, const char* _tableName, const table_record_t* _records, uint16_t _recordsCount, uint16_t* _recordsPacked)
+{
+    return common_pack_req_insert_batch(_buffer, _size, _pos, _remoteId, _tableName, _records, _recordsCount, _recordsPacked);
+}
+
+uint32_t mem_pack_req_delete(char* _buffer, uint16_t _size, uint16_t _remoteId, const char* _tableName, uint16_t _key, uint64_t _timestamp)
+{
+    return common_pack_req_delete(_buffer, _size, _remoteId, _tableName, _key, _timestamp);
+}
+
+uint32_t mem_pack_req_scan(char* _buffer, uint16_t _size, uint16_t _remoteId, const char* _tableName, uint16_t _partition, uint16_t _keyMin, uint16_t _keyMax)
+{
+    return common_pack_req_scan(_buffer, _size, _remoteId, _tableName, _partition, _keyMin, _keyMax);
+}
+
 uint32_t mem_pack_res_create(char* _buffer, uint16_t _size, uint16_t _remoteId, const cx_err_t* _err)
 {
     return common_pack_res_create(_buffer, _size, _remoteId, _err);
@@ -321,3 +417,23 @@ uint32_t mem_pack_res_insert(char* _buffer, uint16_t _size, uint16_t _remoteId,
 {
     return common_pack_res_insert(_buffer, _size, _remoteId, _err);
 }
+
+bool mem_pack_res_select_batch(char* _buffer, uint16_t _size, uint32_t* _pos, uint16_t _remoteId, const cx_err_t* _err, const table_record_t* _records, uint16_t _recordsCount, uint16_t* _recordsPacked)
+{
+    return common_pack_res_select_batch(_buffer, _size, _pos, _remoteId, _records, _recordsCount, _recordsPacked, _err);
+}
+
+uint32_t mem_pack_res_insert_batch(char* _buffer, uint16_t _size, uint16_t _remoteId, const cx_err_t* _err)
+{
+    return common_pack_res_insert_batch(_buffer, _size, _remoteId, _err);
+}
+
+uint32_t mem_pack_res_delete(char* _buffer, uint16_t _size, uint16_t _remoteId, const cx_err_t* _err)
+{
+    return common_pack_res_delete(_buffer, _size, _remoteId, _err);
+}
+
+bool mem_pack_res_scan(char* _buffer, uint16_t _size, uint32_t* _pos, uint16_t _remoteId, const cx_err_t* _err, uint16_t _partitionsCount, const table_record_t* _records, uint32_t _recordsCount, uint32_t* _recordsPacked)
+{
+    return common_pack_res_scan(_buffer, _size, _pos, _remoteId, _partitionsCount, _records, _recordsCount, _recordsPacked, _err);
+}
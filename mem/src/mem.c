@@ -32,6 +32,8 @@
 #define OUTPUT_LOG_ENABLED true
 #endif 
 
+#define API_RESPONSE_TIMEOUT    5000    // milliseconds we wait for a client to make room for the next chunk of a response.
+
 mem_ctx_t           g_ctx;
 
 /****************************************************************************************
@@ -67,6 +69,11 @@ static void         api_response_drop(const task_t* _task);
 static void         api_response_describe(const task_t* _task);
 static void         api_response_select(const task_t* _task);
 static void         api_response_insert(const task_t* _task);
+static void         api_response_delete(const task_t* _task);
+static void         api_response_select_batch(const task_t* _task);
+static void         api_response_insert_batch(const task_t* _task);
+static void         api_response_scan(const task_t* _task);
+static bool         api_response_chunk(uint8_t _header, uint32_t _payloadSize, const task_t* _task);
 
 /****************************************************************************************
  ***  PUBLIC FUNCTIONS
@@ -364,6 +371,10 @@ static bool net_init(cx_err_t* _err)
     lfsCtxArgs.msgHandlers[MEMP_RES_DESCRIBE] = (cx_net_handler_cb)mem_handle_res_describe;
     lfsCtxArgs.msgHandlers[MEMP_RES_SELECT] = (cx_net_handler_cb)mem_handle_res_select;
     lfsCtxArgs.msgHandlers[MEMP_RES_INSERT] = (cx_net_handler_cb)mem_handle_res_insert;
+    lfsCtxArgs.msgHandlers[MEMP_RES_DELETE] = (cx_net_handler_cb)mem_handle_res_delete;
+    lfsCtxArgs.msgHandlers[MEMP_RES_SELECT_BATCH] = (cx_net_handler_cb)mem_handle_res_select_batch;
+    lfsCtxArgs.msgHandlers[MEMP_RES_INSERT_BATCH] = (cx_net_handler_cb)mem_handle_res_insert_batch;
+    lfsCtxArgs.msgHandlers[MEMP_RES_SCAN] = (cx_net_handler_cb)mem_handle_res_scan;
 
     // start client context
     g_ctx.lfsAvail = false;
@@ -407,6 +418,10 @@ static bool net_init(cx_err_t* _err)
     svCtxArgs.msgHandlers[MEMP_REQ_DESCRIBE] = (cx_net_handler_cb)mem_handle_req_describe;
     svCtxArgs.msgHandlers[MEMP_REQ_SELECT] = (cx_net_handler_cb)mem_handle_req_select;
     svCtxArgs.msgHandlers[MEMP_REQ_INSERT] = (cx_net_handler_cb)mem_handle_req_insert;
+    svCtxArgs.msgHandlers[MEMP_REQ_DELETE] = (cx_net_handler_cb)mem_handle_req_delete;
+    svCtxArgs.msgHandlers[MEMP_REQ_SELECT_BATCH] = (cx_net_handler_cb)mem_handle_req_select_batch;
+    svCtxArgs.msgHandlers[MEMP_REQ_INSERT_BATCH] = (cx_net_handler_cb)mem_handle_req_insert_batch;
+    svCtxArgs.msgHandlers[MEMP_REQ_SCAN] = (cx_net_handler_cb)mem_handle_req_scan;
     svCtxArgs.msgHandlers[MEMP_REQ_GOSSIP] = (cx_net_handler_cb)mem_handle_req_gossip;
 
     // start server context
@@ -443,7 +458,12 @@ static void handle_cli_command(const cx_cli_cmd_t* _cmd)
     uint8_t     consistency = 0;
     uint16_t    numPartitions = 0;
     uint32_t    compactionInterval = 0;
+    uint32_t    ttl = 0;
     uint32_t    packetSize = 0;
+    table_record_t* records = NULL;
+    uint16_t    recordsCount = 0;
+    uint16_t    partition = 0;
+    uint16_t    keyMax = 0;
 
     if (QUERY_EXIT == query)
     {
@@ -470,9 +490,9 @@ static void handle_cli_command(const cx_cli_cmd_t* _cmd)
     }
     else if (QUERY_CREATE == query)
     {
-        if (cli_parse_create(_cmd, &err, &tableName, &consistency, &numPartitions, &compactionInterval))
+        if (cli_parse_create(_cmd, &err, &tableName, &consistency, &numPartitions, &compactionInterval, &ttl))
         {
-            packetSize = mem_pack_req_create(g_ctx.buff1, sizeof(g_ctx.buff1), 0, tableName, consistency, numPartitions, compactionInterval);
+            packetSize = mem_pack_req_create(g_ctx.buff1, sizeof(g_ctx.buff1), 0, tableName, consistency, numPartitions, compactionInterval, ttl);
             mem_handle_req_create((cx_net_common_t*)g_ctx.sv, NULL, g_ctx.buff1, packetSize);
         }
     }
@@ -492,6 +512,43 @@ static void handle_cli_command(const cx_cli_cmd_t* _cmd)
             mem_handle_req_describe((cx_net_common_t*)g_ctx.sv, NULL, g_ctx.buff1, packetSize);
         }
     }
+    else if (QUERY_SELECT == query && cli_parse_is_batch(_cmd))
+    {
+        if (cli_parse_select_batch(_cmd, &err, &tableName, &records, &recordsCount))
+        {
+            packetSize = mem_pack_req_select_batch(g_ctx.buff1, sizeof(g_ctx.buff1), 0, tableName, records, recordsCount);
+            mem_handle_req_select_batch((cx_net_common_t*)g_ctx.sv, NULL, g_ctx.buff1, packetSize);
+            free(records);
+        }
+    }
+    else if (QUERY_INSERT == query && cli_parse_is_batch(_cmd))
+    {
+        if (cli_parse_insert_batch(_cmd, &err, &tableName, &records, &recordsCount))
+        {
+            uint32_t pos = 0;
+            uint16_t recordsPacked = 0;
+            if (mem_pack_req_insert_batch(g_ctx.buff1, sizeof(g_ctx.buff1), &pos, 0, tableName, records, recordsCount, &recordsPacked))
+            {
+                mem_handle_req_insert_batch((cx_net_common_t*)g_ctx.sv, NULL, g_ctx.buff1, pos);
+            }
+            else
+            {
+                CX_ERR_SET(&err, 1, "The batch is too large to be inserted at once.");
+            }
+
+            for (uint16_t i = 0; i < recordsCount; i++)
+                free(records[i].value);
+            free(records);
+        }
+    }
+    else if (QUERY_SCAN == query)
+    {
+        if (cli_parse_scan(_cmd, &err, &tableName, &partition, &key, &keyMax))
+        {
+            packetSize = mem_pack_req_scan(g_ctx.buff1, sizeof(g_ctx.buff1), 0, tableName, partition, key, keyMax);
+            mem_handle_req_scan((cx_net_common_t*)g_ctx.sv, NULL, g_ctx.buff1, packetSize);
+        }
+    }
     else if (QUERY_SELECT == query)
     {
         if (cli_parse_select(_cmd, &err, &tableName, &key))
@@ -508,6 +565,14 @@ static void handle_cli_command(const cx_cli_cmd_t* _cmd)
             mem_handle_req_insert((cx_net_common_t*)g_ctx.sv, NULL, g_ctx.buff1, packetSize);
         }
     }
+    else if (QUERY_DELETE == query)
+    {
+        if (cli_parse_delete(_cmd, &err, &tableName, &key, &timestamp))
+        {
+            packetSize = mem_pack_req_delete(g_ctx.buff1, sizeof(g_ctx.buff1), 0, tableName, key, timestamp);
+            mem_handle_req_delete((cx_net_common_t*)g_ctx.sv, NULL, g_ctx.buff1, packetSize);
+        }
+    }
     else
     {
         CX_ERR_SET(&err, 1, "Unknown command '%s'.", _cmd->header);
@@ -590,6 +655,22 @@ static bool task_run_wk(task_t* _task)
         worker_handle_insert(_task);
         break;
 
+    case TASK_WT_DELETE:
+        worker_handle_delete(_task);
+        break;
+
+    case TASK_WT_SELECT_BATCH:
+        worker_handle_select_batch(_task);
+        break;
+
+    case TASK_WT_INSERT_BATCH:
+        worker_handle_insert_batch(_task);
+        break;
+
+    case TASK_WT_SCAN:
+        worker_handle_scan(_task);
+        break;
+
     case TASK_WT_JOURNAL:
     {
         worker_handle_journal(_task);
@@ -703,6 +784,42 @@ static bool task_completed(task_t* _task)
         break;
     }
 
+    case TASK_WT_DELETE:
+    {
+        if (TASK_ORIGIN_API == _task->origin)
+            api_response_delete(_task);
+        else
+            report_delete(_task, stdout);
+        break;
+    }
+
+    case TASK_WT_SELECT_BATCH:
+    {
+        if (TASK_ORIGIN_API == _task->origin)
+            api_response_select_batch(_task);
+        else
+            report_select_batch(_task, stdout);
+        break;
+    }
+
+    case TASK_WT_INSERT_BATCH:
+    {
+        if (TASK_ORIGIN_API == _task->origin)
+            api_response_insert_batch(_task);
+        else
+            report_insert_batch(_task, stdout);
+        break;
+    }
+
+    case TASK_WT_SCAN:
+    {
+        if (TASK_ORIGIN_API == _task->origin)
+            api_response_scan(_task);
+        else
+            report_scan(_task, stdout);
+        break;
+    }
+
     case TASK_WT_JOURNAL:
     {
         data_journal_t* data = (data_journal_t*)_task->data;
@@ -829,3 +946,75 @@ static void api_response_insert(const task_t* _task)
 
     cx_net_send(g_ctx.sv, KERP_RES_INSERT, g_ctx.buff1, payloadSize, _task->clientId);
 }
+
+static void api_response_delete(const task_t* _task)
+{
+    uint32_t payloadSize = ker_pack_res_delete(g_ctx.buff1, sizeof(g_ctx.buff1),
+        _task->remoteId, &_task->err);
+
+    cx_net_send(g_ctx.sv, KERP_RES_DELETE, g_ctx.buff1, payloadSize, _task->clientId);
+}
+
+static void api_response_select_batch(const task_t* _task)
+{
+    data_select_batch_t* data = _task->data;
+    uint32_t pos = 0;
+    uint16_t recordsPacked = 0;
+
+    while (!ker_pack_res_select_batch(g_ctx.buff1, sizeof(g_ctx.buff1), &pos,
+        _task->remoteId, &_task->err, data->records, data->recordsCount, &recordsPacked))
+    {
+        if (!api_response_chunk(KERP_RES_SELECT_BATCH, pos, _task)) return;
+    }
+
+    if (pos > sizeof(uint16_t))
+    {
+        api_response_chunk(KERP_RES_SELECT_BATCH, pos, _task);
+    }
+}
+
+static void api_response_insert_batch(const task_t* _task)
+{
+    uint32_t payloadSize = ker_pack_res_insert_batch(g_ctx.buff1, sizeof(g_ctx.buff1),
+        _task->remoteId, &_task->err);
+
+    cx_net_send(g_ctx.sv, KERP_RES_INSERT_BATCH, g_ctx.buff1, payloadSize, _task->clientId);
+}
+
+static void api_response_scan(const task_t* _task)
+{
+    data_scan_t* data = _task->data;
+    uint32_t pos = 0;
+    uint32_t recordsPacked = 0;
+
+    while (!ker_pack_res_scan(g_ctx.buff1, sizeof(g_ctx.buff1), &pos,
+        _task->remoteId, &_task->err, data->partitionsCount, data->records, data->recordsCount, &recordsPacked))
+    {
+        if (!api_response_chunk(KERP_RES_SCAN, pos, _task)) return;
+    }
+
+    if (pos > sizeof(uint16_t))
+    {
+        api_response_chunk(KERP_RES_SCAN, pos, _task);
+    }
+}
+
+static bool api_response_chunk(uint8_t _header, uint32_t _payloadSize, const task_t* _task)
+{
+    // sends the chunk in g_ctx.buff1. the client keeps waiting until it gets every chunk of the response,
+    // so none of them can be dropped: we wait for room in the outbound buffer when it's full and if it 
+    // doesn't make room in time we disconnect it (its pending requests fail right away that way).
+    int32_t result = cx_net_send(g_ctx.sv, _header, g_ctx.buff1, _payloadSize, _task->clientId);
+
+    while (CX_NET_SEND_BUFFER_FULL == result)
+    {
+        if (!cx_net_wait_outboundbuff(g_ctx.sv, _task->clientId, API_RESPONSE_TIMEOUT))
+        {
+            cx_net_disconnect(g_ctx.sv, _task->clientId, "outbound buffer full, the client is not reading our responses");
+            return false;
+        }
+        result = cx_net_send(g_ctx.sv, _header, g_ctx.buff1, _payloadSize, _task->clientId);
+    }
+
+    return (CX_NET_SEND_OK == result);
+}
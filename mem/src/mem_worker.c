@@ -3,6 +3,7 @@
 #include "mm.h"
 
 #include <ker/defines.h>
+#include <ker/common.h>
 #include <lfs/lfs_protocol.h>
 
 #include <cx/cx.h>
@@ -10,6 +11,8 @@
 #include <cx/str.h>
 #include <cx/file.h>
 #include <cx/timer.h>
+#include <cx/math.h>
+#include <cx/sort.h>
 
 #include <unistd.h>
 
@@ -21,6 +24,14 @@ static void         _worker_parse_result(task_t* _req, segment_t* _affectedTable
 
 static bool         _worker_request_lfs(uint8_t _header, const char* _payload, uint32_t _payloadSize, task_t* _task);
 
+static void         _worker_scan_merge_modified(segment_t* _table, data_scan_t* _data);
+
+static int32_t      _worker_scan_comp_full(const void* _a, const void* _b, void* _userData);
+
+static int32_t      _worker_scan_comp_key(const void* _a, const void* _b, void* _userData);
+
+static void         _worker_scan_record_free(void* _record);
+
 /****************************************************************************************
 ***  PUBLIC FUNCTIONS
 ***************************************************************************************/
@@ -32,7 +43,7 @@ void worker_handle_create(task_t* _req)
     payload_t payload;
      uint32_t payloadSize = lfs_pack_req_create(payload, sizeof(payload),
         _req->handle, data->tableName, data->consistency,
-        data->numPartitions, data->compactionInterval);
+        data->numPartitions, data->compactionInterval, data->ttl);
 
     _worker_request_lfs(LFSP_REQ_CREATE, payload, payloadSize, _req);
     
@@ -93,6 +104,14 @@ void worker_handle_select(task_t* _req)
                 }
             }
 
+            if (ERR_NONE == _req->err.code && common_is_tombstone(&data->record))
+            {
+                // the key was deleted, we keep the tombstone cached so we don't ask the LFS again.
+                free(data->record.value);
+                data->record.value = NULL;
+                CX_ERR_SET(&_req->err, 1, "Key %d does not exist in table '%s'.", data->record.key, data->tableName);
+            }
+
             mm_segment_avail_guard_end(table);
         }
         mm_avail_guard_end();
@@ -113,7 +132,187 @@ void worker_handle_insert(task_t* _req)
             if (0 == data->record.timestamp)
                 data->record.timestamp = cx_time_epoch_ms();
 
-            mm_page_write(table, &data->record, true, &_req->err);
+            // tombstones are only written by DELETE, a client inserting one would delete the key instead.
+            if (common_is_tombstone(&data->record))
+            {
+                CX_ERR_SET(&_req->err, ERR_GENERIC, "Value of key %d is reserved for deleted keys.", data->record.key);
+            }
+            else
+            {
+                mm_page_write(table, &data->record, true, &_req->err);
+            }
+
+            mm_segment_avail_guard_end(table);
+        }
+        mm_avail_guard_end();
+    }
+
+    _worker_parse_result(_req, table);
+}
+
+void worker_handle_delete(task_t* _req)
+{
+    data_delete_t* data = _req->data;
+    segment_t* table = NULL;
+
+    if (mm_avail_guard_begin(&_req->err))
+    {
+        if (mm_segment_avail_guard_begin(data->tableName, &_req->err, &table))
+        {
+            // deleting a key is just writing a tombstone for it, which is journaled like any other modification.
+            table_record_t tombstone = { data->key, data->timestamp, TOMBSTONE_VALUE };
+            if (0 == tombstone.timestamp)
+                tombstone.timestamp = cx_time_epoch_ms();
+
+            mm_page_write(table, &tombstone, true, &_req->err);
+            mm_segment_avail_guard_end(table);
+        }
+        mm_avail_guard_end();
+    }
+
+    _worker_parse_result(_req, table);
+}
+
+void worker_handle_select_batch(task_t* _req)
+{
+    data_select_batch_t* data = _req->data;
+    segment_t* table = NULL;
+
+    // values found by a previous (rescheduled) run of this task are discarded
+    for (uint16_t i = 0; i < data->recordsCount; i++)
+    {
+        free(data->records[i].value);
+        data->records[i].value = NULL;
+    }
+
+    if (mm_avail_guard_begin(&_req->err))
+    {
+        if (mm_segment_avail_guard_begin(data->tableName, &_req->err, &table))
+        {
+            data_select_batch_t missed;
+            cx_err_t            err;
+            uint16_t*           missedIndices = CX_MEM_ARR_ALLOC(missedIndices, cx_math_max(data->recordsCount, 1));
+
+            CX_MEM_ZERO(missed);
+            cx_str_copy(missed.tableName, sizeof(missed.tableName), data->tableName);
+            missed.records = CX_MEM_ARR_ALLOC(missed.records, cx_math_max(data->recordsCount, 1));
+
+            for (uint16_t i = 0; i < data->recordsCount; i++)
+            {
+                if (!mm_page_read(table, data->records[i].key, &data->records[i], &err))
+                {
+                    missedIndices[missed.recordsCount] = i;
+                    missed.records[missed.recordsCount++].key = data->records[i].key;
+                }
+                else if (common_is_tombstone(&data->records[i]))
+                {
+                    free(data->records[i].value);
+                    data->records[i].value = NULL;
+                }
+            }
+
+            if (missed.recordsCount > 0)
+            {
+                // the records which are not in our cache are requested to the LFS all at once. 
+                // the response is unpacked into the task data, so we temporarily replace it.
+                payload_t payload;
+                uint32_t payloadSize = lfs_pack_req_select_batch(payload, sizeof(payload),
+                    _req->handle, missed.tableName, missed.records, missed.recordsCount);
+
+                _req->data = &missed;
+                bool success = _worker_request_lfs(LFSP_REQ_SELECT_BATCH, payload, payloadSize, _req);
+                _req->data = data;
+
+                for (uint16_t i = 0; i < missed.recordsCount; i++)
+                {
+                    table_record_t* rec = &missed.records[i];
+                    if (success && NULL != rec->value && ERR_NONE == _req->err.code)
+                    {
+                        // result is ready! try to write it to our cache now.
+                        mm_page_write(table, rec, false, &_req->err);
+
+                        data->records[missedIndices[i]].timestamp = rec->timestamp;
+                        if (!common_is_tombstone(rec))
+                        {
+                            data->records[missedIndices[i]].value = rec->value;
+                            rec->value = NULL;
+                        }
+                    }
+                    free(rec->value);
+                }
+            }
+
+            free(missed.records);
+            free(missedIndices);
+
+            mm_segment_avail_guard_end(table);
+        }
+        mm_avail_guard_end();
+    }
+
+    _worker_parse_result(_req, table);
+}
+
+void worker_handle_insert_batch(task_t* _req)
+{
+    data_insert_batch_t* data = _req->data;
+    segment_t* table = NULL;
+
+    if (mm_avail_guard_begin(&_req->err))
+    {
+        if (mm_segment_avail_guard_begin(data->tableName, &_req->err, &table))
+        {
+            // the whole batch is rejected if any record carries a tombstone (see worker_handle_insert).
+            for (uint16_t i = data->recordsNext; i < data->recordsCount; i++)
+            {
+                if (common_is_tombstone(&data->records[i]))
+                {
+                    CX_ERR_SET(&_req->err, ERR_GENERIC, "Value of key %d is reserved for deleted keys.", data->records[i].key);
+                    break;
+                }
+            }
+
+            // records written by a previous (rescheduled) run are already in memory or were
+            // journaled to the LFS, so we resume from the one that failed.
+            uint64_t now = cx_time_epoch_ms();
+            while (ERR_NONE == _req->err.code && data->recordsNext < data->recordsCount)
+            {
+                if (0 == data->records[data->recordsNext].timestamp)
+                    data->records[data->recordsNext].timestamp = now;
+
+                if (!mm_page_write(table, &data->records[data->recordsNext], true, &_req->err))
+                    break;
+
+                data->recordsNext++;
+            }
+            mm_segment_avail_guard_end(table);
+        }
+        mm_avail_guard_end();
+    }
+
+    _worker_parse_result(_req, table);
+}
+
+void worker_handle_scan(task_t* _req)
+{
+    data_scan_t* data = _req->data;
+    segment_t* table = NULL;
+
+    if (mm_avail_guard_begin(&_req->err))
+    {
+        if (mm_segment_avail_guard_begin(data->tableName, &_req->err, &table))
+        {
+            // our cache only holds the keys which were recently used, so scans always go to the LFS.
+            payload_t payload;
+            uint32_t payloadSize = lfs_pack_req_scan(payload, sizeof(payload),
+                _req->handle, data->tableName, data->partition, data->keyMin, data->keyMax);
+
+            if (_worker_request_lfs(LFSP_REQ_SCAN, payload, payloadSize, _req))
+            {
+                // the records we modified haven't reached the LFS yet, they take precedence.
+                _worker_scan_merge_modified(table, data);
+            }
+
             mm_segment_avail_guard_end(table);
         }
         mm_avail_guard_end();
@@ -200,4 +399,70 @@ static bool _worker_request_lfs(uint8_t _header, const char* _payload, uint32_t
 
     return (ERR_NONE == _task->err.code);
 
+}
+
+static void _worker_scan_merge_modified(segment_t* _table, data_scan_t* _data)
+{
+    table_record_t* modified = NULL;
+    uint32_t modifiedCount = mm_page_read_modified(_table, _data->keyMin, _data->keyMax, &modified);
+    uint32_t count = _data->recordsCount;
+
+    _data->records = CX_MEM_ARR_REALLOC(_data->records, cx_math_max(count + modifiedCount, 1));
+
+    for (uint32_t i = 0; i < modifiedCount; i++)
+    {
+        if (SCAN_ALL_PARTITIONS == _data->partition 
+            || (modified[i].key % _data->partitionsCount) == _data->partition)
+            _data->records[count++] = modified[i];
+        else
+            free(modified[i].value);
+    }
+    free(modified);
+
+    if (count > _data->recordsCount)
+    {
+        // same order as the LFS (partition, key and the most recent timestamp first), keeping a single record per key.
+        cx_sort_quick(_data->records, sizeof(_data->records[0]), count, _worker_scan_comp_full, _data);
+        _data->recordsCount = cx_sort_uniquify(_data->records, sizeof(_data->records[0]), count, _worker_scan_comp_key, _data, _worker_scan_record_free);
+
+        // the keys we deleted have a tombstone as their most recent record, it hides them from the result.
+        count = 0;
+        for (uint32_t i = 0; i < _data->recordsCount; i++)
+        {
+            if (common_is_tombstone(&_data->records[i]))
+                free(_data->records[i].value);
+            else
+                _data->records[count++] = _data->records[i];
+        }
+        _data->recordsCount = count;
+    }
+}
+
+static int32_t _worker_scan_comp_full(const void* _a, const void* _b, void* _userData)
+{
+    const table_record_t* a = _a;
+    const table_record_t* b = _b;
+    int32_t result = _worker_scan_comp_key(_a, _b, _userData);
+
+    // same key, the most recent one goes first
+    if (0 != result || a->timestamp == b->timestamp) return result;
+    return (a->timestamp > b->timestamp) ? -1 : 1;
+}
+
+static int32_t _worker_scan_comp_key(const void* _a, const void* _b, void* _userData)
+{
+    const table_record_t* a = _a;
+    const table_record_t* b = _b;
+    const data_scan_t* data = _userData;
+    int64_t result = 0;
+
+    result = (a->key % data->partitionsCount) - (b->key % data->partitionsCount);
+    if (0 == result) result = a->key - b->key;
+    if (0 == result) return 0;
+    return (result > 0) ? 1 : -1;
+}
+
+static void _worker_scan_record_free(void* _record)
+{
+    free(((table_record_t*)_record)->value);
 }
\ No newline at end of file
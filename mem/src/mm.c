@@ -1,10 +1,12 @@
 #include "mm.h"
 
 #include <lfs/lfs_protocol.h>
+#include <ker/common.h>
 
 #include <cx/mem.h>
 #include <cx/str.h>
 #include <cx/timer.h>
+#include <cx/math.h>
 
 #include <pthread.h>
 #include <errno.h>
@@ -30,6 +32,10 @@ static void             _mm_frame_read(uint16_t _frameNumber, table_record_t* _o
 
 static void             _mm_frame_write(uint16_t _frameNumber, table_record_t* _record);
 
+static bool             _mm_journal_send(task_t* _task, const char* _tableName, const table_record_t* _records, uint16_t _recordsCount, const table_record_t* _tombstones, uint16_t _tombstonesCount);
+
+static void             _mm_journal_request(task_t* _task, uint8_t _header, const char* _payload, uint32_t _payloadSize);
+
 /****************************************************************************************
  ***  PUBLIC FUNCTIONS
  ***************************************************************************************/
@@ -402,6 +408,37 @@ bool mm_page_read(segment_t* _table, uint16_t _key, table_record_t* _outRecord,
     return success;
 }
 
+uint32_t mm_page_read_modified(segment_t* _table, uint16_t _keyMin, uint16_t _keyMax, table_record_t** _outRecords)
+{
+    // copies the records of the given table within [_keyMin, _keyMax] which were modified and 
+    // not yet journaled to the LFS. the records are owned by the caller and must be freed.
+    page_t* page = NULL;
+    uint32_t count = 0;
+    table_record_t* records = NULL;
+
+    cx_cdict_iter_begin(_table->pages);
+    records = CX_MEM_ARR_ALLOC(records, cx_math_max(cx_cdict_size(_table->pages), 1));
+
+    while (cx_cdict_iter_next(_table->pages, NULL, (void**)&page))
+    {
+        pthread_rwlock_rdlock(&page->rwlock);
+        if (_table == page->parent && page->modified)
+        {
+            _mm_frame_read(page->frameNumber, &records[count]);
+
+            if (_keyMin <= records[count].key && records[count].key <= _keyMax)
+                count++;
+            else
+                free(records[count].value);
+        }
+        pthread_rwlock_unlock(&page->rwlock);
+    }
+    cx_cdict_iter_end(_table->pages);
+
+    (*_outRecords) = records;
+    return count;
+}
+
 bool mm_page_write(segment_t* _table, table_record_t* _record, bool _isModification, cx_err_t* _err)
 {
     bool success = false;
@@ -532,48 +569,55 @@ void mm_journal_run(task_t* _task)
     CX_CHECK(m_mmCtx->journaling, "this method should only be called when performing a memory journal!");
     CX_CHECK(TASK_WT_JOURNAL == _task->type, "this method should only be called when processing a TASK_WT_JOURNAL task!");
 
-    bool        success = true;
-    payload_t   payload;
-    uint32_t    payloadSize = 0;
     segment_t*  table = NULL;
     page_t*     page = NULL;
     char*       tableName = NULL;
-    int32_t     result = 0;
-    table_record_t r;
+    table_record_t* records = NULL;
+    table_record_t  record;
+    uint16_t    recordsCount = 0;
+    uint16_t    tombstonesCount = 0;
+    uint32_t    capacity = 0;
 
     if (mm_block())
     {
         cx_cdict_iter_begin(m_mmCtx->tablesMap);
         while (ERR_NONE == _task->err.code && cx_cdict_iter_next(m_mmCtx->tablesMap, &tableName, (void**)&table))
         {
+            // the modified pages of each table are sent to the LFS in batches (as many records
+            // as they fit in a single packet) instead of one insert request per page.
+            // tombstones are journaled as DELETE requests instead (the LFS rejects them in batches),
+            // so they're kept apart at the end of the array.
+            recordsCount = 0;
+            tombstonesCount = 0;
+            capacity = cx_math_max(cx_cdict_size(table->pages), 1);
+            records = CX_MEM_ARR_ALLOC(records, capacity);
+
             cx_cdict_iter_begin(table->pages);
-            while (ERR_NONE == _task->err.code && cx_cdict_iter_next(table->pages, NULL, (void**)&page))
+            while (cx_cdict_iter_next(table->pages, NULL, (void**)&page))
             {
                 if (page->parent == table && page->modified)
                 {
-                    _mm_frame_read(page->frameNumber, &r);
-
-                    payloadSize = lfs_pack_req_insert(payload, sizeof(payload),
-                        _task->handle, tableName, r.key, r.value, r.timestamp);
-
-                    do
-                    {
-                        result = cx_net_send(g_ctx.lfs, LFSP_REQ_INSERT, payload, payloadSize, INVALID_CID);
-
-                        if (CX_NET_SEND_DISCONNECTED == result)
-                        {
-                            CX_ERR_SET(&_task->err, ERR_NET_LFS_UNAVAILABLE, "LFS node is unavailable.");
-                        }
-                        else if (CX_NET_SEND_BUFFER_FULL == result)
-                        {
-                            cx_net_wait_outboundbuff(g_ctx.lfs, INVALID_CID, -1);
-                        }
-                    } while (ERR_NONE == _task->err.code && result != CX_NET_SEND_OK);
-
-                    free(r.value);
+                    _mm_frame_read(page->frameNumber, &record);
+                    if (common_is_tombstone(&record))
+                        records[capacity - ++tombstonesCount] = record;
+                    else
+                        records[recordsCount++] = record;
                 }
             }
             cx_cdict_iter_end(table->pages);
+
+            if ((recordsCount + tombstonesCount) > 0
+                && !_mm_journal_send(_task, tableName, records, recordsCount, &records[capacity - tombstonesCount], tombstonesCount)
+                && ERR_NET_LFS_UNAVAILABLE != _task->err.code)
+            {
+                // the LFS rejected this table (i.e. it was dropped), the rest of them can still be journaled.
+                CX_WARN(CX_ALW, "journal of table '%s' failed. %s", tableName, _task->err.desc);
+                CX_ERR_CLEAR(&_task->err);
+            }
+
+            for (uint32_t i = 0; i < capacity; i++)
+                free(records[i].value);
+            free(records);
         }
         cx_cdict_iter_end(m_mmCtx->tablesMap);
 
@@ -675,6 +719,78 @@ static void _mm_frame_read(uint16_t _frameNumber, table_record_t* _outRecord)
     _outRecord->value = cx_str_copy_d(&m_mmCtx->mainMem[base + timestampSz + keySz]);
 }
 
+static bool _mm_journal_send(task_t* _task, const char* _tableName, const table_record_t* _records, uint16_t _recordsCount, const table_record_t* _tombstones, uint16_t _tombstonesCount)
+{
+    // each batch is applied by the LFS at once and acknowledged with a single response, 
+    // which we wait for before sending the next one.
+    payload_t   payload;
+    uint32_t    payloadSize = 0;
+    uint16_t    recordsPacked = 0;
+    uint16_t    recordsPackedBefore = 0;
+    bool        complete = (0 == _recordsCount);
+
+    while (!complete && ERR_NONE == _task->err.code)
+    {
+        recordsPackedBefore = recordsPacked;
+        complete = lfs_pack_req_insert_batch(payload, sizeof(payload), &payloadSize,
+            _task->handle, _tableName, _records, _recordsCount, &recordsPacked);
+
+        if (recordsPacked == recordsPackedBefore)
+        {
+            CX_ERR_SET(&_task->err, ERR_GENERIC, "Record with key %d is too large to be journaled.", _records[recordsPacked].key);
+            break;
+        }
+
+        _mm_journal_request(_task, LFSP_REQ_INSERT_BATCH, payload, payloadSize);
+    }
+
+    // the keys deleted are sent one by one along with the timestamp of their tombstones.
+    for (uint16_t i = 0; i < _tombstonesCount && ERR_NONE == _task->err.code; i++)
+    {
+        payloadSize = lfs_pack_req_delete(payload, sizeof(payload), 
+            _task->handle, _tableName, _tombstones[i].key, _tombstones[i].timestamp);
+
+        _mm_journal_request(_task, LFSP_REQ_DELETE, payload, payloadSize);
+    }
+
+    return (ERR_NONE == _task->err.code);
+}
+
+static void _mm_journal_request(task_t* _task, uint8_t _header, const char* _payload, uint32_t _payloadSize)
+{
+    int32_t result = 0;
+
+    pthread_mutex_lock(&_task->responseMtx);
+    _task->state = TASK_STATE_RUNNING_AWAITING;
+    pthread_mutex_unlock(&_task->responseMtx);
+
+    do
+    {
+        result = cx_net_send(g_ctx.lfs, _header, _payload, _payloadSize, INVALID_CID);
+
+        if (CX_NET_SEND_DISCONNECTED == result)
+        {
+            CX_ERR_SET(&_task->err, ERR_NET_LFS_UNAVAILABLE, "LFS node is unavailable.");
+        }
+        else if (CX_NET_SEND_BUFFER_FULL == result)
+        {
+            cx_net_wait_outboundbuff(g_ctx.lfs, INVALID_CID, -1);
+        }
+    } while (ERR_NONE == _task->err.code && result != CX_NET_SEND_OK);
+
+    pthread_mutex_lock(&_task->responseMtx);
+    if (CX_NET_SEND_OK == result)
+    {
+        // wait for the acknowledgement (_task->err gets the result of the request)
+        while (TASK_STATE_RUNNING_AWAITING == _task->state)
+        {
+            pthread_cond_wait(&_task->responseCond, &_task->responseMtx);
+        }
+    }
+    _task->state = TASK_STATE_RUNNING;
+    pthread_mutex_unlock(&_task->responseMtx);
+}
+
 static void _mm_frame_write(uint16_t _frameNumber, table_record_t* _record)
 {
     const uint32_t keySz = sizeof(_record->key);
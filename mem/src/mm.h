@@ -40,6 +40,8 @@ bool                mm_page_alloc(segment_t* _parent, bool _isModification, page
 
 bool                mm_page_read(segment_t* _table, uint16_t _key, table_record_t* _outRecord, cx_err_t* _err);
 
+uint32_t            mm_page_read_modified(segment_t* _table, uint16_t _keyMin, uint16_t _keyMax, table_record_t** _outRecords);
+
 bool                mm_page_write(segment_t* _table, table_record_t* _record, bool _isModification, cx_err_t* _err);
 
 void                mm_reschedule_task(task_t* _task);